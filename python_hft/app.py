@@ -6,9 +6,22 @@ from streamlit_autorefresh import st_autorefresh
 from datetime import datetime
 
 from models.engine import TradingEngine
+from models.stats_surface import StatsSurface
 from models.trader import Trader
 from utils.data_export import DataExporter
 from utils.csv_importer import CSVImporter
+from utils.panel_cache import PanelCache, downsample
+
+# Dashboard refresh while the simulation runs; stats are published at the
+# same cadence so an open dashboard costs the engine one gather per frame
+REFRESH_MS = 1000
+# Book levels per side in the chart and table (the surface publishes ten)
+BOOK_DISPLAY_LEVELS = 5
+# Most traders drawn in the P&L chart and table, and given live metrics
+TRADER_DISPLAY_BUDGET = 20
+LIVE_METRICS_BUDGET = 10
+# Shortest time between rebuilds of the trader panels under load
+TRADER_PANEL_SECONDS = 2.0
 
 # Page configuration
 st.set_page_config(page_title="HFT Trading Simulation",
@@ -19,6 +32,12 @@ st.set_page_config(page_title="HFT Trading Simulation",
 # Initialize session state
 if 'engine' not in st.session_state:
     st.session_state.engine = TradingEngine()
+    # Ten levels so book snapshots (exports) are answered from the copy
+    st.session_state.stats_surface = StatsSurface(
+        st.session_state.engine, interval_seconds=REFRESH_MS / 1000,
+        top_levels=10)
+    st.session_state.panel_cache = PanelCache(
+        min_interval_seconds=REFRESH_MS / 1000)
     st.session_state.traders = []
     st.session_state.simulation_running = False
     st.session_state.last_update = datetime.now().timestamp()
@@ -27,9 +46,9 @@ if 'engine' not in st.session_state:
     st.session_state.custom_symbols = []
     st.session_state.imported_symbols = []
 
-# Auto-refresh every 1000ms if simulation is running
+# Auto-refresh every REFRESH_MS if simulation is running
 if st.session_state.simulation_running:
-    st_autorefresh(interval=1000, limit=None, key="hft_refresh")
+    st_autorefresh(interval=REFRESH_MS, limit=None, key="hft_refresh")
 
 
 @st.cache_data
@@ -55,6 +74,7 @@ def create_traders(num_traders, symbols, initial_cash, hft_mode=False):
 
 def start_simulation():
     st.session_state.simulation_running = True
+    st.session_state.stats_surface.start()
 
 
 def stop_simulation():
@@ -62,24 +82,35 @@ def stop_simulation():
     st.session_state.engine.stop()
     for trader in st.session_state.traders:
         trader.stop_trading()
+    st.session_state.stats_surface.stop()
 
 
-def create_orderbook_chart(symbol):
-    orderbook = st.session_state.engine.get_orderbook(symbol)
-    bids, asks = orderbook.get_top_levels(5)
+def get_dashboard_stats():
+    """Latest published stats block (rebuilt directly while stopped)"""
+    surface = st.session_state.stats_surface
+    block = surface.read()
+    if block is None or not surface.is_running:
+        block = surface.publish_now()
+    return block
+
+
+def create_orderbook_chart(symbol, stats):
+    levels = stats['orderbooks'].get(symbol, {'bids': [], 'asks': []})
+    bids = levels['bids'][:BOOK_DISPLAY_LEVELS]
+    asks = levels['asks'][:BOOK_DISPLAY_LEVELS]
     fig = go.Figure()
     if bids:
         fig.add_trace(
-            go.Bar(x=[b.quantity for b in bids],
-                   y=[b.price for b in bids],
+            go.Bar(x=[b['quantity'] for b in bids],
+                   y=[b['price'] for b in bids],
                    orientation='h',
                    name='Bids',
                    marker_color='green',
                    opacity=0.7))
     if asks:
         fig.add_trace(
-            go.Bar(x=[-a.quantity for a in asks],
-                   y=[a.price for a in asks],
+            go.Bar(x=[-a['quantity'] for a in asks],
+                   y=[a['price'] for a in asks],
                    orientation='h',
                    name='Asks',
                    marker_color='red',
@@ -92,13 +123,72 @@ def create_orderbook_chart(symbol):
     return fig
 
 
-def create_pnl_chart():
+def create_orderbook_table(symbol, stats):
+    levels = stats['orderbooks'].get(symbol, {'bids': [], 'asks': []})
+    bids = levels['bids'][:BOOK_DISPLAY_LEVELS]
+    asks = levels['asks'][:BOOK_DISPLAY_LEVELS]
+    rows = []
+    for ask in reversed(asks):
+        rows.append({
+            'Side': 'ASK',
+            'Price': f"${ask['price']:.2f}",
+            'Quantity': ask['quantity'],
+            'Total': ask['price'] * ask['quantity']
+        })
+    if bids and asks:
+        rows.append({
+            'Side': '---',
+            'Price': '---',
+            'Quantity': '---',
+            'Total': '---'
+        })
+    for bid in bids:
+        rows.append({
+            'Side': 'BID',
+            'Price': f"${bid['price']:.2f}",
+            'Quantity': bid['quantity'],
+            'Total': bid['price'] * bid['quantity']
+        })
+    return pd.DataFrame(rows)
+
+
+def create_trades_table(stats):
+    return pd.DataFrame([{
+        'Time':
+        t['timestamp'].strftime('%H:%M:%S.%f')[:-3],
+        'Symbol':
+        t['symbol'],
+        'Side':
+        t['side'],
+        'Price':
+        f"${t['price']:.2f}",
+        'Quantity':
+        t['quantity'],
+        'Buyer':
+        t['buyer_id'],
+        'Seller':
+        t['seller_id']
+    } for t in stats['recent_trades']])
+
+
+def create_trader_table(traders):
+    return pd.DataFrame([{
+        'Trader ID': t['trader_id'],
+        'Cash': f"${t['cash']:,.2f}",
+        'Portfolio Value': f"${t['portfolio_value']:,.2f}",
+        'Total P&L': f"${t['total_pnl']:,.2f}",
+        'Orders Sent': t['orders_sent'],
+        'Orders Filled': t['orders_filled']
+    } for t in traders])
+
+
+def create_pnl_chart(traders):
     pnl_data = [{
-        'Trader': t.trader_id,
-        'Cash': t.cash,
-        'Portfolio Value': t.get_portfolio_value(),
-        'Total P&L': t.get_total_pnl()
-    } for t in st.session_state.traders]
+        'Trader': t['trader_id'],
+        'Cash': t['cash'],
+        'Portfolio Value': t['portfolio_value'],
+        'Total P&L': t['total_pnl']
+    } for t in traders]
     if pnl_data:
         df = pd.DataFrame(pnl_data)
         fig = px.bar(df,
@@ -112,8 +202,8 @@ def create_pnl_chart():
     return None
 
 
-def create_performance_metrics():
-    stats = st.session_state.engine.get_performance_stats()
+def create_performance_metrics(stats):
+    stats = stats['performance']
     col1, col2, col3, col4 = st.columns(4)
     col1.metric("Total Trades", stats['total_trades'])
     col2.metric("Trades/Second", f"{stats['trades_per_second']:.2f}")
@@ -166,6 +256,7 @@ with st.sidebar:
         if symbols:
             st.session_state.traders = create_traders(num_traders, symbols,
                                                       initial_cash, hft_mode)
+            st.session_state.stats_surface.traders = st.session_state.traders
             start_simulation()
             st.rerun()
         else:
@@ -178,10 +269,10 @@ with st.sidebar:
         st.rerun()
 
     if st.button("Export Trades to CSV"):
-        trades_data = st.session_state.engine.get_all_trades()
-        if trades_data:
-            csv_data = st.session_state.data_exporter.export_trades_to_csv(
-                trades_data)
+        # Streamed from the trade store, never held as one list of dicts
+        csv_data = st.session_state.data_exporter.export_trades_to_csv(
+            st.session_state.engine.iter_trades())
+        if csv_data:
             st.download_button(
                 "Download Trades CSV",
                 data=csv_data,
@@ -191,6 +282,23 @@ with st.sidebar:
         else:
             st.warning("No trades to export")
 
+    if st.button("Export Trades to Parquet"):
+        trade_batches = st.session_state.engine.get_trade_batches()
+        if trade_batches:
+            try:
+                parquet_data = st.session_state.data_exporter.export_trades_to_parquet(
+                    trade_batches)
+                st.download_button(
+                    "Download Trades Parquet",
+                    data=parquet_data,
+                    file_name=
+                    f"trades_{datetime.now().strftime('%Y%m%d_%H%M%S')}.parquet",
+                    mime="application/octet-stream")
+            except ImportError as e:
+                st.error(str(e))
+        else:
+            st.warning("No trades to export")
+
     if st.button("Export Order Book Snapshot"):
         orderbook_data = {
             sym: st.session_state.engine.get_orderbook(sym).get_snapshot()
@@ -209,92 +317,68 @@ with st.sidebar:
             st.warning("No order book data")
 
 # Main Content
-create_performance_metrics()
+dashboard_stats = get_dashboard_stats()
+create_performance_metrics(dashboard_stats)
+
+# Panels are rebuilt only when the versions they show moved (see
+# utils/panel_cache.py)
+panels = st.session_state.panel_cache
+versions = dashboard_stats['versions']
 
 if symbols:
     selected_symbol = st.selectbox("📊 Select Symbol", symbols)
     if selected_symbol:
+        fig, book_table = panels.get(
+            ('orderbook', selected_symbol),
+            versions['books'].get(selected_symbol),
+            lambda: (create_orderbook_chart(selected_symbol, dashboard_stats),
+                     create_orderbook_table(selected_symbol, dashboard_stats)))
         col1, col2 = st.columns([1, 1])
         with col1:
-            fig = create_orderbook_chart(selected_symbol)
             st.plotly_chart(fig, use_container_width=True)
         with col2:
-            orderbook = st.session_state.engine.get_orderbook(selected_symbol)
-            bids, asks = orderbook.get_top_levels(5)
-            rows = []
-            for ask in reversed(asks):
-                rows.append({
-                    'Side': 'ASK',
-                    'Price': f"${ask.price:.2f}",
-                    'Quantity': ask.quantity,
-                    'Total': ask.price * ask.quantity
-                })
-            if bids and asks:
-                rows.append({
-                    'Side': '---',
-                    'Price': '---',
-                    'Quantity': '---',
-                    'Total': '---'
-                })
-            for bid in bids:
-                rows.append({
-                    'Side': 'BID',
-                    'Price': f"${bid.price:.2f}",
-                    'Quantity': bid.quantity,
-                    'Total': bid.price * bid.quantity
-                })
-            st.dataframe(pd.DataFrame(rows),
+            st.dataframe(book_table,
                          use_container_width=True,
                          hide_index=True)
 
 st.subheader("📈 Recent Trades")
-recent_trades = st.session_state.engine.get_recent_trades(20)
-if recent_trades:
-    trades_df = pd.DataFrame([{
-        'Time':
-        t['timestamp'].strftime('%H:%M:%S.%f')[:-3],
-        'Symbol':
-        t['symbol'],
-        'Side':
-        t['side'],
-        'Price':
-        f"${t['price']:.2f}",
-        'Quantity':
-        t['quantity'],
-        'Buyer':
-        t['buyer_id'],
-        'Seller':
-        t['seller_id']
-    } for t in recent_trades])
+if dashboard_stats['recent_trades']:
+    trades_df = panels.get('trades', versions['trades'],
+                           lambda: create_trades_table(dashboard_stats))
     st.dataframe(trades_df, use_container_width=True, hide_index=True)
 else:
     st.info("No trades yet")
 
 if st.session_state.traders:
     st.subheader("💰 Trader Performance")
-    pnl_fig = create_pnl_chart()
+    # P&L moves with positions (trader versions), marks (trades) and the
+    # order counts shown
+    trader_version = (tuple(sorted(versions['traders'].items())),
+                      versions['trades'],
+                      sum(t['orders_sent'] for t in dashboard_stats['traders']))
+
+    def build_trader_panels():
+        shown = downsample(dashboard_stats['traders'], TRADER_DISPLAY_BUDGET,
+                           key=lambda t: t['total_pnl'])
+        return (create_pnl_chart(shown), create_trader_table(shown),
+                downsample(shown, LIVE_METRICS_BUDGET,
+                           key=lambda t: t['total_pnl']))
+
+    pnl_fig, trader_table, live_traders = panels.get(
+        'traders', trader_version, build_trader_panels,
+        min_interval_seconds=TRADER_PANEL_SECONDS)
     if pnl_fig:
         st.plotly_chart(pnl_fig, use_container_width=True)
-    trader_data = [{
-        'Trader ID': t.trader_id,
-        'Cash': f"${t.cash:,.2f}",
-        'Portfolio Value': f"${t.get_portfolio_value():,.2f}",
-        'Total P&L': f"${t.get_total_pnl():,.2f}",
-        'Orders Sent': t.orders_sent,
-        'Orders Filled': t.orders_filled
-    } for t in st.session_state.traders]
-    st.dataframe(pd.DataFrame(trader_data),
-                 use_container_width=True,
-                 hide_index=True)
-    # Live metrics per trader
+    st.dataframe(trader_table, use_container_width=True, hide_index=True)
+    # Live metrics for the best and worst traders
     st.subheader("📊 Live Trader Metrics")
-    for trader in st.session_state.traders:
+    for trader in live_traders:
         col1, col2 = st.columns(2)
         with col1:
-            st.metric(f"{trader.trader_id} Cash", f"${trader.cash:,.2f}")
+            st.metric(f"{trader['trader_id']} Cash", f"${trader['cash']:,.2f}")
         with col2:
-            st.metric(f"{trader.trader_id} Portfolio",
-                      f"${trader.get_portfolio_value():,.2f}")
+            st.metric(f"{trader['trader_id']} Portfolio",
+                      f"${trader['portfolio_value']:,.2f}")
 
 status_col1, status_col2 = st.columns([4, 4])
 
@@ -0,0 +1,695 @@
+#!/usr/bin/env python3
+"""
+Reproducible benchmark suite
+
+Runs seeded micro benchmarks of book-side operations at several depths,
+matching benchmarks of the shard's order path (resting, crossing and
+cancel-heavy flow) and end-to-end throughput under generated load, then
+writes JSON with per-operation percentiles. Each benchmark runs after
+warmup runs that are discarded, then several times; the reported figures
+are medians across those runs, and each run's p50/p99 is kept so a later
+comparison can see how noisy the benchmark is. Given a baseline file it
+compares each benchmark's median p50 and p99 against it and exits
+non-zero on a regression beyond the larger of the threshold and the
+noise measured across runs.
+
+    python benchmark_suite.py --output results.json
+    python benchmark_suite.py --baseline results.json --threshold 0.10
+    python benchmark_suite.py --repeats 9 --warmup 2 --only match.
+    python benchmark_suite.py --quick --only book.
+"""
+import argparse
+import gc
+import itertools
+import json
+import platform
+import random
+import subprocess
+import sys
+import time
+from datetime import datetime
+
+from models.auction import BatchAuction
+from models.engine import TradingEngine
+from models.order import Order, OrderSide
+from models.orderbook import OrderBook
+
+SUITE_VERSION = 2
+SYMBOL = 'BENCH'
+MID_TICKS = 10000  # 100.00 at the default tick size
+DEPTHS = (10, 100, 1000)
+QUICK_DEPTHS = (10, 100)
+PERCENTILES = (('p50', 50), ('p90', 90), ('p99', 99), ('p999', 99.9))
+# A tail percentile is reported only with at least this many samples beyond
+# it, so p99 needs 1000 samples and p999 10000 (otherwise it is just the
+# max); p50 is always reported
+MIN_TAIL_SAMPLES = 10
+# Statistics taken as the median across repeated runs
+AGGREGATED = ('mean', 'p50', 'p90', 'p99', 'p999', 'max', 'ops_per_second',
+              'orders_per_second', 'calibration_ns')
+COMPARED = ('p50', 'p99')
+# A change is noise while within this many robust standard deviations
+# (scaled median absolute deviation) of the per-run values
+NOISE_DEVIATIONS = 3.0
+
+
+def summarize(samples_ns, unit='ns/op', **params):
+    """
+    Percentile summary of per-operation times
+
+    Args:
+        samples_ns (list): One duration per operation in ns
+        unit (str): Unit the values are reported in
+        params: Benchmark parameters recorded with the result
+
+    Returns:
+        dict: count, mean, p50/p90/p99/p999 (None with too few samples
+            beyond the percentile), max and operations per second
+    """
+    ordered = sorted(samples_ns)
+    count = len(ordered)
+    mean = sum(ordered) / count
+    result = {'unit': unit, 'count': count, 'mean': mean}
+    for name, percentile in PERCENTILES:
+        if percentile > 50 and count * (100 - percentile) / 100 < \
+                MIN_TAIL_SAMPLES:
+            result[name] = None
+            continue
+        result[name] = ordered[min(count - 1, int(count * percentile / 100))]
+    result['max'] = ordered[-1]
+    result['ops_per_second'] = 1e9 / mean if mean > 0 else 0
+    result['params'] = params
+    return result
+
+
+def calibrate(rounds=3):
+    """
+    Time a fixed interpreter workload as a measure of machine speed
+
+    Run before every benchmark run, so results taken while the machine was
+    slower (a shared or throttled host) can be scaled back by comparison.
+
+    Args:
+        rounds (int): Repetitions; the fastest is kept
+
+    Returns:
+        int: Fastest round in ns
+    """
+    rng = random.Random(0)
+    values = [rng.random() for _ in range(2000)]
+    clock = time.perf_counter_ns
+    best = None
+    for _ in range(rounds):
+        start = clock()
+        table = {}
+        for i, value in enumerate(values):
+            table[i] = value * 2.0
+        total = 0.0
+        for value in sorted(table.values()):
+            total += value
+        elapsed = clock() - start
+        if best is None or elapsed < best:
+            best = elapsed
+    return best
+
+
+def median(values):
+    """Median of a non-empty list"""
+    ordered = sorted(values)
+    middle = len(ordered) // 2
+    if len(ordered) % 2:
+        return ordered[middle]
+    return (ordered[middle - 1] + ordered[middle]) / 2
+
+
+def relative_noise(values):
+    """
+    Run-to-run noise of a statistic as a fraction of its median
+
+    Uses the median absolute deviation scaled to a standard deviation, so
+    one outlying run does not widen it.
+
+    Args:
+        values (list): The statistic from each run
+
+    Returns:
+        float: Noise fraction (0.0 with fewer than two runs)
+    """
+    if len(values) < 2:
+        return 0.0
+    center = median(values)
+    if not center:
+        return 0.0
+    deviation = median([abs(value - center) for value in values])
+    return 1.4826 * deviation / center
+
+
+def aggregate(runs):
+    """
+    Combine one benchmark's repeated runs
+
+    Args:
+        runs (list): summarize() results, one per run
+
+    Returns:
+        dict: The median of each statistic across runs, with the runs'
+            own p50/p99 under 'runs' and their noise (relative to each
+            run's calibration) under 'noise'
+    """
+    result = dict(runs[0])
+    result['repeats'] = len(runs)
+    result['runs'] = {}
+    result['noise'] = {}
+    for metric in AGGREGATED:
+        if metric not in result:
+            continue
+        values = [run[metric] for run in runs if run[metric] is not None]
+        result[metric] = median(values) if values else None
+        if metric in COMPARED and values:
+            result['runs'][metric] = values
+            result['noise'][metric] = relative_noise(
+                [run[metric] / run['calibration_ns'] for run in runs
+                 if run[metric] is not None])
+    checksums = [run.get('checksum') for run in runs]
+    if any(checksum != checksums[0] for checksum in checksums):
+        # Same seed should mean the same trades on every run
+        result['checksum'] = checksums
+    return result
+
+
+class Timer:
+    """Collects per-call timings with the collector paused"""
+
+    def __enter__(self):
+        gc.collect()
+        self.gc_enabled = gc.isenabled()
+        gc.disable()
+        return self
+
+    def __exit__(self, *exc):
+        if self.gc_enabled:
+            gc.enable()
+        return False
+
+
+class BenchmarkSuite:
+    """Seeded benchmarks of the book, the matching path and the engine"""
+
+    def __init__(self, backend='python', seed=0, operations=20000,
+                 quick=False, repeats=5, warmup=1):
+        """
+        Initialize the suite
+
+        Args:
+            backend (str): Matching backend ('python' or 'native')
+            seed (int): Seed for every generated price and order
+            operations (int): Timed operations per micro benchmark
+            quick (bool): Smaller depths and loads (smoke runs)
+            repeats (int): Measured runs of each benchmark
+            warmup (int): Discarded runs of each benchmark before those
+        """
+        if repeats < 1 or warmup < 0:
+            raise ValueError("repeats must be at least 1 and warmup at least 0")
+
+        self.backend = backend
+        self.seed = seed
+        self.operations = operations // 5 if quick else operations
+        self.quick = quick
+        self.repeats = repeats
+        self.warmup = warmup
+        self.depths = QUICK_DEPTHS if quick else DEPTHS
+        self.results = {}
+
+    def _rng(self, name):
+        # Each benchmark gets its own stream so selecting a subset with
+        # --only does not change the others' inputs
+        return random.Random(f"{self.seed}:{name}")
+
+    def _engine(self):
+        return TradingEngine(backend=self.backend)
+
+    def _order(self, engine, side, quantity, price_ticks, trader_id='BENCH'):
+        order = engine.create_order(trader_id, SYMBOL, side, quantity,
+                                    price_ticks / 100)
+        order.order_id = next(engine.order_ids)
+        return order
+
+    # ------------------------------------------------------------------
+    # Book side micro benchmarks
+
+    def _seed_side(self, engine, depth, rng, orders_per_level=2):
+        """Rest depth bid levels below the mid through the shard"""
+        shard = engine.get_shard(SYMBOL)
+        orderbook = engine.get_orderbook(SYMBOL)
+        for level in range(depth):
+            for _ in range(orders_per_level):
+                order = self._order(engine, OrderSide.BUY, rng.randint(1, 100),
+                                    MID_TICKS - 1 - level)
+                orderbook.prepare_order(order)
+                with shard.orders_lock:
+                    shard._track(order)
+                    orderbook.add_order(order)
+        return orderbook
+
+    def bench_book(self, depth):
+        """Book side operations and sweep_cost at a depth"""
+        rng = self._rng(f"book:{depth}")
+        engine = self._engine()
+        orderbook = self._seed_side(engine, depth, rng)
+        side = orderbook.bids
+        shard = engine.get_shard(SYMBOL)
+        n = self.operations
+
+        orders = []
+        for _ in range(n):
+            order = self._order(engine, OrderSide.BUY, rng.randint(1, 100),
+                                MID_TICKS - 1 - rng.randrange(depth))
+            orderbook.prepare_order(order)
+            with shard.orders_lock:
+                shard._track(order)
+            orders.append(order)
+
+        clock = time.perf_counter_ns
+        add_samples = []
+        remove_samples = []
+        with Timer():
+            # Adds and removes alternate so the depth stays put
+            for order in orders:
+                start = clock()
+                side.add_order(order)
+                add_samples.append(clock() - start)
+            rng.shuffle(orders)
+            for order in orders:
+                start = clock()
+                side.remove_order(order.order_id)
+                remove_samples.append(clock() - start)
+
+            best_samples = []
+            for _ in range(n):
+                start = clock()
+                side.get_best_price()
+                best_samples.append(clock() - start)
+
+            top_samples = []
+            for _ in range(n):
+                start = clock()
+                side.get_top_levels(10, include_orders=False)
+                top_samples.append(clock() - start)
+
+            # Sizes reach a random part of the depth; adds and removes in
+            # between keep the index folding in changes as in live use
+            total = side.get_total_volume()
+            sweep_samples = []
+            for i in range(n):
+                quantity = rng.randint(1, max(1, total))
+                start = clock()
+                orderbook.sweep_cost(OrderSide.SELL, quantity)
+                sweep_samples.append(clock() - start)
+                order = orders[i]
+                side.add_order(order)
+                side.remove_order(order.order_id)
+
+        self.results[f"book.add_order[depth={depth}]"] = summarize(
+            add_samples, depth=depth)
+        self.results[f"book.remove_order[depth={depth}]"] = summarize(
+            remove_samples, depth=depth)
+        self.results[f"book.get_best_price[depth={depth}]"] = summarize(
+            best_samples, depth=depth)
+        self.results[f"book.get_top_levels[depth={depth}]"] = summarize(
+            top_samples, depth=depth, levels=10)
+        self.results[f"book.sweep_cost[depth={depth}]"] = summarize(
+            sweep_samples, depth=depth)
+
+    # ------------------------------------------------------------------
+    # Matching path benchmarks
+
+    def _process(self, shard, order, clock):
+        """Time one order through the shard's processing path"""
+        order.submit_time = shard.clock.monotonic_ns()
+        if self.backend == 'native':
+            start = clock()
+            shard._process_batch([order])
+        else:
+            start = clock()
+            shard._process_order(order, order.submit_time)
+        return clock() - start
+
+    def bench_resting(self, depth):
+        """Non-crossing flow: every order rests on its own side"""
+        rng = self._rng(f"resting:{depth}")
+        engine = self._engine()
+        self._seed_side(engine, depth, rng)
+        shard = engine.get_shard(SYMBOL)
+        clock = time.perf_counter_ns
+        samples = []
+        with Timer():
+            for _ in range(self.operations):
+                if rng.random() < 0.5:
+                    order = self._order(engine, OrderSide.BUY,
+                                        rng.randint(1, 100),
+                                        MID_TICKS - 1 - rng.randrange(depth))
+                else:
+                    order = self._order(engine, OrderSide.SELL,
+                                        rng.randint(1, 100),
+                                        MID_TICKS + 1 + rng.randrange(depth))
+                samples.append(self._process(shard, order, clock))
+        self.results[f"match.resting[depth={depth}]"] = summarize(
+            samples, depth=depth)
+
+    def bench_crossing(self, depth):
+        """Crossing flow: each order fills one or two resting orders"""
+        rng = self._rng(f"crossing:{depth}")
+        engine = self._engine()
+        shard = engine.get_shard(SYMBOL)
+        clock = time.perf_counter_ns
+        n = self.operations
+
+        # Enough asks for every taker, spread over depth levels
+        for i in range(n + depth):
+            order = self._order(engine, OrderSide.SELL, 50,
+                                MID_TICKS + (i % depth), 'MAKER')
+            self._process(shard, order, clock)
+
+        samples = []
+        with Timer():
+            for _ in range(n):
+                order = self._order(engine, OrderSide.BUY,
+                                    rng.choice((25, 50, 75)),
+                                    MID_TICKS + depth, 'TAKER')
+                samples.append(self._process(shard, order, clock))
+        self.results[f"match.crossing[depth={depth}]"] = summarize(
+            samples, depth=depth, trades=shard.total_trades)
+
+    def bench_cancel_heavy(self, depth):
+        """Cancel-heavy flow: three cancels per new resting order"""
+        rng = self._rng(f"cancel:{depth}")
+        engine = self._engine()
+        shard = engine.get_shard(SYMBOL)
+        clock = time.perf_counter_ns
+        active = []
+
+        def rest():
+            order = self._order(engine, OrderSide.BUY, rng.randint(1, 100),
+                                MID_TICKS - 1 - rng.randrange(depth))
+            active.append(order.order_id)
+            return self._process(shard, order, clock)
+
+        for _ in range(depth * 4):
+            rest()
+
+        samples = []
+        with Timer():
+            for i in range(self.operations):
+                if i % 4 == 0 or not active:
+                    samples.append(rest())
+                else:
+                    index = rng.randrange(len(active))
+                    active[index], active[-1] = active[-1], active[index]
+                    order_id = active.pop()
+                    start = clock()
+                    shard.cancel_order(order_id)
+                    samples.append(clock() - start)
+        self.results[f"match.cancel_heavy[depth={depth}]"] = summarize(
+            samples, depth=depth, cancel_ratio=0.75)
+
+    # ------------------------------------------------------------------
+    # End-to-end benchmarks
+
+    def bench_seeded_flow(self, orders=100000, chunk=1000, symbols=8,
+                          auction_orders=None):
+        """
+        Generated load through submit_orders and run_until_idle
+
+        Args:
+            auction_orders (int): Match every symbol in batch auctions of
+                this many orders instead of continuously
+        """
+        if self.quick:
+            orders //= 10
+        rng = self._rng('flow')
+        flow = [(f"T{rng.randint(1, 50)}", f"SYM{rng.randrange(symbols)}",
+                 OrderSide.BUY if rng.random() < 0.5 else OrderSide.SELL,
+                 rng.randint(1, 100), round(100 + rng.gauss(0, 0.5), 2))
+                for _ in range(orders)]
+
+        engine = self._engine()
+        if auction_orders:
+            for i in range(symbols):
+                engine.set_auction(f"SYM{i}",
+                                   BatchAuction(None, max_orders=auction_orders))
+        clock = time.perf_counter_ns
+        samples = []
+        with Timer():
+            start_all = clock()
+            for offset in range(0, orders, chunk):
+                batch = [engine.create_order(*fields)
+                         for fields in flow[offset:offset + chunk]]
+                start = clock()
+                engine.submit_orders(batch)
+                engine.run_until_idle()
+                samples.append((clock() - start) / len(batch))
+            elapsed_ns = clock() - start_all
+
+        stats = engine.get_performance_stats()
+        result = summarize(samples, orders=orders, chunk=chunk,
+                           symbols=symbols, auction_orders=auction_orders)
+        result['orders_per_second'] = orders / (elapsed_ns / 1e9)
+        # Same seed and backend give the same trades; a change here means
+        # matching behaviour changed, not just its speed
+        result['checksum'] = {
+            'trades': stats['total_trades'],
+            'volume': stats['total_volume']
+        }
+        name = 'e2e.seeded_flow'
+        if auction_orders:
+            name += f"[auction={auction_orders}]"
+        self.results[name] = result
+
+    def bench_simulation(self, traders=20, seconds=30.0):
+        """Virtual-clock Simulation of Trader bots"""
+        from models.clock import VirtualClock
+        from models.simulation import Simulation
+        from models.trader import Trader
+
+        if self.quick:
+            seconds /= 5
+        engine = TradingEngine(backend=self.backend, clock=VirtualClock())
+        simulation = Simulation(engine, seed=self.seed)
+        for i in range(traders):
+            trader = Trader(f"SIM_{i:03d}", 1000000, ['AAPL', 'MSFT', 'TSLA'],
+                            engine)
+            trader.order_frequency = 0.01
+            simulation.add_trader(trader)
+
+        with Timer():
+            run = simulation.run(seconds)
+        orders = max(1, run['orders_processed'])
+        result = summarize([run['wall_seconds'] * 1e9 / orders],
+                           traders=traders, simulated_seconds=seconds)
+        result['orders_per_second'] = orders / run['wall_seconds']
+        result['checksum'] = {
+            'orders': run['orders_processed'],
+            'trades': engine.get_performance_stats()['total_trades']
+        }
+        self.results['e2e.simulation'] = result
+
+    # ------------------------------------------------------------------
+
+    def benchmarks(self):
+        """(name prefix, callable) for every benchmark, in run order"""
+        for depth in self.depths:
+            yield f"book.[depth={depth}]", lambda d=depth: self.bench_book(d)
+        for depth in self.depths:
+            yield (f"match.resting[depth={depth}]",
+                   lambda d=depth: self.bench_resting(d))
+            yield (f"match.crossing[depth={depth}]",
+                   lambda d=depth: self.bench_crossing(d))
+            yield (f"match.cancel_heavy[depth={depth}]",
+                   lambda d=depth: self.bench_cancel_heavy(d))
+        yield 'e2e.seeded_flow', self.bench_seeded_flow
+        yield ('e2e.seeded_flow[auction=100]',
+               lambda: self.bench_seeded_flow(auction_orders=100))
+        yield 'e2e.simulation', self.bench_simulation
+
+    def run(self, only=None, verbose=True):
+        """
+        Run the benchmarks whose name starts with any prefix in only
+
+        Each benchmark runs warmup times (discarded) and then repeats
+        times; every result is the median across the repeats. Repeats are
+        passes over the whole selection rather than back-to-back runs, so
+        a slow spell of the machine lands in one run of many benchmarks
+        and shows up in their noise instead of in one benchmark's median.
+
+        Returns:
+            dict: Suite document ('meta' and 'benchmarks')
+        """
+        selected = [(name, bench) for name, bench in self.benchmarks()
+                    if not only or any(name.startswith(prefix)
+                                       for prefix in only)]
+        for name, bench in selected:
+            if verbose:
+                print(f"warming up {name}", file=sys.stderr)
+            for _ in range(self.warmup):
+                bench()
+
+        runs = {}
+        for repeat in range(self.repeats):
+            for name, bench in selected:
+                if verbose:
+                    print(f"running {name} ({repeat + 1}/{self.repeats})",
+                          file=sys.stderr)
+                # Inputs are reseeded per call, so every run is identical
+                self.results = {}
+                calibration_ns = calibrate()
+                bench()
+                for key, result in self.results.items():
+                    result['calibration_ns'] = calibration_ns
+                    runs.setdefault(key, []).append(result)
+        self.results = {key: aggregate(results)
+                        for key, results in runs.items()}
+        return {'meta': self.metadata(), 'benchmarks': self.results}
+
+    def metadata(self):
+        """Where and how the results were produced"""
+        try:
+            commit = subprocess.run(['git', 'rev-parse', '--short', 'HEAD'],
+                                    capture_output=True, text=True,
+                                    check=True).stdout.strip()
+        except (OSError, subprocess.CalledProcessError):
+            commit = None
+        return {
+            'suite_version': SUITE_VERSION,
+            'created': datetime.now().isoformat(timespec='seconds'),
+            'commit': commit,
+            'python': platform.python_version(),
+            'implementation': platform.python_implementation(),
+            'platform': platform.platform(),
+            'backend': self.backend,
+            'seed': self.seed,
+            'operations': self.operations,
+            'quick': self.quick,
+            'repeats': self.repeats,
+            'warmup': self.warmup
+        }
+
+
+def compare(results, baseline, threshold):
+    """
+    Compare results with a baseline
+
+    A benchmark regresses when its median p50 or p99 grows by more than
+    the allowed change, or when its checksum differs. Changes are scaled
+    by the two files' calibration times, so a uniformly slower machine is
+    not read as a regression. The allowed change
+    is the larger of threshold (a fraction) and NOISE_DEVIATIONS times the
+    run-to-run noise measured in either file, so a noisy benchmark needs
+    a larger shift to be flagged. A p99 reported as None (too few samples)
+    is not compared.
+
+    Returns:
+        list: (name, metric, baseline value, current value, change,
+            allowed change, regressed)
+    """
+    rows = []
+    for name, current in results['benchmarks'].items():
+        previous = baseline.get('benchmarks', {}).get(name)
+        if previous is None:
+            continue
+        speed = 1.0
+        if current.get('calibration_ns') and previous.get('calibration_ns'):
+            speed = previous['calibration_ns'] / current['calibration_ns']
+        for metric in COMPARED:
+            if current.get(metric) is None or previous.get(metric) is None:
+                continue
+            change = current[metric] * speed / previous[metric] - 1 if \
+                previous[metric] else 0.0
+            noise = max(current.get('noise', {}).get(metric, 0.0),
+                        previous.get('noise', {}).get(metric, 0.0))
+            allowed = max(threshold, NOISE_DEVIATIONS * noise)
+            rows.append((name, metric, previous[metric], current[metric],
+                         change, allowed, change > allowed))
+        if 'checksum' in previous and current.get('checksum') != previous[
+                'checksum']:
+            rows.append((name, 'checksum', previous['checksum'],
+                         current.get('checksum'), None, None, True))
+    return rows
+
+
+def print_results(results):
+    """Print a one-line-per-benchmark table"""
+    def cell(value):
+        return f"{value:>12.0f}" if value is not None else f"{'-':>12}"
+
+    print(f"{'benchmark':<40}{'p50':>12}{'p99':>12}{'max':>12}{'ops/s':>14}"
+          f"{'noise':>8}")
+    for name, result in results['benchmarks'].items():
+        noise = max(result.get('noise', {}).values(), default=0.0)
+        print(f"{name:<40}{cell(result['p50'])}{cell(result['p99'])}"
+              f"{cell(result['max'])}{result['ops_per_second']:>14,.0f}"
+              f"{noise:>8.1%}")
+
+
+def print_comparison(rows, threshold):
+    """Print the baseline comparison; returns the number of regressions"""
+    regressions = 0
+    print(f"\n{'benchmark':<40}{'metric':>9}{'baseline':>12}{'current':>12}"
+          f"{'change':>9}{'allowed':>9}")
+    for name, metric, previous, current, change, allowed, regressed in rows:
+        regressions += regressed
+        flag = '  REGRESSION' if regressed else ''
+        if change is None:
+            print(f"{name:<40}{metric:>9}  {previous} -> {current}{flag}")
+        else:
+            print(f"{name:<40}{metric:>9}{previous:>12.0f}{current:>12.0f}"
+                  f"{change:>+9.1%}{allowed:>+9.1%}{flag}")
+    print(f"\nchanges are adjusted for machine speed (calibration); "
+          f"{regressions} regression(s) beyond the larger of "
+          f"{threshold:.0%} and the measured noise")
+    return regressions
+
+
+def main(argv=None):
+    """Run the suite from the command line"""
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('--output', help="Write results JSON to this file")
+    parser.add_argument('--baseline', help="Compare with this results JSON")
+    parser.add_argument('--threshold', type=float, default=0.10,
+                        help="Smallest p50/p99 growth counted as a "
+                        "regression (fraction, default 0.10); noisier "
+                        "benchmarks are allowed more")
+    parser.add_argument('--backend', default='python',
+                        choices=('python', 'native'))
+    parser.add_argument('--seed', type=int, default=0)
+    parser.add_argument('--operations', type=int, default=20000,
+                        help="Timed operations per micro benchmark")
+    parser.add_argument('--only', nargs='*',
+                        help="Run benchmarks whose name starts with a prefix")
+    parser.add_argument('--quick', action='store_true',
+                        help="Smaller depths and loads")
+    parser.add_argument('--repeats', type=int, default=5,
+                        help="Measured runs per benchmark (medians reported)")
+    parser.add_argument('--warmup', type=int, default=1,
+                        help="Discarded runs per benchmark before measuring")
+    args = parser.parse_args(argv)
+
+    suite = BenchmarkSuite(args.backend, args.seed, args.operations,
+                           args.quick, args.repeats, args.warmup)
+    results = suite.run(args.only)
+    print_results(results)
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(results, f, indent=2)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        rows = compare(results, baseline, args.threshold)
+        if print_comparison(rows, args.threshold):
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""
+Order-entry gateway server and load generator
+
+`serve` runs a TradingEngine behind an OrderGateway (see
+models/order_gateway.py) and prints per-session counters; `load` connects
+seeded sessions that stream orders in batches and reports throughput and
+ACK round-trip latency.
+
+    python gateway_server.py serve --port 9100 --backend native
+    python gateway_server.py load --port 9100 --sessions 4 --orders 50000
+"""
+import argparse
+import random
+import threading
+import time
+
+from models.engine import TradingEngine
+from models.latency import LatencyHistogram
+from models.order import OrderSide
+from models.order_gateway import ACK, FILL, GatewayClient, OrderGateway
+
+
+def serve(args):
+    """Run an engine and gateway until interrupted"""
+    engine = TradingEngine(backend=args.backend, num_shards=args.shards)
+    gateway = OrderGateway(engine, args.host, args.port, args.udp_port,
+                           cancel_on_disconnect=args.cancel_on_disconnect)
+    engine.start()
+    gateway.start()
+    print(f"Gateway listening on {gateway.host}:{gateway.port}" +
+          (f" (udp {gateway.udp_port})" if gateway.udp_port else ""))
+    try:
+        while True:
+            time.sleep(args.report_seconds)
+            stats = gateway.get_statistics()
+            print(f"sessions {stats['sessions_open']}  orders "
+                  f"{stats['orders_submitted']:,}  avg batch "
+                  f"{stats['average_batch']:.1f}")
+            for session in stats['sessions']:
+                ingress = session['ingress_latency']
+                print(f"  {session['session_id']:>3} {session['trader_id']}: "
+                      f"{session['orders_per_second']:,.0f} orders/s, "
+                      f"{session['fills']:,} fills, ingress p50 "
+                      f"{ingress['p50_us']:.0f}us p99 {ingress['p99_us']:.0f}us")
+    except KeyboardInterrupt:
+        pass
+    finally:
+        gateway.stop()
+        engine.stop()
+
+
+def run_session(args, index, results):
+    """Stream one session's seeded orders and time the responses"""
+    rng = random.Random(args.seed * 1000 + index)
+    client = GatewayClient(args.host, args.port, f"LOAD{index}")
+    symbols = [f"SYM{i}" for i in range(args.symbols)]
+    ack_latency = LatencyHistogram()
+    acks = fills = 0
+
+    def receive(timeout):
+        nonlocal acks, fills
+        now = time.perf_counter_ns()
+        for response in client.poll(timeout):
+            if response.type == ACK:
+                acks += 1
+                ack_latency.record(now - response.aux)
+            elif response.type == FILL:
+                fills += 1
+
+    start = time.perf_counter()
+    sent = 0
+    while sent < args.orders:
+        for _ in range(min(args.batch, args.orders - sent)):
+            client.new_order(rng.choice(symbols),
+                             OrderSide.BUY if rng.random() < 0.5 else OrderSide.SELL,
+                             rng.randint(1, 10),
+                             round(100 + rng.gauss(0, 0.5), 2))
+        sent += min(args.batch, args.orders - sent)
+        client.flush()
+        receive(0.0)
+        # Keep at most a window of unacknowledged orders in flight
+        while sent - acks > args.window:
+            receive(0.01)
+    deadline = time.monotonic() + 10.0
+    while acks < sent and time.monotonic() < deadline:
+        receive(0.01)
+    elapsed = time.perf_counter() - start
+    receive(0.1)
+    client.close()
+    results[index] = (sent, acks, fills, elapsed, ack_latency)
+
+
+def load(args):
+    """Run load sessions in parallel and print a summary"""
+    results = [None] * args.sessions
+    threads = [threading.Thread(target=run_session, args=(args, i, results))
+               for i in range(args.sessions)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    latency = LatencyHistogram()
+    for _, _, _, _, histogram in results:
+        latency.merge(histogram)
+    sent = sum(result[0] for result in results)
+    acks = sum(result[1] for result in results)
+    fills = sum(result[2] for result in results)
+    elapsed = max(result[3] for result in results)
+    summary = latency.summary()
+    print(f"{args.sessions} sessions, {sent:,} orders in {elapsed:.2f}s "
+          f"({sent / elapsed:,.0f} orders/s), {acks:,} acks, {fills:,} fills")
+    print(f"ACK round trip: p50 {summary['p50_us']:.0f}us  p99 "
+          f"{summary['p99_us']:.0f}us  max {summary['max_us']:.0f}us")
+
+
+def main(argv=None):
+    """Command-line entry point"""
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    serve_parser = commands.add_parser('serve', help="Run the gateway")
+    serve_parser.add_argument('--host', default='127.0.0.1')
+    serve_parser.add_argument('--port', type=int, default=9100)
+    serve_parser.add_argument('--udp-port', type=int, default=None)
+    serve_parser.add_argument('--backend', default='python',
+                              choices=['python', 'native', 'auto'])
+    serve_parser.add_argument('--shards', type=int, default=1)
+    serve_parser.add_argument('--cancel-on-disconnect', action='store_true')
+    serve_parser.add_argument('--report-seconds', type=float, default=5.0)
+
+    load_parser = commands.add_parser('load', help="Generate order load")
+    load_parser.add_argument('--host', default='127.0.0.1')
+    load_parser.add_argument('--port', type=int, default=9100)
+    load_parser.add_argument('--sessions', type=int, default=1)
+    load_parser.add_argument('--orders', type=int, default=20000,
+                             help="Orders per session")
+    load_parser.add_argument('--batch', type=int, default=100,
+                             help="Orders per write")
+    load_parser.add_argument('--window', type=int, default=5000,
+                             help="Most unacknowledged orders in flight")
+    load_parser.add_argument('--symbols', type=int, default=4)
+    load_parser.add_argument('--seed', type=int, default=0)
+
+    args = parser.parse_args(argv)
+    serve(args) if args.command == 'serve' else load(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,187 @@
+"""
+Frequent batch auctions (call-market matching)
+
+A symbol in auction mode does not match orders as they arrive. Incoming
+orders are sealed in a batch until the auction runs (on a fixed grid of
+interval_seconds, or once max_orders have collected); the batch is then
+added to the book and the crossed part of the book is uncrossed in one pass
+at a single clearing price:
+
+1. The crossed levels are aggregated into demand D(p), the bid quantity at
+   p or better, and supply S(p), the ask quantity at p or better.
+2. The auction clears at the price that maximizes executed volume
+   min(D, S); ties go to the smallest imbalance |D - S|, then to the price
+   nearest the reference (the previous clearing price or last trade, else
+   the middle of the tied range).
+3. The short side fills completely. The long side fills in price priority;
+   at its marginal level the remainder is allocated by time priority or
+   pro rata to order size (rounded down, leftover lots by time priority).
+
+Every fill prints at the clearing price. Resting orders that did not fill
+stay in the book and join the next auction.
+"""
+
+TIME_PRIORITY = 'time'
+PRO_RATA = 'pro_rata'
+ALLOCATIONS = (TIME_PRIORITY, PRO_RATA)
+
+
+class BatchAuction:
+    """Auction schedule, allocation rule and sealed batch of one symbol"""
+
+    def __init__(self, interval_seconds=0.1, max_orders=None,
+                 allocation=TIME_PRIORITY):
+        """
+        Initialize an auction
+
+        Args:
+            interval_seconds (float): Auction period on the engine clock
+                (None to trigger on max_orders only)
+            max_orders (int): Run as soon as this many orders are sealed
+                (None to run on the interval only)
+            allocation (str): 'time' or 'pro_rata' at the marginal level
+        """
+        if interval_seconds is None and max_orders is None:
+            raise ValueError("BatchAuction needs interval_seconds or max_orders")
+        if allocation not in ALLOCATIONS:
+            raise ValueError(f"Unknown auction allocation: {allocation}")
+        self.interval_ns = (None if interval_seconds is None else
+                            int(interval_seconds * 1_000_000_000))
+        self.max_orders = max_orders
+        self.allocation = allocation
+
+        self.pending = {}  # order_id -> sealed order, in arrival order
+        self.next_due_ns = None  # Set when the first order of a batch arrives
+
+        # Statistics
+        self.auctions_run = 0
+        self.orders_auctioned = 0
+        self.volume_cleared = 0
+        self.last_clearing_tick = None
+
+    def collect(self, order, now_ns):
+        """
+        Seal an order into the current batch
+
+        Returns:
+            bool: True if the batch reached max_orders and should run now
+        """
+        if not self.pending and self.interval_ns is not None:
+            # Next point of the interval grid, so batch boundaries do not
+            # depend on when the first order happened to arrive
+            self.next_due_ns = (now_ns // self.interval_ns + 1) * self.interval_ns
+        self.pending[order.order_id] = order
+        return self.max_orders is not None and len(self.pending) >= self.max_orders
+
+    def is_due(self, now_ns):
+        """Whether the interval of a non-empty batch has elapsed"""
+        return (bool(self.pending) and self.next_due_ns is not None and
+                now_ns >= self.next_due_ns)
+
+    def take_batch(self):
+        """Unseal the current batch (in arrival order) and start a new one"""
+        batch = list(self.pending.values())
+        self.pending = {}
+        self.next_due_ns = None
+        return batch
+
+    def get_statistics(self):
+        """Get auction counters"""
+        return {
+            'interval_ms': (None if self.interval_ns is None else
+                            self.interval_ns / 1e6),
+            'max_orders': self.max_orders,
+            'allocation': self.allocation,
+            'sealed_orders': len(self.pending),
+            'auctions_run': self.auctions_run,
+            'orders_auctioned': self.orders_auctioned,
+            'volume_cleared': self.volume_cleared,
+            'last_clearing_tick': self.last_clearing_tick
+        }
+
+
+def find_clearing_price(bids, asks, reference_tick=None):
+    """
+    Find the tick that maximizes executed volume
+
+    Args:
+        bids (list): (tick, quantity) of the crossed bid levels
+        asks (list): (tick, quantity) of the crossed ask levels
+        reference_tick (int): Tie-break target (None for the middle of the
+            tied range)
+
+    Returns:
+        tuple: (clearing tick, volume), or None if nothing crosses
+    """
+    candidates = sorted({tick for tick, _ in bids} | {tick for tick, _ in asks})
+    bids = sorted(bids)  # Ascending: demand at p drops bids below p
+    asks = sorted(asks)
+    demand = sum(quantity for _, quantity in bids)
+    supply = 0
+    b = a = 0
+    best_key = None
+    tied = []
+
+    for tick in candidates:
+        while b < len(bids) and bids[b][0] < tick:
+            demand -= bids[b][1]
+            b += 1
+        while a < len(asks) and asks[a][0] <= tick:
+            supply += asks[a][1]
+            a += 1
+        key = (min(demand, supply), -abs(demand - supply))
+        if best_key is None or key > best_key:
+            best_key = key
+            tied = [tick]
+        elif key == best_key:
+            tied.append(tick)
+
+    if best_key is None or best_key[0] <= 0:
+        return None
+    if reference_tick is None:
+        reference_tick = (tied[0] + tied[-1]) // 2
+    tick = min(tied, key=lambda t: (abs(t - reference_tick), t))
+    return tick, best_key[0]
+
+
+def allocate(levels, volume, allocation=TIME_PRIORITY):
+    """
+    Split a side's executed volume across its crossed orders
+
+    Args:
+        levels (list): Order lists per level in price priority, each FIFO
+        volume (int): Quantity this side trades
+        allocation (str): 'time' or 'pro_rata' at the marginal level
+
+    Returns:
+        list: (order, quantity) fills in priority order
+    """
+    fills = []
+    remaining = volume
+    for orders in levels:
+        if remaining <= 0:
+            break
+        total = sum(order.quantity for order in orders)
+        if total <= remaining or allocation == TIME_PRIORITY:
+            for order in orders:
+                if remaining <= 0:
+                    break
+                quantity = min(order.quantity, remaining)
+                fills.append((order, quantity))
+                remaining -= quantity
+            continue
+
+        # Marginal level, pro rata: each floor drops less than one lot, so
+        # the leftover is under one lot per order and goes out by time
+        shares = [order.quantity * remaining // total for order in orders]
+        leftover = remaining - sum(shares)
+        for i, order in enumerate(orders):
+            if leftover <= 0:
+                break
+            if shares[i] < order.quantity:
+                shares[i] += 1
+                leftover -= 1
+        fills.extend((order, share) for order, share in zip(orders, shares)
+                     if share > 0)
+        remaining = 0
+    return fills
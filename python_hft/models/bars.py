@@ -0,0 +1,177 @@
+from collections import deque
+
+# Bar intervals kept for every symbol (seconds); None is the whole session
+DEFAULT_BAR_INTERVALS = (1, 60, None)
+
+# Completed bars retained per interval
+DEFAULT_BAR_HISTORY = 300
+
+NS_PER_SECOND = 1_000_000_000
+
+
+class Bar:
+    """
+    OHLC/volume/VWAP accumulator for one time bucket
+
+    Prices are kept in integer ticks and notional as sum(ticks * quantity),
+    so accumulating never drifts and VWAP is a single division on read.
+    """
+
+    __slots__ = ('start_ns', 'open_ticks', 'high_ticks', 'low_ticks',
+                 'close_ticks', 'volume', 'notional_ticks', 'trade_count')
+
+    def __init__(self, start_ns, price_ticks, quantity):
+        """
+        Open a bar with its first trade
+
+        Args:
+            start_ns (int): Bucket start (wall-clock ns since the epoch)
+            price_ticks (int): First trade price in ticks
+            quantity (int): First trade quantity
+        """
+        self.start_ns = start_ns
+        self.open_ticks = price_ticks
+        self.high_ticks = price_ticks
+        self.low_ticks = price_ticks
+        self.close_ticks = price_ticks
+        self.volume = quantity
+        self.notional_ticks = price_ticks * quantity
+        self.trade_count = 1
+
+    def add(self, price_ticks, quantity):
+        """Fold a trade into the bar"""
+        if price_ticks > self.high_ticks:
+            self.high_ticks = price_ticks
+        elif price_ticks < self.low_ticks:
+            self.low_ticks = price_ticks
+        self.close_ticks = price_ticks
+        self.volume += quantity
+        self.notional_ticks += price_ticks * quantity
+        self.trade_count += 1
+
+    def to_dict(self, tick_scale, interval_seconds):
+        """
+        Convert the bar to display prices
+
+        Args:
+            tick_scale (TickScale): Book's tick conversion
+            interval_seconds (int): Bar length, or None for the session bar
+        """
+        to_price = tick_scale.to_price
+        return {
+            'start_ns': self.start_ns,
+            'interval_seconds': interval_seconds,
+            'open': to_price(self.open_ticks),
+            'high': to_price(self.high_ticks),
+            'low': to_price(self.low_ticks),
+            'close': to_price(self.close_ticks),
+            'volume': self.volume,
+            'vwap': self.notional_ticks * tick_scale.tick_size / self.volume,
+            'trade_count': self.trade_count
+        }
+
+
+class BarSeries:
+    """
+    Streaming bars for one interval
+
+    The current bar is updated in place; when a trade falls in a later
+    bucket the current bar is moved to a bounded history of completed bars.
+    """
+
+    def __init__(self, interval_seconds, history=DEFAULT_BAR_HISTORY):
+        """
+        Initialize the series
+
+        Args:
+            interval_seconds (int): Bar length, or None for one session bar
+            history (int): Completed bars retained
+        """
+        self.interval_seconds = interval_seconds
+        self.interval_ns = (interval_seconds * NS_PER_SECOND
+                            if interval_seconds else None)
+        self.current = None
+        self.completed = deque(maxlen=history)
+
+    def record(self, price_ticks, quantity, timestamp_ns):
+        """Fold a trade into the bar covering timestamp_ns"""
+        current = self.current
+        if self.interval_ns is None:
+            if current is None:
+                self.current = Bar(timestamp_ns, price_ticks, quantity)
+            else:
+                current.add(price_ticks, quantity)
+            return
+
+        start_ns = timestamp_ns - timestamp_ns % self.interval_ns
+        if current is not None and current.start_ns == start_ns:
+            current.add(price_ticks, quantity)
+            return
+
+        if current is not None:
+            self.completed.append(current)
+        self.current = Bar(start_ns, price_ticks, quantity)
+
+
+class SymbolBars:
+    """
+    Per-symbol set of streaming bars (e.g. 1s, 1m and session)
+
+    Written only by the matching thread that owns the symbol; readers get
+    dict copies via get_bar()/get_bars().
+    """
+
+    def __init__(self, tick_scale, intervals=DEFAULT_BAR_INTERVALS,
+                 history=DEFAULT_BAR_HISTORY):
+        """
+        Initialize the accumulators
+
+        Args:
+            tick_scale (TickScale): Book's tick conversion
+            intervals (tuple): Bar lengths in seconds (None for session)
+            history (int): Completed bars retained per interval
+        """
+        self.tick_scale = tick_scale
+        self.series = {
+            interval: BarSeries(interval, history)
+            for interval in intervals
+        }
+        self.series_list = list(self.series.values())
+
+    def record(self, price_ticks, quantity, timestamp_ns):
+        """Fold a trade into every interval"""
+        for series in self.series_list:
+            series.record(price_ticks, quantity, timestamp_ns)
+
+    def get_bar(self, interval=None):
+        """
+        Get the in-progress bar for an interval
+
+        Returns:
+            dict: Bar in display prices, or None if nothing has traded
+        """
+        series = self.series.get(interval)
+        if series is None:
+            raise ValueError(f"No bars kept for interval {interval}")
+        bar = series.current
+        return bar.to_dict(self.tick_scale, interval) if bar else None
+
+    def get_bars(self, interval, count=0, include_current=True):
+        """
+        Get completed bars for an interval, oldest first
+
+        Args:
+            interval (int): Bar length in seconds
+            count (int): Maximum number of bars (0 for all retained)
+            include_current (bool): Append the in-progress bar
+        """
+        series = self.series.get(interval)
+        if series is None:
+            raise ValueError(f"No bars kept for interval {interval}")
+        bars = list(series.completed)
+        current = series.current
+        if include_current and current is not None:
+            bars.append(current)
+        if count > 0:
+            bars = bars[-count:]
+        return [bar.to_dict(self.tick_scale, interval) for bar in bars]
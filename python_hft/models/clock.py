@@ -0,0 +1,59 @@
+import time
+
+# Wall-clock start of every virtual session (2024-01-01 00:00:00 UTC), fixed
+# so trade timestamps are reproducible
+VIRTUAL_EPOCH_NS = 1_704_067_200_000_000_000
+
+
+class WallClock:
+    """Real time: the monotonic clock for intervals, the system clock for timestamps"""
+
+    is_virtual = False
+
+    @staticmethod
+    def monotonic_ns():
+        """Nanoseconds on the monotonic timeline (for intervals and latency)"""
+        return time.monotonic_ns()
+
+    @staticmethod
+    def time_ns():
+        """Wall-clock nanoseconds since the epoch (for trade timestamps)"""
+        return time.time_ns()
+
+
+class VirtualClock:
+    """
+    Simulated time that only moves when the scheduler advances it
+
+    Both timelines derive from one counter, so every timestamp the engine
+    takes is a pure function of the simulated event order.
+    """
+
+    is_virtual = True
+
+    def __init__(self, epoch_ns=VIRTUAL_EPOCH_NS):
+        """
+        Initialize a virtual clock at simulated time zero
+
+        Args:
+            epoch_ns (int): Wall-clock time that simulated time zero maps to
+        """
+        self.epoch_ns = epoch_ns
+        self.now_ns = 0
+
+    def monotonic_ns(self):
+        """Simulated nanoseconds since the session started"""
+        return self.now_ns
+
+    def time_ns(self):
+        """Simulated wall-clock nanoseconds since the epoch"""
+        return self.epoch_ns + self.now_ns
+
+    def advance_to(self, now_ns):
+        """Move simulated time forward to now_ns"""
+        if now_ns < self.now_ns:
+            raise ValueError("Virtual time cannot move backwards")
+        self.now_ns = now_ns
+
+
+WALL_CLOCK = WallClock()
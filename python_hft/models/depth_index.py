@@ -0,0 +1,140 @@
+"""
+Cumulative depth index for sweep-cost queries
+
+Two Fenwick (binary indexed) trees over one book side's tick window, in
+priority order (best price first): resting quantity, and notional in
+ticks x quantity. Prefix sums give the quantity and cost of every level up
+to a price in O(log n), and descending the trees finds the level where a
+sweep of a given size stops, also in O(log n). Sums are integers, so costs
+are exact.
+
+The index is built the first time a side is queried. After that the side
+only appends (tick, quantity delta) to a pending list on each change,
+which the next query folds in; the index is rebuilt from the window when
+the window moves or more changes are pending than a rebuild costs. Levels
+outside the window are not indexed; the side sweeps them itself.
+"""
+
+
+class DepthIndex:
+    """Fenwick trees of quantity and tick notional over a side's ladder"""
+
+    __slots__ = ('size', 'base_tick', 'is_bid_side', 'top_step', 'quantity',
+                 'notional', 'pending')
+
+    def __init__(self, levels, base_tick, is_bid_side):
+        """
+        Build the index from a ladder
+
+        Args:
+            levels (list): Ladder index -> PriceLevel (None when empty)
+            base_tick (int): Tick stored at levels[0]
+            is_bid_side (bool): Bids sweep from the highest tick down
+        """
+        size = len(levels)
+        self.size = size
+        self.base_tick = base_tick
+        self.is_bid_side = is_bid_side
+        step = 1
+        while step * 2 <= size:
+            step *= 2
+        self.top_step = step if size else 0
+        self.pending = []  # (tick, quantity delta) not yet in the trees
+
+        # Positions are 1-based in priority order
+        quantity = [0] * (size + 1)
+        notional = [0] * (size + 1)
+        for index, level in enumerate(levels):
+            if level is not None and level.total_quantity:
+                position = self._position(level.tick)
+                quantity[position] = level.total_quantity
+                notional[position] = level.total_quantity * level.tick
+
+        # Linear-time Fenwick construction
+        for i in range(1, size + 1):
+            parent = i + (i & -i)
+            if parent <= size:
+                quantity[parent] += quantity[i]
+                notional[parent] += notional[i]
+        self.quantity = quantity
+        self.notional = notional
+
+    def _position(self, tick):
+        index = tick - self.base_tick
+        return self.size - index if self.is_bid_side else index + 1
+
+    def _tick(self, position):
+        if self.is_bid_side:
+            return self.base_tick + self.size - position
+        return self.base_tick + position - 1
+
+    def apply_pending(self):
+        """Fold pending level changes into the trees"""
+        quantity = self.quantity
+        notional = self.notional
+        size = self.size
+        for tick, delta in self.pending:
+            i = self._position(tick)
+            delta_notional = delta * tick
+            while i <= size:
+                quantity[i] += delta
+                notional[i] += delta_notional
+                i += i & -i
+        self.pending = []
+
+    def prefix(self, position):
+        """(quantity, notional) of positions 1..position"""
+        quantity = self.quantity
+        notional = self.notional
+        total_quantity = total_notional = 0
+        i = position
+        while i > 0:
+            total_quantity += quantity[i]
+            total_notional += notional[i]
+            i -= i & -i
+        return total_quantity, total_notional
+
+    def limit_position(self, limit_tick):
+        """Last position at or better than limit_tick (0 if none)"""
+        if limit_tick is None:
+            return self.size
+        if self.is_bid_side:
+            position = self.size - (limit_tick - self.base_tick)
+        else:
+            position = limit_tick - self.base_tick + 1
+        return max(0, min(self.size, position))
+
+    def sweep(self, quantity, limit_tick=None):
+        """
+        Walk the side until quantity is filled or limit_tick is passed
+
+        Args:
+            quantity (int): Quantity to take
+            limit_tick (int): Worst tick to take from (None for no limit)
+
+        Returns:
+            tuple: (filled quantity, notional in ticks, last tick taken from
+                or None if nothing was filled)
+        """
+        within, _ = self.prefix(self.limit_position(limit_tick))
+        target = min(quantity, within)
+        if target <= 0:
+            return 0, 0, None
+
+        # Largest position whose prefix is still short of the target; the
+        # sweep ends inside the next one (the last non-empty level when the
+        # whole depth within the limit is taken)
+        tree_quantity = self.quantity
+        tree_notional = self.notional
+        size = self.size
+        position = taken = taken_notional = 0
+        step = self.top_step
+        while step:
+            candidate = position + step
+            if candidate <= size and taken + tree_quantity[candidate] < target:
+                position = candidate
+                taken += tree_quantity[candidate]
+                taken_notional += tree_notional[candidate]
+            step >>= 1
+        tick = self._tick(position + 1)
+        return target, taken_notional + (target - taken) * tick, tick
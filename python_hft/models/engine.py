@@ -1,11 +1,16 @@
-import threading
-import time
-from datetime import datetime, timedelta
-from collections import defaultdict, deque
-import queue
+from datetime import datetime
+import itertools
+import zlib
 
-from models.order import Order, OrderSide, OrderStatus
-from models.orderbook import OrderBook
+from models.order import Order, OrderPool, OrderSide, OrderStatus
+from models.orderbook import OrderBook, DEFAULT_TICK_SIZE
+from models.matching_shard import MatchingShard
+from models.latency import StageHistograms
+from models.lock_stats import CountingLock, lock_statistics
+from models.events import EventDispatcher
+from models.market_data import MarketDataFeed
+from models.trade_store import TradeStore
+from models.clock import WALL_CLOCK
 
 
 class TradingEngine:
@@ -14,372 +19,655 @@ class TradingEngine:
         """Return a list of all symbols currently being tracked in the engine"""
         return list(self.orderbooks.keys())
 
-    def __init__(self):
-        """Initialize the trading engine"""
+    def __init__(self,
+                 tick_sizes=None,
+                 default_tick_size=DEFAULT_TICK_SIZE,
+                 num_shards=1,
+                 symbol_shards=None,
+                 batch_size=100,
+                 queue_capacity=65536,
+                 overflow_policy='block',
+                 wait_strategy='block',
+                 max_batch_size=None,
+                 backend='python',
+                 event_queue_capacity=65536,
+                 clock=None,
+                 journal=None,
+                 auctions=None,
+                 trade_store=None,
+                 price_band=None):
+        """
+        Initialize the trading engine
+
+        Args:
+            tick_sizes (dict): Optional symbol -> tick size overrides
+            default_tick_size (float): Tick size for symbols without an override
+            num_shards (int): Number of matching workers; symbols are spread
+                across them and each runs its own queue and thread
+            symbol_shards (dict): Optional symbol -> shard index pinning, used
+                to group symbols onto the same worker
+            batch_size (int): Orders each worker takes per batch while its
+                queue is shallow
+            queue_capacity (int): Slots in each worker's ingress ring
+            overflow_policy (str): 'block' makes submit_order wait for space
+                when a ring is full (on a stopped engine the caller matches
+                a batch inline instead); 'reject' makes it return None
+            wait_strategy: How idle workers wait for orders: 'block' (park
+                until submit_order wakes them), 'spin_yield' (poll, yield,
+                then park) or 'spin' (poll without parking), or a configured
+                models.wait_strategy.WaitStrategy copied for each worker
+            max_batch_size (int): Largest batch a worker takes when its queue
+                is backed up (None for 8 x batch_size)
+            backend (str): 'python' for the pure-Python matcher, 'native' for
+                the compiled core (see native/), or 'auto' to use native
+                when the library is available
+            event_queue_capacity (int): Undelivered fill events kept per
+                trader before new ones are dropped (consumers see the gap)
+            clock: Time source for order, trade and latency timestamps;
+                a VirtualClock makes the engine deterministic when it is
+                driven by a Simulation instead of start()
+            journal: Optional models.journal.Journal that records every
+                accepted order, cancel, amend and trade; its writer thread
+                runs while the engine does
+            auctions (dict): Optional symbol -> models.auction.BatchAuction;
+                those symbols match in periodic batch auctions instead of
+                continuously (see set_auction)
+            trade_store: Optional models.trade_store.TradeStore holding every
+                trade (None for one with the default hot window, spilling
+                to a temporary directory)
+            price_band (float): Orders and amends priced further than this
+                fraction from their symbol's last trade are rejected (None,
+                the default, for no band)
+        """
+        if num_shards < 1:
+            raise ValueError("num_shards must be at least 1")
+
+        shard_class = MatchingShard
+        if backend in ('native', 'auto'):
+            from models import native_backend
+            if backend == 'native' or native_backend.is_available():
+                native_backend.load_library()
+                shard_class = native_backend.NativeMatchingShard
+                backend = 'native'
+            else:
+                backend = 'python'
+        elif backend != 'python':
+            raise ValueError(f"Unknown matching backend: {backend}")
+        self.backend = backend
+        self.clock = clock or WALL_CLOCK
+        self.journal = journal
+
         self.orderbooks = {}  # symbol -> OrderBook
-        self.active_orders = {}  # order_id -> order
+        self.tick_sizes = dict(tick_sizes or {})  # symbol -> tick size
+        self.default_tick_size = default_tick_size
+        self.price_band = price_band
         self.traders = {}  # trader_id -> trader reference
-
-        # Trade execution tracking
-        self.trade_history = deque(maxlen=10000)
-        self.executions_today = 0
+        self.books_lock = CountingLock('books_lock')
+        self.last_prices = {}  # symbol -> last trade price (mark table)
+
+        # Order allocation (integer IDs and recycled order objects)
+        self.order_ids = itertools.count(1)
+        self.order_pool = OrderPool()
+        self.trade_ids = itertools.count(1)
+
+        # Fill/trade events are delivered to traders off the matching threads
+        self.events = EventDispatcher(event_queue_capacity)
+        self.market_data = MarketDataFeed(self)
+        self.trade_store = trade_store if trade_store is not None else TradeStore()
+
+        # Matching workers
+        self.batch_size = batch_size
+        self.shards = [
+            shard_class(shard_id, self, batch_size, queue_capacity,
+                        overflow_policy, wait_strategy, max_batch_size)
+            for shard_id in range(num_shards)
+        ]
+        self.symbol_shards = {}  # symbol -> MatchingShard
+        for symbol, shard_id in (symbol_shards or {}).items():
+            self._assign_shard(symbol, self.shards[shard_id])
+        for symbol, auction in (auctions or {}).items():
+            self.set_auction(symbol, auction)
 
         # Performance metrics
-        self.start_time = datetime.now()
-        self.total_trades = 0
-        self.total_volume = 0
-        self.latency_measurements = deque(maxlen=1000)
-
-        # Threading
+        self.start_time = datetime.fromtimestamp(self.clock.time_ns() / 1e9)
+        self.start_time_ns = self.clock.monotonic_ns()
         self.is_running = False
-        self.order_queue = queue.Queue()
-        self.execution_thread = None
-        self.stats_lock = threading.Lock()
-        self.orders_lock = threading.Lock()
-
-        # Order processing statistics (optimized for HFT)
-        self.orders_per_second = 0
-        self.last_stats_update = time.time()
-        self.orders_processed_since_last_update = 0
-        self.batch_size = 100  # Process orders in batches for better performance
 
     def start(self):
         """Start the trading engine"""
         if not self.is_running:
             self.is_running = True
-            self.execution_thread = threading.Thread(
-                target=self._execution_loop, daemon=True)
-            self.execution_thread.start()
+            self.events.start()
+            self.trade_store.start()
+            if self.journal is not None:
+                self.journal.start()
+            for shard in self.shards:
+                shard.start()
 
     def stop(self):
         """Stop the trading engine"""
         self.is_running = False
-        if self.execution_thread and self.execution_thread.is_alive():
-            self.execution_thread.join(timeout=2.0)
+        for shard in self.shards:
+            shard.stop()
+        self.events.stop()  # Delivers events published before the shards stopped
+        self.trade_store.stop()
+        if self.journal is not None:
+            self.journal.stop()  # Writes what the shards journalled
+
+    def run_until_idle(self):
+        """
+        Match everything queued and deliver its events on the calling thread
+
+        Used by Simulation to drive a stopped engine deterministically: shards
+        are drained in index order until every ring is empty, then auctions
+        whose interval has elapsed on the engine clock are run.
+
+        Returns:
+            int: Number of orders processed
+        """
+        if self.is_running:
+            raise RuntimeError("run_until_idle requires a stopped engine")
+
+        processed = 0
+        while True:
+            progressed = False
+            for shard in self.shards:
+                with shard.drain_lock:
+                    batch = shard.order_queue.drain(shard.batch_size)
+                    if batch:
+                        shard._process_batch(batch)
+                if batch:
+                    processed += len(batch)
+                    progressed = True
+            if not progressed:
+                break
+        for shard in self.shards:
+            if shard.auctions:
+                shard.run_due_auctions()
+        self.events.deliver_pending()
+        self.trade_store.spill()
+        return processed
 
     def register_trader(self, trader):
-        """Register a trader with the engine"""
+        """Register a trader with the engine and route its fill events to it"""
         self.traders[trader.trader_id] = trader
+        self.events.add_consumer(trader.trader_id, trader.on_fill_events)
+
+    def register_fill_consumer(self, consumer_id, callback, trader_ids=None):
+        """
+        Route the fills of one or more traders to a single batched callback
+
+        Args:
+            consumer_id: Key for the consumer's queue
+            callback (callable): Called with a list of FillEvent per batch
+            trader_ids (iterable): Traders whose fills go to this consumer
+                (defaults to [consumer_id])
+        """
+        self.events.add_consumer(consumer_id, callback, trader_ids)
+
+    def unregister_fill_consumer(self, consumer_id):
+        """Stop routing fills to a consumer"""
+        self.events.remove_consumer(consumer_id)
+
+    def subscribe_trades(self, consumer_id, callback):
+        """
+        Receive every trade as batches of TradeEvent, off the matching threads
+
+        Args:
+            consumer_id: Key for the subscription (used to unsubscribe)
+            callback (callable): Called with a list of TradeEvent per batch
+        """
+        self.events.subscribe_trades(consumer_id, callback)
+
+    def unsubscribe_trades(self, consumer_id):
+        """Stop a trade subscription"""
+        self.events.unsubscribe_trades(consumer_id)
+
+    def subscribe_market_data(self, consumer_id, callback, symbols=None):
+        """
+        Receive L2 level deltas and trade prints, off the matching threads
+
+        Args:
+            consumer_id: Key for the subscription (used to unsubscribe)
+            callback (callable): Called with a list of MarketDataEvent per batch
+            symbols (iterable): Symbols to follow (None for every symbol)
+
+        Returns:
+            dict: symbol -> snapshot to apply the updates to (see
+                models.market_data.L2Book)
+        """
+        return self.market_data.subscribe(consumer_id, callback, symbols)
+
+    def unsubscribe_market_data(self, consumer_id):
+        """Stop a market data subscription"""
+        self.market_data.unsubscribe(consumer_id)
+
+    def set_auction(self, symbol, auction):
+        """
+        Match a symbol in frequent batch auctions, or continuously again
+
+        Args:
+            symbol (str): Symbol to configure
+            auction: models.auction.BatchAuction (interval, order count
+                trigger and allocation rule), or None for continuous matching
+        """
+        self.get_shard(symbol).set_auction(symbol, auction)
+
+    def get_auction_statistics(self):
+        """Get per-symbol counters of every symbol in auction mode"""
+        stats = {}
+        for shard in self.shards:
+            stats.update(shard.get_auction_statistics())
+        return stats
 
     def get_orderbook(self, symbol):
         """Get or create order book for a symbol"""
-        if symbol not in self.orderbooks:
-            self.orderbooks[symbol] = OrderBook(symbol)
-        return self.orderbooks[symbol]
+        orderbook = self.orderbooks.get(symbol)
+        if orderbook is None:
+            with self.books_lock:
+                orderbook = self.orderbooks.get(symbol)
+                if orderbook is None:
+                    orderbook = self._create_orderbook(symbol)
+                    self.orderbooks[symbol] = orderbook
+        return orderbook
+
+    def _create_orderbook(self, symbol):
+        """Create the book for a symbol using the configured backend"""
+        tick_size = self.get_tick_size(symbol)
+        # The owning shard's orders_lock guards the book for other readers
+        shard = self._shard_for_new_symbol(symbol)
+        if self.backend == 'native':
+            from models.native_backend import NativeOrderBook
+            return NativeOrderBook(symbol, tick_size,
+                                   order_lookup=shard.active_orders.get,
+                                   lock=shard.orders_lock,
+                                   price_band=self.price_band)
+        return OrderBook(symbol, tick_size, lock=shard.orders_lock,
+                         price_band=self.price_band)
+
+    def get_tick_size(self, symbol):
+        """Get the tick size configured for a symbol"""
+        return self.tick_sizes.get(symbol, self.default_tick_size)
+
+    def set_tick_size(self, symbol, tick_size):
+        """Configure the tick size for a symbol before its book is created"""
+        if symbol in self.orderbooks:
+            raise ValueError(
+                f"Order book for {symbol} already exists; tick size is fixed")
+        self.tick_sizes[symbol] = tick_size
+
+    def _assign_shard(self, symbol, shard):
+        """Route a symbol to a shard"""
+        self.symbol_shards[symbol] = shard
+        shard.symbols.add(symbol)
+
+    def _shard_for_new_symbol(self, symbol):
+        """Look up or assign a symbol's shard (caller must hold books_lock)"""
+        shard = self.symbol_shards.get(symbol)
+        if shard is None:
+            # Stable hash so routing doesn't depend on PYTHONHASHSEED
+            index = zlib.crc32(symbol.encode()) % len(self.shards)
+            shard = self.shards[index]
+            self._assign_shard(symbol, shard)
+        return shard
+
+    def get_shard(self, symbol):
+        """Get the matching shard that owns a symbol"""
+        shard = self.symbol_shards.get(symbol)
+        if shard is None:
+            with self.books_lock:
+                shard = self._shard_for_new_symbol(symbol)
+        return shard
+
+    def create_order(self, trader_id, symbol, side, quantity, price):
+        """
+        Create an order from the engine's pool
+
+        Pooled orders are recycled once they are filled or cancelled, so the
+        caller must not keep a reference after submitting it.
+        """
+        order = self.order_pool.acquire(trader_id, symbol, side, quantity,
+                                        price)
+        if self.clock.is_virtual:
+            order.timestamp_ns = self.clock.monotonic_ns()
+        return order
 
     def submit_order(self, order):
-        """Submit an order for processing"""
-        order_submit_time = time.time()
-        order.submit_time = order_submit_time
-
-        # Add to queue for processing
-        self.order_queue.put(order)
-
-    def _execution_loop(self):
-        """Main execution loop that processes orders (optimized for HFT)"""
-        while self.is_running:
-            try:
-                # Process orders in batches for better performance
-                orders_to_process = []
-
-                # Collect batch of orders with minimal blocking
-                start_time = time.time()
-                while len(orders_to_process) < self.batch_size and (
-                        time.time() - start_time) < 0.001:
-                    try:
-                        order = self.order_queue.get_nowait()
-                        orders_to_process.append(order)
-                    except queue.Empty:
-                        break
-
-                # Process the batch
-                for order in orders_to_process:
-                    self._process_order(order)
-                    self.order_queue.task_done()
-
-                # If no orders, small sleep to prevent busy waiting
-                if not orders_to_process:
-                    time.sleep(0.0001)  # 0.1ms sleep for HFT performance
-
-            except Exception as e:
-                print(f"Error in execution loop: {e}")
-                time.sleep(0.001)  # Brief pause on error
-
-    def _process_order(self, order):
-        """Process a single order"""
-        process_start = time.time()
-
-        with self.orders_lock:
-            # Add to active orders
-            self.active_orders[order.order_id] = order
-
-            # Get order book
-            orderbook = self.get_orderbook(order.symbol)
-
-            # Try to match the order
-            self._match_order(order, orderbook)
-
-            # If order still has quantity, add to book
-            if order.is_active() and order.quantity > 0:
-                orderbook.add_order(order)
-            else:
-                # Remove from active orders if completely filled or cancelled
-                if order.order_id in self.active_orders:
-                    del self.active_orders[order.order_id]
-
-        # Record processing latency
-        process_end = time.time()
-        latency_ms = (process_end - process_start) * 1000
-
-        if hasattr(order, 'submit_time'):
-            total_latency_ms = (process_end - order.submit_time) * 1000
-            self.latency_measurements.append(total_latency_ms)
-
-        # Update statistics
-        self._update_processing_stats()
-
-    def _match_order(self, incoming_order, orderbook):
-        """Match an incoming order against the order book"""
-        if incoming_order.side == OrderSide.BUY:
-            # Match buy order against asks (sell orders)
-            self._match_buy_order(incoming_order, orderbook)
+        """
+        Submit an order for processing
+
+        Returns:
+            int: The order ID, or None if the ingress ring rejected the order
+        """
+        if order.order_id is None:
+            order.order_id = next(self.order_ids)
+        order.submit_time = self.clock.monotonic_ns()
+        # Once queued the shard may fill and recycle the order at any time
+        order_id = order.order_id
+
+        # Route to the shard that owns the symbol
+        if not self.get_shard(order.symbol).submit(order):
+            order.cancel()
+            return None
+        return order_id
+
+    def submit_orders(self, orders, rejected=None):
+        """
+        Submit a batch of orders, publishing each shard's share in one pass
+
+        Orders keep their relative order per symbol. With the 'reject'
+        overflow policy, orders that did not fit are cancelled.
+
+        Args:
+            orders (list): Orders from create_order
+            rejected (list): If given, receives the orders that were not
+                accepted (the only ones still safe to read afterwards;
+                accepted orders may be recycled as soon as they match)
+
+        Returns:
+            int: Number of orders accepted into the ingress rings
+        """
+        submit_time = self.clock.monotonic_ns()
+        order_ids = self.order_ids
+        for order in orders:
+            if order.order_id is None:
+                order.order_id = next(order_ids)
+            order.submit_time = submit_time
+
+        if len(self.shards) == 1:
+            batches = {self.shards[0]: orders}
         else:
-            # Match sell order against bids (buy orders)
-            self._match_sell_order(incoming_order, orderbook)
-
-    def _match_buy_order(self, buy_order, orderbook):
-        """Match a buy order against asks"""
-        while buy_order.quantity > 0 and buy_order.is_active():
-            best_ask = orderbook.get_best_ask()
-
-            if not best_ask or best_ask.price > buy_order.price:
-                break  # No more matching orders
-
-            # Execute trade
-            trade_quantity = min(buy_order.quantity, best_ask.quantity)
-            trade_price = best_ask.price  # Price-time priority: use ask price
-
-            self._execute_trade(buy_order, best_ask, trade_quantity,
-                                trade_price, orderbook)
-
-            # Remove ask order if completely filled
-            if best_ask.quantity == 0:
-                orderbook.remove_order(best_ask.order_id, OrderSide.SELL)
-                if best_ask.order_id in self.active_orders:
-                    del self.active_orders[best_ask.order_id]
-
-    def _match_sell_order(self, sell_order, orderbook):
-        """Match a sell order against bids"""
-        while sell_order.quantity > 0 and sell_order.is_active():
-            best_bid = orderbook.get_best_bid()
-
-            if not best_bid or best_bid.price < sell_order.price:
-                break  # No more matching orders
-
-            # Execute trade
-            trade_quantity = min(sell_order.quantity, best_bid.quantity)
-            trade_price = best_bid.price  # Price-time priority: use bid price
-
-            self._execute_trade(best_bid, sell_order, trade_quantity,
-                                trade_price, orderbook)
-
-            # Remove bid order if completely filled
-            if best_bid.quantity == 0:
-                orderbook.remove_order(best_bid.order_id, OrderSide.BUY)
-                if best_bid.order_id in self.active_orders:
-                    del self.active_orders[best_bid.order_id]
-
-    def _execute_trade(self, buy_order, sell_order, quantity, price,
-                       orderbook):
-        """Execute a trade between two orders"""
-        trade_time = datetime.now()
-
-        # Fill both orders
-        buy_order.fill(quantity, price)
-        sell_order.fill(quantity, price)
-
-        # Create trade record
-        trade = {
-            'trade_id': f"{self.total_trades + 1:06d}",
-            'timestamp': trade_time,
-            'symbol': buy_order.symbol,
-            'quantity': quantity,
-            'price': price,
-            'buyer_id': buy_order.trader_id,
-            'seller_id': sell_order.trader_id,
-            'buy_order_id': buy_order.order_id,
-            'sell_order_id': sell_order.order_id,
-            'side': 'BUY'  # From the perspective of the aggressive order
-        }
-
-        # Add to trade history
-        with self.stats_lock:
-            self.trade_history.append(trade)
-            self.total_trades += 1
-            self.total_volume += quantity
-
-        # Add to order book trade history
-        orderbook.add_trade(trade)
-
-        # Notify traders of fills
-        self._notify_trader_fill(buy_order, quantity, price)
-        self._notify_trader_fill(sell_order, quantity, price)
-
-    def _notify_trader_fill(self, order, quantity, price):
-        """Notify a trader that their order was filled"""
-        trader_id = order.trader_id
-        if trader_id in self.traders:
-            try:
-                trader = self.traders[trader_id]
-                trader.on_order_filled(order, quantity, price)
-            except Exception as e:
-                print(f"Error notifying trader {trader_id}: {e}")
-
-    def _update_processing_stats(self):
-        """Update processing statistics"""
-        current_time = time.time()
-        self.orders_processed_since_last_update += 1
-
-        # Update stats every second
-        if current_time - self.last_stats_update >= 1.0:
-            self.orders_per_second = self.orders_processed_since_last_update
-            self.orders_processed_since_last_update = 0
-            self.last_stats_update = current_time
+            batches = {}
+            symbol_shards = self.symbol_shards
+            for order in orders:
+                shard = symbol_shards.get(order.symbol)
+                if shard is None:
+                    shard = self.get_shard(order.symbol)
+                batch = batches.get(shard)
+                if batch is None:
+                    batch = batches[shard] = []
+                batch.append(order)
+
+        accepted = 0
+        for shard, batch in batches.items():
+            count = shard.submit_many(batch)
+            for order in batch[count:]:
+                order.cancel()
+            if rejected is not None:
+                rejected.extend(batch[count:])
+            accepted += count
+        return accepted
 
     def cancel_order(self, order_id):
         """Cancel an order"""
-        with self.orders_lock:
-            if order_id in self.active_orders:
-                order = self.active_orders[order_id]
-                order.cancel()
-
-                # Remove from order book
-                orderbook = self.get_orderbook(order.symbol)
-                orderbook.remove_order(order_id, order.side)
-
-                # Remove from active orders
-                del self.active_orders[order_id]
+        for shard in self.shards:
+            if shard.cancel_order(order_id):
                 return True
         return False
 
+    def cancel_all(self, trader_id, symbol=None):
+        """
+        Cancel every resting order of a trader
+
+        Args:
+            trader_id (str): Owner of the orders
+            symbol (str): Only cancel orders for this symbol if given
+
+        Returns:
+            int: Number of orders cancelled
+        """
+        if symbol is not None:
+            return self.get_shard(symbol).cancel_all(trader_id, symbol)
+        return sum(shard.cancel_all(trader_id) for shard in self.shards)
+
+    def amend_order(self, order_id, quantity=None, price=None):
+        """
+        Change a resting order's quantity and/or price
+
+        Size-downs keep queue priority; price changes and size-ups re-queue
+        the order (see MatchingShard.amend_order).
+
+        Returns:
+            bool: True if the amendment was applied or queued
+
+        Raises:
+            ValueError: If the price is NaN, infinite or outside the book's
+                price band (the order is left unchanged)
+        """
+        for shard in self.shards:
+            if order_id in shard.active_orders:
+                return shard.amend_order(order_id, quantity, price)
+        return False
+
     def get_recent_trades(self, count=20):
-        """Get recent trades across all symbols"""
-        with self.stats_lock:
-            return list(self.trade_history)[-count:] if count > 0 else list(
-                self.trade_history)
+        """Get recent trades across all symbols (0 or less: every trade)"""
+        return self.trade_store.get_recent_trades(count)
 
     def get_recent_trades_for_symbol(self, symbol, count=10):
-        """Get recent trades for a specific symbol"""
-        with self.stats_lock:
-            symbol_trades = [
-                trade for trade in self.trade_history
-                if trade['symbol'] == symbol
-            ]
-            return symbol_trades[-count:] if count > 0 else symbol_trades
+        """Get recent trades for a specific symbol (read from its book's tape)"""
+        orderbook = self.orderbooks.get(symbol)
+        if orderbook is None:
+            return []
+        return orderbook.get_recent_trades(count)
 
     def get_all_trades(self):
-        """Get all trades for export"""
-        with self.stats_lock:
-            return list(self.trade_history)
+        """Get every trade of the session for export, in sequence order"""
+        return self.trade_store.get_all_trades()
+
+    def iter_trades(self, after_sequence=0, symbol=None):
+        """
+        Stream the session's trades in sequence order (spilled ones included)
+
+        Args:
+            after_sequence (int): Only trades with a larger sequence
+            symbol (str): Only this symbol's trades (None for all)
+
+        Yields:
+            dict: Trade records
+        """
+        return self.trade_store.iter_trades(after_sequence, symbol)
+
+    def get_trade(self, sequence):
+        """Look up one trade by sequence (None if unknown)"""
+        return self.trade_store.get_trade(sequence)
+
+    def get_trade_batches(self):
+        """
+        Get every trade of the session as zero-copy column views
+
+        One batch per shard column chunk, spilled chunks decoded from disk;
+        see utils.data_export for Arrow, Parquet and statistics over them.
+
+        Returns:
+            list: (row_count, {column: memoryview}, symbols, traders) tuples,
+                where the 'symbol', 'buyer' and 'seller' columns are codes
+                into that batch's symbols and traders lists
+        """
+        return self.trade_store.batches()
 
     def get_performance_stats(self):
-        """Get engine performance statistics"""
-        with self.stats_lock:
-            current_time = datetime.now()
-            runtime_seconds = (current_time - self.start_time).total_seconds()
-
-            # Calculate trades per second
-            trades_per_second = self.total_trades / max(1, runtime_seconds)
-
-            # Calculate average latency
-            avg_latency_ms = 0
-            if self.latency_measurements:
-                avg_latency_ms = sum(self.latency_measurements) / len(
-                    self.latency_measurements)
-
-            # Count active orders
-            active_orders_count = len(self.active_orders)
-
-            return {
-                'total_trades': self.total_trades,
-                'total_volume': self.total_volume,
-                'trades_per_second': trades_per_second,
-                'orders_per_second': self.orders_per_second,
-                'avg_latency_ms': avg_latency_ms,
-                'active_orders': active_orders_count,
-                'runtime_seconds': runtime_seconds,
-                'symbols_active': len(self.orderbooks)
+        """Get engine performance statistics (aggregated across shards)"""
+        runtime_seconds = (self.clock.monotonic_ns() -
+                           self.start_time_ns) / 1e9
+
+        shard_stats = [shard.get_stats() for shard in self.shards]
+        total_trades = sum(stats['total_trades'] for stats in shard_stats)
+        total_volume = sum(stats['total_volume'] for stats in shard_stats)
+
+        # Calculate trades per second
+        trades_per_second = total_trades / max(1, runtime_seconds)
+
+        # Merge per-symbol stage histograms across shards
+        latency_by_symbol = {}
+        for shard in self.shards:
+            latency_by_symbol.update(shard.get_latency_histograms())
+        latency = StageHistograms()
+        for histograms in latency_by_symbol.values():
+            latency.merge(histograms)
+        avg_latency_ms = latency.total.mean() / 1e6
+
+        pool_stats = self.order_pool.get_statistics()
+
+        # Ingress backpressure across all rings
+        ingress_stats = [stats['ingress'] for stats in shard_stats]
+
+        return {
+            'total_trades': total_trades,
+            'total_volume': total_volume,
+            'trades_per_second': trades_per_second,
+            'orders_per_second':
+            sum(stats['orders_per_second'] for stats in shard_stats),
+            'avg_latency_ms': avg_latency_ms,
+            'latency': latency.summary(),
+            'latency_by_symbol': {
+                symbol: histograms.summary()
+                for symbol, histograms in latency_by_symbol.items()
+            },
+            'active_orders':
+            sum(stats['active_orders'] for stats in shard_stats),
+            'rejected_orders':
+            sum(stats['rejected_orders'] for stats in shard_stats),
+            'runtime_seconds': runtime_seconds,
+            'symbols_active': len(self.orderbooks),
+            'orders_allocated': pool_stats['allocated'],
+            'orders_reused': pool_stats['reused'],
+            'queue_depth': sum(stats['depth'] for stats in ingress_stats),
+            'queue_high_water_mark':
+            max(stats['high_water_mark'] for stats in ingress_stats),
+            'queue_overflows':
+            sum(stats['overflows'] for stats in ingress_stats),
+            'queue_backpressure_waits':
+            sum(stats['backpressure_waits'] for stats in ingress_stats),
+            'fill_events': self.events.get_statistics(),
+            'market_data': self.market_data.get_statistics(),
+            'trade_store': self.trade_store.get_statistics(),
+            'backend': self.backend,
+            'wait_strategy': shard_stats[0]['wait']['strategy'],
+            'shard_count': len(self.shards),
+            'shards': shard_stats,
+            # Acquisitions and wait time, summed over shards
+            'locks': {
+                'orders_lock':
+                lock_statistics([shard.orders_lock for shard in self.shards]),
+                'stats_lock':
+                lock_statistics([shard.stats_lock for shard in self.shards]),
+                'books_lock': self.books_lock.get_statistics()
             }
+        }
 
     def get_market_summary(self):
         """Get summary of all markets"""
         summary = {}
 
-        for symbol, orderbook in self.orderbooks.items():
+        for symbol, orderbook in list(self.orderbooks.items()):
             stats = orderbook.get_statistics()
-            recent_trades = orderbook.get_recent_trades(5)
-
-            # Calculate volume-weighted average price (VWAP) for recent trades
-            vwap = 0
-            if recent_trades:
-                total_value = sum(trade['price'] * trade['quantity']
-                                  for trade in recent_trades)
-                total_volume = sum(trade['quantity']
-                                   for trade in recent_trades)
-                if total_volume > 0:
-                    vwap = total_value / total_volume
+
+            # Running VWAP over the book's last few trades (0 before any trade)
+            vwap = orderbook.get_recent_vwap() or 0
+            last_price = orderbook.get_last_trade_price()
+            session = orderbook.get_bar()
 
             summary[symbol] = {
                 'best_bid': stats['mid_price'],
                 'best_ask': stats['mid_price'],
                 'spread': stats['spread'],
                 'mid_price': stats['mid_price'],
+                'last_price': last_price if last_price is not None else 0,
                 'vwap': vwap,
                 'volume':
                 stats['total_bid_volume'] + stats['total_ask_volume'],
-                'trade_count': len(recent_trades)
+                'trade_count': min(len(orderbook.trade_tape),
+                                   orderbook.trade_tape.vwap_window),
+                'session_vwap': session['vwap'] if session else 0,
+                'session_volume': session['volume'] if session else 0,
+                'session_trades': session['trade_count'] if session else 0
             }
 
         return summary
 
-    def get_trader_orders(self, trader_id):
-        """Get all active orders for a trader"""
-        with self.orders_lock:
-            return [
-                order for order in self.active_orders.values()
-                if order.trader_id == trader_id
-            ]
+    def get_mark(self, symbol):
+        """
+        Mark price for a symbol: its last trade price, else the book's mid
+        price (None if neither)
+
+        The last price is stored by the matching thread on every trade, so
+        this is a dictionary lookup, not a trade history read.
+        """
+        price = self.last_prices.get(symbol)
+        if price is None:
+            orderbook = self.orderbooks.get(symbol)
+            if orderbook is not None:
+                price = orderbook.get_mid_price()
+        return price
+
+    def get_marks(self):
+        """Mark price per symbol with a book (see get_mark)"""
+        return {symbol: self.get_mark(symbol) for symbol in list(self.orderbooks)}
+
+    def get_versions(self, traders=None):
+        """
+        Change counters for readers that redraw only what changed
+
+        Each is a plain attribute read, so polling them costs no locks.
+
+        Args:
+            traders (list): Traders to report (None for registered traders)
+
+        Returns:
+            dict: 'books' (symbol -> version, bumped on every book change),
+                'traders' (trader_id -> version, bumped on every fill) and
+                'trades' (trades recorded so far)
+        """
+        if traders is None:
+            traders = list(self.traders.values())
+        return {
+            'books': {
+                symbol: orderbook.get_version()
+                for symbol, orderbook in list(self.orderbooks.items())
+            },
+            'traders': {trader.trader_id: trader.version for trader in traders},
+            'trades': len(self.trade_store)
+        }
+
+    def get_trader_orders(self, trader_id, symbol=None):
+        """
+        Get all active orders for a trader (optionally for one symbol)
+
+        Returns:
+            list: OrderInfo copies, never the pooled Order objects
+        """
+        if symbol is not None:
+            return self.get_shard(symbol).get_trader_orders(trader_id, symbol)
+        orders = []
+        for shard in self.shards:
+            orders.extend(shard.get_trader_orders(trader_id))
+        return orders
 
     def get_symbol_statistics(self, symbol):
-        """Get detailed statistics for a symbol"""
-        if symbol not in self.orderbooks:
+        """Get detailed statistics for a symbol (read from its session bar)"""
+        orderbook = self.orderbooks.get(symbol)
+        if orderbook is None:
             return None
 
-        orderbook = self.orderbooks[symbol]
-        recent_trades = self.get_recent_trades_for_symbol(symbol, 100)
-
-        # Calculate price statistics
-        if recent_trades:
-            prices = [trade['price'] for trade in recent_trades]
-            high_price = max(prices)
-            low_price = min(prices)
-            last_price = prices[-1] if prices else 0
-
-            # Calculate VWAP
-            total_value = sum(trade['price'] * trade['quantity']
-                              for trade in recent_trades)
-            total_volume = sum(trade['quantity'] for trade in recent_trades)
-            vwap = total_value / total_volume if total_volume > 0 else 0
-        else:
-            high_price = low_price = last_price = vwap = 0
+        session = orderbook.get_bar()
+        if session is None:
+            session = {
+                'high': 0,
+                'low': 0,
+                'close': 0,
+                'vwap': 0,
+                'volume': 0,
+                'trade_count': 0
+            }
 
         return {
             'symbol': symbol,
-            'last_price': last_price,
-            'high_price': high_price,
-            'low_price': low_price,
-            'vwap': vwap,
-            'total_volume': sum(trade['quantity'] for trade in recent_trades),
-            'trade_count': len(recent_trades),
+            'last_price': session['close'],
+            'high_price': session['high'],
+            'low_price': session['low'],
+            'vwap': session['vwap'],
+            'total_volume': session['volume'],
+            'trade_count': session['trade_count'],
+            'bar_1m': orderbook.get_bar(60),
             'orderbook_stats': orderbook.get_statistics()
         }
@@ -0,0 +1,330 @@
+import threading
+from collections import deque
+
+
+class FillEvent:
+    """
+    Snapshot of one fill delivered to the order's owner
+
+    Carries the order fields trader callbacks read (symbol, side, IDs), so
+    the pooled Order can be recycled as soon as the event is published.
+    """
+
+    __slots__ = ('sequence', 'trader_id', 'order_id', 'symbol', 'side',
+                 'quantity', 'price', 'remaining_quantity', 'trade_sequence',
+                 'timestamp_ns')
+
+    def __init__(self, order, quantity, price, trade_sequence, timestamp_ns):
+        """
+        Initialize a fill event from the filled order
+
+        Args:
+            order (Order): Order that was filled (read immediately)
+            quantity (int): Quantity filled
+            price (float): Fill price
+            trade_sequence (int): Engine-wide trade sequence of the fill
+            timestamp_ns (int): Wall-clock ns when the trade executed
+        """
+        self.sequence = None  # Assigned per consumer on publish
+        self.trader_id = order.trader_id
+        self.order_id = order.order_id
+        self.symbol = order.symbol
+        self.side = order.side
+        self.quantity = quantity
+        self.price = price
+        self.remaining_quantity = order.quantity
+        self.trade_sequence = trade_sequence
+        self.timestamp_ns = timestamp_ns
+
+
+class TradeEvent:
+    """Trade record delivered to a trade subscriber"""
+
+    __slots__ = ('sequence', 'trade')
+
+    def __init__(self, trade):
+        """
+        Initialize a trade event
+
+        Args:
+            trade (dict): Trade record (shared, must not be mutated)
+        """
+        self.sequence = None  # Assigned per consumer on publish
+        self.trade = trade
+
+
+class MarketDataEvent:
+    """Market data update (LevelDelta or TradePrint) delivered to a subscriber"""
+
+    __slots__ = ('sequence', 'update')
+
+    def __init__(self, update):
+        """
+        Initialize a market data event
+
+        Args:
+            update: LevelDelta or TradePrint (shared, must not be mutated)
+        """
+        self.sequence = None  # Assigned per consumer on publish
+        self.update = update
+
+
+class EventQueue:
+    """
+    Bounded event queue for one consumer
+
+    Publishers stamp each event with the queue's next sequence number under
+    a short lock; an event dropped on overflow still consumes its number,
+    so the consumer sees the gap.
+    """
+
+    def __init__(self, consumer_id, callback, capacity=65536):
+        """
+        Initialize the queue
+
+        Args:
+            consumer_id: Key the queue is registered under
+            callback (callable): Receives a list of events per delivery
+            capacity (int): Maximum undelivered events before dropping
+        """
+        self.consumer_id = consumer_id
+        self.callback = callback
+        self.capacity = capacity
+        self.events = deque()
+        self.lock = threading.Lock()
+        self.next_sequence = 1
+        self.published = 0
+        self.delivered = 0
+        self.dropped = 0
+
+    def publish(self, events):
+        """Stamp and append a batch of events (dropping any that overflow)"""
+        with self.lock:
+            sequence = self.next_sequence
+            queue = self.events
+            for event in events:
+                event.sequence = sequence
+                sequence += 1
+                if len(queue) < self.capacity:
+                    queue.append(event)
+                else:
+                    self.dropped += 1
+            self.published += sequence - self.next_sequence
+            self.next_sequence = sequence
+
+    def take(self):
+        """Take every queued event (dispatcher only)"""
+        with self.lock:
+            if not self.events:
+                return None
+            events = self.events
+            self.events = deque()
+        self.delivered += len(events)
+        return events
+
+    def get_statistics(self):
+        """Get publish/delivery counters"""
+        return {
+            'pending': len(self.events),
+            'published': self.published,
+            'delivered': self.delivered,
+            'dropped': self.dropped
+        }
+
+
+class EventDispatcher:
+    """
+    Delivers fill, trade and market data events off the matching threads
+
+    Matching shards publish batches of events into per-consumer queues and
+    return immediately; a single dispatcher thread hands each consumer its
+    pending events as one batch. Matching never waits on a callback, but
+    consumers are called one after another on that thread, so a slow
+    callback delays every consumer's delivery (their queues keep filling up
+    to queue_capacity meanwhile, then drop).
+    """
+
+    # How long an idle dispatcher parks before re-checking is_running
+    IDLE_PARK_SECONDS = 0.01
+
+    def __init__(self, queue_capacity=65536):
+        """
+        Initialize the dispatcher
+
+        Args:
+            queue_capacity (int): Per-consumer undelivered event limit
+        """
+        self.queue_capacity = queue_capacity
+        self.queues = {}  # trader_id -> EventQueue its fills are published to
+        self.fill_queues = {}  # consumer_id -> EventQueue (fill consumers)
+        self.trade_queues = {}  # consumer_id -> EventQueue (trade subscribers)
+        self.market_data_queues = {}  # consumer_id -> EventQueue (L2 feed)
+        self.is_running = False
+        self.thread = None
+        self.parked = False
+        self.wakeup = threading.Event()
+        self.callback_errors = 0
+
+    def add_consumer(self, consumer_id, callback, trader_ids=None):
+        """
+        Register a consumer for fill events
+
+        Args:
+            consumer_id: Key for the consumer's queue
+            callback (callable): Called with a list of FillEvent per batch
+            trader_ids (iterable): Traders whose fills go to this consumer,
+                sharing one queue and sequence (defaults to [consumer_id])
+        """
+        self.remove_consumer(consumer_id)
+        queue = EventQueue(consumer_id, callback, self.queue_capacity)
+        self.fill_queues[consumer_id] = queue
+        for trader_id in (consumer_id, ) if trader_ids is None else trader_ids:
+            self.queues[trader_id] = queue
+
+    def remove_consumer(self, consumer_id):
+        """Stop delivering fill events to a consumer"""
+        queue = self.fill_queues.pop(consumer_id, None)
+        if queue is not None:
+            self.queues = {
+                trader_id: other
+                for trader_id, other in self.queues.items()
+                if other is not queue
+            }
+
+    def subscribe_trades(self, consumer_id, callback):
+        """Register a consumer for every trade's TradeEvent"""
+        self.trade_queues[consumer_id] = EventQueue(consumer_id, callback,
+                                                    self.queue_capacity)
+
+    def unsubscribe_trades(self, consumer_id):
+        """Stop delivering trade events to a consumer"""
+        self.trade_queues.pop(consumer_id, None)
+
+    def has_trade_subscribers(self):
+        """Check if any consumer wants trade events"""
+        return bool(self.trade_queues)
+
+    def subscribe_market_data(self, consumer_id, callback):
+        """
+        Register a consumer for MarketDataEvent batches
+
+        The market data feed decides which updates each queue receives.
+
+        Returns:
+            EventQueue: The consumer's queue
+        """
+        queue = EventQueue(consumer_id, callback, self.queue_capacity)
+        self.market_data_queues[consumer_id] = queue
+        return queue
+
+    def unsubscribe_market_data(self, consumer_id):
+        """Stop delivering market data events to a consumer"""
+        self.market_data_queues.pop(consumer_id, None)
+
+    def publish_fills(self, events_by_consumer):
+        """
+        Publish fill events (called by matching threads)
+
+        Args:
+            events_by_consumer (dict): consumer_id -> list of FillEvent
+        """
+        queues = self.queues
+        for consumer_id, events in events_by_consumer.items():
+            queue = queues.get(consumer_id)
+            if queue is not None:
+                queue.publish(events)
+        self._wake()
+
+    def publish_trades(self, trades):
+        """Publish trade records to every trade subscriber"""
+        for queue in list(self.trade_queues.values()):
+            queue.publish([TradeEvent(trade) for trade in trades])
+        self._wake()
+
+    def publish_market_data(self, updates_by_queue):
+        """
+        Publish market data updates (called by matching threads)
+
+        Args:
+            updates_by_queue (list): (EventQueue, list of updates) pairs
+        """
+        for queue, updates in updates_by_queue:
+            queue.publish([MarketDataEvent(update) for update in updates])
+        self._wake()
+
+    def _wake(self):
+        if self.parked:
+            self.wakeup.set()
+
+    def start(self):
+        """Start the delivery thread"""
+        if not self.is_running:
+            self.is_running = True
+            self.thread = threading.Thread(target=self._delivery_loop,
+                                           name="event-dispatcher",
+                                           daemon=True)
+            self.thread.start()
+
+    def stop(self):
+        """Deliver what is pending, then stop the delivery thread"""
+        self.is_running = False
+        self.wakeup.set()
+        if self.thread and self.thread.is_alive():
+            self.thread.join(timeout=2.0)
+
+    def deliver_pending(self):
+        """
+        Hand every consumer its pending events
+
+        Returns:
+            int: Number of events delivered
+        """
+        delivered = 0
+        for queues in (self.fill_queues, self.trade_queues,
+                       self.market_data_queues):
+            for queue in list(queues.values()):
+                events = queue.take()
+                if events is None:
+                    continue
+                delivered += len(events)
+                try:
+                    queue.callback(list(events))
+                except Exception as e:
+                    self.callback_errors += 1
+                    print(f"Error delivering events to {queue.consumer_id}: {e}")
+        return delivered
+
+    def _delivery_loop(self):
+        """Deliver events until stopped, then flush what is left"""
+        while self.is_running:
+            if self.deliver_pending():
+                continue
+            self.parked = True
+            try:
+                # Re-check after announcing we are parked so a publish
+                # between the two is not missed
+                if not self.deliver_pending():
+                    self.wakeup.wait(self.IDLE_PARK_SECONDS)
+                    self.wakeup.clear()
+            finally:
+                self.parked = False
+        self.deliver_pending()
+
+    def get_statistics(self):
+        """Get aggregate publish/delivery counters"""
+        stats = [
+            queue.get_statistics()
+            for queues in (self.fill_queues, self.trade_queues,
+                           self.market_data_queues)
+            for queue in list(queues.values())
+        ]
+        return {
+            'consumers': len(self.fill_queues),
+            'trade_subscribers': len(self.trade_queues),
+            'market_data_subscribers': len(self.market_data_queues),
+            'pending': sum(s['pending'] for s in stats),
+            'published': sum(s['published'] for s in stats),
+            'delivered': sum(s['delivered'] for s in stats),
+            'dropped': sum(s['dropped'] for s in stats),
+            'callback_errors': self.callback_errors
+        }
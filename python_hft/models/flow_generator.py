@@ -0,0 +1,289 @@
+import random
+import threading
+import time
+
+import numpy as np
+
+from models.order import OrderSide
+
+
+class PopulationFlowGenerator:
+    """
+    Order flow for a whole population of simulated traders from one thread
+
+    Instead of one thread per Trader, arrivals, symbols, sides, sizes and
+    price offsets for every trader are drawn together as numpy arrays each
+    step and submitted with TradingEngine.submit_orders. Cash and positions
+    live in arrays (one row per trader) and apply the same affordability
+    and inventory rules as Trader, so thousands of agents cost a few array
+    operations per step rather than thousands of threads.
+    """
+
+    def __init__(self,
+                 engine,
+                 num_traders=1000,
+                 symbols=None,
+                 initial_cash=100000.0,
+                 initial_position=0,
+                 order_frequency=0.1,
+                 min_order_size=10,
+                 max_order_size=100,
+                 price_volatility=0.02,
+                 cross_probability=0.2,
+                 initial_price=100.0,
+                 step_interval=0.01,
+                 seed=None,
+                 trader_id_prefix='POP'):
+        """
+        Initialize the population
+
+        Args:
+            engine: TradingEngine receiving the orders
+            num_traders (int): Number of simulated traders
+            symbols (list): Symbols to trade
+            initial_cash (float): Starting cash per trader
+            initial_position (int): Starting shares per trader and symbol
+                (traders only sell inventory they hold)
+            order_frequency (float): Mean seconds between one trader's orders
+            min_order_size (int): Smallest order quantity
+            max_order_size (int): Largest order quantity
+            price_volatility (float): Std-dev of the relative price offset
+            cross_probability (float): Share of orders priced through the
+                reference price instead of away from it, so the population
+                actually trades (Trader's passive quoting alone never crosses)
+            initial_price (float): Reference price before anything trades
+            step_interval (float): Seconds between generation steps when
+                running on the background thread
+            seed (int): Seed for reproducible flow
+            trader_id_prefix (str): Prefix for generated trader IDs (also the
+                fill consumer ID)
+        """
+        if num_traders < 1:
+            raise ValueError("num_traders must be at least 1")
+
+        self.engine = engine
+        self.symbols = list(symbols or ["AAPL", "GOOGL", "MSFT", "TSLA", "AMZN"])
+        self.num_traders = num_traders
+        self.initial_cash = initial_cash
+        self.order_frequency = order_frequency
+        self.min_order_size = min_order_size
+        self.max_order_size = max_order_size
+        self.price_volatility = price_volatility
+        self.cross_probability = cross_probability
+        self.step_interval = step_interval
+        self.consumer_id = trader_id_prefix
+        self.rng = np.random.default_rng(seed)
+        self.walk = random.Random(seed)  # Reference-price random walk
+
+        self.trader_ids = [
+            f"{trader_id_prefix}_{i + 1:05d}" for i in range(num_traders)
+        ]
+        self.trader_index = {
+            trader_id: i
+            for i, trader_id in enumerate(self.trader_ids)
+        }
+        self.symbol_index = {
+            symbol: j
+            for j, symbol in enumerate(self.symbols)
+        }
+
+        # Per-trader state (rows are traders, columns are symbols)
+        self.cash = np.full(num_traders, float(initial_cash))
+        self.positions = np.full((num_traders, len(self.symbols)),
+                                 int(initial_position),
+                                 dtype=np.int64)
+        self.initial_positions = self.positions.copy()
+        self.state_lock = threading.Lock()
+        self.market_prices = np.full(len(self.symbols), float(initial_price))
+        self.tick_sizes = np.array(
+            [engine.get_orderbook(symbol).tick_size for symbol in self.symbols])
+
+        # Statistics
+        self.orders_sent = 0
+        self.orders_filled = 0
+        self.total_volume = 0
+        self.steps = 0
+
+        # Threading
+        self.is_active = False
+        self.thread = None
+
+        engine.register_fill_consumer(self.consumer_id, self._on_fill_events,
+                                      self.trader_ids)
+
+    def start(self):
+        """Generate flow on a background thread in real time"""
+        if not self.is_active:
+            self.is_active = True
+            self.thread = threading.Thread(target=self._run,
+                                           name="population-flow",
+                                           daemon=True)
+            self.thread.start()
+
+    def stop(self):
+        """Stop the background thread"""
+        self.is_active = False
+        if self.thread and self.thread.is_alive():
+            self.thread.join(timeout=1.0)
+
+    def _run(self):
+        """Step once per step_interval using the real elapsed time"""
+        last = time.monotonic()
+        while self.is_active:
+            now = time.monotonic()
+            try:
+                self.step(now - last)
+            except Exception as e:
+                print(f"Error in population flow generator: {e}")
+            last = now
+            pause = self.step_interval - (time.monotonic() - now)
+            if pause > 0:
+                time.sleep(pause)
+
+    def _reference_prices(self):
+        """Per-symbol price estimate, as Trader._estimate_market_price"""
+        prices = self.market_prices
+        for j, symbol in enumerate(self.symbols):
+            orderbook = self.engine.get_orderbook(symbol)
+            recent_vwap = orderbook.get_recent_vwap()
+            if recent_vwap is not None:
+                prices[j] = recent_vwap
+                continue
+            mid_price = orderbook.get_mid_price()
+            if mid_price is not None:
+                prices[j] = mid_price
+            else:
+                prices[j] = max(1.0, prices[j] * (1 + self.walk.gauss(0, 0.01)))
+        return prices
+
+    def step(self, elapsed_seconds):
+        """
+        Generate and submit the orders the population sends in a time span
+
+        Each trader sends orders as a Poisson process with mean gap
+        order_frequency, so the whole population's arrivals in the span are
+        Poisson(num_traders * elapsed / order_frequency), each from a
+        uniformly chosen trader.
+
+        Args:
+            elapsed_seconds (float): Length of the simulated span
+
+        Returns:
+            int: Number of orders accepted by the engine
+        """
+        self.steps += 1
+        rng = self.rng
+        count = rng.poisson(self.num_traders * elapsed_seconds /
+                            self.order_frequency)
+        if count == 0:
+            return 0
+
+        traders = rng.integers(0, self.num_traders, count)
+        symbols = rng.integers(0, len(self.symbols), count)
+        with self.state_lock:
+            positions = self.positions[traders, symbols]
+            cash = self.cash[traders]
+
+        # Bias towards selling large positions and buying from flat
+        buy_probability = np.where(positions == 0, 0.7,
+                                   np.where(positions > 500, 0.3, 0.5))
+        is_buy = rng.random(count) < buy_probability
+        quantities = rng.integers(self.min_order_size, self.max_order_size + 1,
+                                  count)
+
+        # Buyers bid below the reference price, sellers ask above it, except
+        # for the crossing share which prices through it
+        variation = np.abs(rng.normal(0.0, self.price_volatility, count))
+        variation = np.where(rng.random(count) < self.cross_probability,
+                             -variation, variation)
+        reference = self._reference_prices()[symbols]
+        prices = np.where(is_buy, reference * (1 - variation),
+                          reference * (1 + variation))
+        ticks = self.tick_sizes[symbols]
+        prices = np.maximum(np.round(prices / ticks), 1) * ticks
+
+        # Buys are capped at what the trader can afford, sells at inventory
+        affordable = np.floor(cash / prices).astype(np.int64)
+        quantities = np.where(is_buy, np.minimum(quantities, affordable),
+                              np.minimum(quantities, positions))
+        valid = quantities >= self.min_order_size
+        if not valid.any():
+            return 0
+
+        trader_ids = self.trader_ids
+        symbol_names = self.symbols
+        create_order = self.engine.create_order
+        orders = [
+            create_order(trader_ids[t], symbol_names[s],
+                         OrderSide.BUY if buy else OrderSide.SELL, q, p)
+            for t, s, buy, q, p in zip(
+                traders[valid].tolist(), symbols[valid].tolist(),
+                is_buy[valid].tolist(), quantities[valid].tolist(),
+                prices[valid].tolist())
+        ]
+        accepted = self.engine.submit_orders(orders)
+        self.orders_sent += accepted
+        return accepted
+
+    def _on_fill_events(self, events):
+        """Apply a batch of fills to the cash and position arrays"""
+        count = len(events)
+        trader_index = self.trader_index
+        symbol_index = self.symbol_index
+        traders = np.fromiter((trader_index[e.trader_id] for e in events),
+                              dtype=np.int64,
+                              count=count)
+        symbols = np.fromiter((symbol_index[e.symbol] for e in events),
+                              dtype=np.int64,
+                              count=count)
+        signed = np.fromiter(
+            (e.quantity if e.side == OrderSide.BUY else -e.quantity
+             for e in events),
+            dtype=np.int64,
+            count=count)
+        prices = np.fromiter((e.price for e in events),
+                             dtype=np.float64,
+                             count=count)
+
+        with self.state_lock:
+            np.add.at(self.cash, traders, -signed * prices)
+            np.add.at(self.positions, (traders, symbols), signed)
+        self.orders_filled += count
+        self.total_volume += int(np.abs(signed).sum())
+
+    def get_marks(self):
+        """Last trade price per symbol (reference price before any trade)"""
+        marks = self.market_prices.copy()
+        last_prices = self.engine.last_prices
+        for j, symbol in enumerate(self.symbols):
+            last_price = last_prices.get(symbol)
+            if last_price is not None:
+                marks[j] = last_price
+        return marks
+
+    def get_pnl(self):
+        """Per-trader P&L against starting cash and inventory, marked to market"""
+        marks = self.get_marks()
+        with self.state_lock:
+            return (self.cash - self.initial_cash +
+                    (self.positions - self.initial_positions) @ marks)
+
+    def get_total_pnl(self):
+        """Combined P&L of the population"""
+        return float(self.get_pnl().sum())
+
+    def get_statistics(self):
+        """Get population-level counters"""
+        with self.state_lock:
+            total_cash = float(self.cash.sum())
+            gross_position = int(np.abs(self.positions).sum())
+        return {
+            'num_traders': self.num_traders,
+            'orders_sent': self.orders_sent,
+            'orders_filled': self.orders_filled,
+            'total_volume': self.total_volume,
+            'total_cash': total_cash,
+            'gross_position': gross_position,
+            'total_pnl': self.get_total_pnl(),
+            'steps': self.steps
+        }
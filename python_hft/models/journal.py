@@ -0,0 +1,535 @@
+"""
+Append-only binary journal of engine events
+
+Every accepted order, cancel, in-place amend and trade is written as one
+fixed-size little-endian record, so a session can be captured at matching
+rates (producers only append a tuple; a background thread packs and
+writes) and read back by memory-mapping the files, with no text parsing.
+
+File layout: a HEADER_SIZE header (magic, version, record size, first
+sequence), then RECORD_SIZE records. Symbol and trader names are interned
+to integer IDs by name records written before their first use and repeated
+at the top of every rotated file, so each file can be read on its own.
+"""
+import itertools
+import mmap
+import os
+import struct
+import threading
+from collections import deque, namedtuple
+
+from models.order import OrderSide, OrderStatus
+
+JOURNAL_MAGIC = b'HFTJ'
+JOURNAL_VERSION = 1
+HEADER_SIZE = 64
+RECORD_SIZE = 64
+
+# Record types
+RECORD_SYMBOL = 1  # Name record: symbol ID -> symbol, tick size
+RECORD_TRADER = 2  # Name record: trader ID -> trader_id
+RECORD_ACCEPT = 3  # Order taken off the ingress ring, before matching
+RECORD_CANCEL = 4  # Resting order removed (aux2 = CANCEL_REQUEUED on amend)
+RECORD_AMEND = 5  # Resting order reduced in place (quantity = new size)
+RECORD_TRADE = 6  # Trade (order_id = buy order, aux1 = sell order)
+RECORD_STORED_TRADE = 7  # Trade in a trade-store segment (models.trade_store)
+
+NAME_RECORDS = (RECORD_SYMBOL, RECORD_TRADER)
+
+# aux2 of a CANCEL written when amend_order re-queues the order; the order
+# is journalled again as an ACCEPT when it is re-processed
+CANCEL_REQUEUED = 1
+
+SIDE_BUY = 0
+SIDE_SELL = 1
+
+# type, side, reserved, symbol_id, sequence, timestamp_ns, order_id,
+# quantity, price_ticks, aux1, aux2
+#   ACCEPT/CANCEL/AMEND: aux1 = trader ID
+#   ACCEPT: aux2 = quantity already filled (an order re-queued by amend)
+#   TRADE: side = aggressor side, aux1 = sell order, aux2 = trade sequence
+#   STORED_TRADE: as TRADE, but sequence = trade sequence and
+#     aux2 = buyer ID << 32 | seller ID (trader name records)
+EVENT_RECORD = struct.Struct('<BBHIqqqqqqq')
+
+# type, reserved, reserved, name_id, sequence, tick_size, utf-8 name
+NAME_RECORD = struct.Struct('<BBHIqd40s')
+
+HEADER = struct.Struct('<4sHHq')
+
+# Default size at which the writer starts a new file
+DEFAULT_MAX_FILE_BYTES = 64 * 1024 * 1024
+
+JournalRecord = namedtuple('JournalRecord', [
+    'type', 'side', 'reserved', 'symbol_id', 'sequence', 'timestamp_ns',
+    'order_id', 'quantity', 'price_ticks', 'aux1', 'aux2'
+])
+
+assert EVENT_RECORD.size == RECORD_SIZE and NAME_RECORD.size == RECORD_SIZE
+
+
+def journal_files(directory):
+    """Get a directory's journal files in sequence order"""
+    if not os.path.isdir(directory):
+        return []
+    return sorted(
+        os.path.join(directory, name) for name in os.listdir(directory)
+        if name.startswith('journal-') and name.endswith('.bin'))
+
+
+class Journal:
+    """
+    Writer for the binary journal
+
+    Matching threads call the record_* methods, which assign the next
+    sequence number and queue a ready-to-pack tuple; the writer thread (or
+    flush()) packs queued records into a buffer and writes them out,
+    starting a new file once the current one reaches max_file_bytes.
+    """
+
+    # How long the writer waits between flushes
+    FLUSH_INTERVAL_SECONDS = 0.05
+
+    def __init__(self, directory, max_file_bytes=DEFAULT_MAX_FILE_BYTES,
+                 fsync=False):
+        """
+        Initialize the journal
+
+        Args:
+            directory (str): Directory for journal files (created if needed);
+                an existing journal there is continued after its last record
+            max_file_bytes (int): Size at which a new file is started
+            fsync (bool): fsync files at each flush, not just on rotation
+                and close
+        """
+        os.makedirs(directory, exist_ok=True)
+        self.directory = directory
+        self.max_file_bytes = max(max_file_bytes, HEADER_SIZE + RECORD_SIZE)
+        self.fsync = fsync
+
+        # Producer side: sequence assignment and interning share one lock so
+        # queued order matches sequence order
+        self.lock = threading.Lock()
+        self.pending = deque()
+        self.symbol_ids = {}  # symbol -> ID
+        self.trader_ids = {}  # trader_id -> ID
+
+        # Writer side
+        self.write_lock = threading.Lock()
+        self.file = None
+        self.file_bytes = 0
+        self.name_records = []  # Packed name records, repeated per file
+        self.records_written = 0
+        self.bytes_written = 0
+        self.files_written = 0
+
+        self.last_sequence = self._resume()
+        self.sequence = itertools.count(self.last_sequence + 1)
+
+        # Threading
+        self.is_running = False
+        self.thread = None
+        self.wakeup = threading.Event()
+
+    def _resume(self):
+        """Re-intern names from an existing journal and get its last sequence"""
+        files = journal_files(self.directory)
+        if not files:
+            return 0
+        reader = JournalReader(self.directory)
+        for symbol_id, (symbol, tick_size) in reader.symbols.items():
+            self.symbol_ids[symbol] = symbol_id
+            self.name_records.append(
+                NAME_RECORD.pack(RECORD_SYMBOL, 0, 0, symbol_id, 0, tick_size,
+                                 symbol.encode()))
+        for trader_id, name in reader.traders.items():
+            self.trader_ids[name] = trader_id
+            self.name_records.append(
+                NAME_RECORD.pack(RECORD_TRADER, 0, 0, trader_id, 0, 0.0,
+                                 name.encode()))
+        return reader.last_sequence
+
+    def _intern(self, ids, record_type, name, tick_size):
+        """Get a name's ID, queueing its name record first (lock held)"""
+        name_id = ids[name] = len(ids) + 1
+        encoded = name.encode()
+        if len(encoded) > 40:
+            raise ValueError(f"Name too long for the journal: {name}")
+        self.pending.append((record_type, 0, 0, name_id, next(self.sequence),
+                             tick_size, encoded))
+        return name_id
+
+    def _append(self, record_type, side, orderbook, timestamp_ns, order_id,
+                quantity, price_ticks, trader_id, aux1, aux2):
+        with self.lock:
+            symbol_id = self.symbol_ids.get(orderbook.symbol)
+            if symbol_id is None:
+                symbol_id = self._intern(self.symbol_ids, RECORD_SYMBOL,
+                                         orderbook.symbol, orderbook.tick_size)
+            if trader_id is not None:
+                aux1 = self.trader_ids.get(trader_id)
+                if aux1 is None:
+                    aux1 = self._intern(self.trader_ids, RECORD_TRADER,
+                                        trader_id, 0.0)
+            sequence = next(self.sequence)
+            self.pending.append(
+                (record_type, side, 0, symbol_id, sequence, timestamp_ns,
+                 order_id, quantity, price_ticks, aux1, aux2))
+            self.last_sequence = sequence
+        return sequence
+
+    def record_accept(self, order, orderbook, timestamp_ns):
+        """Journal an order taken for matching (price_ticks already assigned)"""
+        return self._append(RECORD_ACCEPT,
+                            SIDE_BUY if order.side is OrderSide.BUY else SIDE_SELL,
+                            orderbook, timestamp_ns, order.order_id,
+                            order.quantity, order.price_ticks, order.trader_id,
+                            0, order.filled_quantity)
+
+    def record_cancel(self, order, orderbook, timestamp_ns, requeued=False):
+        """Journal a resting order leaving the book without a fill"""
+        return self._append(RECORD_CANCEL,
+                            SIDE_BUY if order.side is OrderSide.BUY else SIDE_SELL,
+                            orderbook, timestamp_ns, order.order_id,
+                            order.quantity, order.price_ticks, order.trader_id,
+                            0, CANCEL_REQUEUED if requeued else 0)
+
+    def record_amend(self, order, orderbook, timestamp_ns):
+        """Journal an in-place size-down (order.quantity is the new size)"""
+        return self._append(RECORD_AMEND,
+                            SIDE_BUY if order.side is OrderSide.BUY else SIDE_SELL,
+                            orderbook, timestamp_ns, order.order_id,
+                            order.quantity, order.price_ticks, order.trader_id,
+                            0, 0)
+
+    def record_trade(self, orderbook, timestamp_ns, sequence, side, quantity,
+                     price_ticks, buy_order_id, sell_order_id):
+        """Journal a trade (side is the aggressor's, 0 BUY or 1 SELL)"""
+        return self._append(RECORD_TRADE,
+                            SIDE_BUY if side == 0 else SIDE_SELL,
+                            orderbook, timestamp_ns, buy_order_id, quantity,
+                            price_ticks, None, sell_order_id, sequence)
+
+    def start(self):
+        """Start the background writer thread"""
+        if not self.is_running:
+            self.is_running = True
+            self.thread = threading.Thread(target=self._writer_loop,
+                                           name="journal-writer",
+                                           daemon=True)
+            self.thread.start()
+
+    def stop(self):
+        """Write everything queued, stop the writer thread and close the file"""
+        self.is_running = False
+        self.wakeup.set()
+        if self.thread and self.thread.is_alive():
+            self.thread.join(timeout=2.0)
+        self.close()
+
+    def close(self):
+        """Flush and close the current file (the next write starts a new one)"""
+        with self.write_lock:
+            self._write_pending()
+            self._close_file()
+
+    def _writer_loop(self):
+        while self.is_running:
+            self.wakeup.wait(self.FLUSH_INTERVAL_SECONDS)
+            self.wakeup.clear()
+            try:
+                self.flush()
+            except Exception as e:
+                print(f"Error writing journal: {e}")
+        self.flush()
+
+    def flush(self):
+        """
+        Write every queued record
+
+        Returns:
+            int: Number of records written
+        """
+        with self.write_lock:
+            return self._write_pending()
+
+    def _write_pending(self):
+        """Pack queued records in file-sized runs and write them (write_lock held)"""
+        pending = self.pending
+        written = 0
+        while pending:
+            if self.file is None or self.file_bytes + RECORD_SIZE > self.max_file_bytes:
+                self._open_file(pending[0][4])
+
+            # Records that still fit in this file, capped so a burst is
+            # written in bounded chunks
+            count = min(len(pending),
+                        max(1, (self.max_file_bytes - self.file_bytes) // RECORD_SIZE),
+                        65536)
+            buffer = bytearray(count * RECORD_SIZE)
+            offset = 0
+            for _ in range(count):
+                record = pending.popleft()
+                if record[0] in NAME_RECORDS:
+                    NAME_RECORD.pack_into(buffer, offset, *record)
+                    self.name_records.append(bytes(buffer[offset:offset + RECORD_SIZE]))
+                else:
+                    EVENT_RECORD.pack_into(buffer, offset, *record)
+                offset += RECORD_SIZE
+            self.file.write(buffer)
+            self.file_bytes += len(buffer)
+            self.bytes_written += len(buffer)
+            written += count
+
+        if written:
+            self.file.flush()
+            if self.fsync:
+                os.fsync(self.file.fileno())
+            self.records_written += written
+        return written
+
+    def _open_file(self, first_sequence):
+        """Start a new file whose first record has first_sequence"""
+        self._close_file()
+        path = os.path.join(self.directory, f"journal-{first_sequence:020d}.bin")
+        self.file = open(path, 'wb')
+        header = bytearray(HEADER_SIZE)
+        HEADER.pack_into(header, 0, JOURNAL_MAGIC, JOURNAL_VERSION,
+                         RECORD_SIZE, first_sequence)
+        self.file.write(header)
+        for record in self.name_records:
+            self.file.write(record)
+        self.file_bytes = HEADER_SIZE + RECORD_SIZE * len(self.name_records)
+        self.bytes_written += self.file_bytes
+        self.files_written += 1
+
+    def _close_file(self):
+        if self.file is not None:
+            self.file.flush()
+            os.fsync(self.file.fileno())
+            self.file.close()
+            self.file = None
+
+    def get_statistics(self):
+        """Get writer counters"""
+        return {
+            'directory': self.directory,
+            'last_sequence': self.last_sequence,
+            'pending': len(self.pending),
+            'records_written': self.records_written,
+            'bytes_written': self.bytes_written,
+            'files_written': self.files_written
+        }
+
+
+class JournalReader:
+    """
+    Memory-mapped reader for a journal directory
+
+    Files are mapped read-only; records() decodes one struct per record and
+    to_array() exposes a file's records as a numpy structured array over
+    the mapping, so analysis can filter and aggregate columns directly.
+    """
+
+    def __init__(self, directory):
+        """
+        Open a journal directory and load its names
+
+        Args:
+            directory (str): Directory written by a Journal
+        """
+        self.directory = directory
+        self.files = journal_files(directory)
+        self.symbols = {}  # symbol ID -> (symbol, tick size)
+        self.traders = {}  # trader ID -> trader_id
+        self.last_sequence = 0
+
+        for path in self.files:
+            for record in self._file_records(path, names=True):
+                if record[0] == RECORD_SYMBOL:
+                    self.symbols[record[3]] = (record[6].rstrip(b'\0').decode(),
+                                               record[5])
+                elif record[0] == RECORD_TRADER:
+                    self.traders[record[3]] = record[6].rstrip(b'\0').decode()
+                elif record[4] > self.last_sequence:
+                    self.last_sequence = record[4]
+
+    @staticmethod
+    def _map(path):
+        """Map a file and check its header; returns (mmap, record count) or None"""
+        with open(path, 'rb') as f:
+            size = os.fstat(f.fileno()).st_size
+            if size < HEADER_SIZE:
+                return None
+            mapped = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, version, record_size, _ = HEADER.unpack_from(mapped, 0)
+        if magic != JOURNAL_MAGIC or version != JOURNAL_VERSION or record_size != RECORD_SIZE:
+            mapped.close()
+            raise ValueError(f"Not a journal file (or unsupported version): {path}")
+        # A record torn by a crash mid-write is ignored
+        return mapped, (size - HEADER_SIZE) // RECORD_SIZE
+
+    def _file_records(self, path, names=False):
+        """Yield a file's records as raw tuples (name records only if names)"""
+        mapped = self._map(path)
+        if mapped is None:
+            return
+        mapped, count = mapped
+        try:
+            offset = HEADER_SIZE
+            for _ in range(count):
+                record_type = mapped[offset]
+                if record_type in NAME_RECORDS:
+                    if names:
+                        yield NAME_RECORD.unpack_from(mapped, offset)
+                else:
+                    yield EVENT_RECORD.unpack_from(mapped, offset)
+                offset += RECORD_SIZE
+        finally:
+            mapped.close()
+
+    def records(self, after_sequence=0, record_types=None):
+        """
+        Iterate event records in sequence order
+
+        Args:
+            after_sequence (int): Only records with a larger sequence
+            record_types (tuple): Only these record types (default: all)
+
+        Yields:
+            JournalRecord
+        """
+        for index, path in enumerate(self.files):
+            # Skip whole files that end before after_sequence
+            if index + 1 < len(self.files) and self._first_sequence(
+                    self.files[index + 1]) <= after_sequence + 1:
+                continue
+            for record in self._file_records(path):
+                if record[4] <= after_sequence:
+                    continue
+                if record_types is None or record[0] in record_types:
+                    yield JournalRecord._make(record)
+
+    @staticmethod
+    def _first_sequence(path):
+        """Get a file's first sequence from its name"""
+        return int(os.path.basename(path)[len('journal-'):-len('.bin')])
+
+    def symbol_name(self, symbol_id):
+        """Get the symbol for a record's symbol_id"""
+        return self.symbols[symbol_id][0]
+
+    def trader_name(self, trader_id):
+        """Get the trader_id for a record's aux1 (order records)"""
+        return self.traders[trader_id]
+
+    def to_array(self, path):
+        """
+        View one journal file's records as a numpy structured array
+
+        The array is a copy-free view over the mapped file; name records
+        appear with type RECORD_SYMBOL/RECORD_TRADER and should be filtered
+        out by type.
+
+        Args:
+            path (str): One of self.files
+
+        Returns:
+            numpy.ndarray: Records with JournalRecord field names
+        """
+        import numpy as np
+
+        dtype = np.dtype([('type', 'u1'), ('side', 'u1'), ('reserved', '<u2'),
+                          ('symbol_id', '<u4'), ('sequence', '<i8'),
+                          ('timestamp_ns', '<i8'), ('order_id', '<i8'),
+                          ('quantity', '<i8'), ('price_ticks', '<i8'),
+                          ('aux1', '<i8'), ('aux2', '<i8')])
+        mapped = self._map(path)
+        if mapped is None:
+            return np.zeros(0, dtype=dtype)
+        mapped, count = mapped
+        return np.frombuffer(mapped, dtype=dtype, count=count,
+                             offset=HEADER_SIZE)
+
+    def replay(self, engine, after_sequence=0, symbol_sequences=None):
+        """
+        Re-drive a stopped engine from the journal
+
+        Accepted orders are resubmitted with their original IDs and the
+        engine re-matches them, so trades are regenerated rather than
+        copied; cancels and amends are applied once everything accepted
+        before them has been matched. Trade records are only counted.
+
+        Args:
+            engine: Stopped TradingEngine (its journal, if any, records the
+                replayed session)
+            after_sequence (int): Skip records up to this sequence (see
+                models.snapshot for snapshot + tail recovery)
+            symbol_sequences (dict): Optional symbol -> sequence; records for
+                that symbol are skipped up to its own (later) sequence
+
+        Returns:
+            dict: Replayed record counts and the last sequence applied
+        """
+        if engine.is_running:
+            raise RuntimeError("replay requires a stopped engine")
+
+        counts = {'accepted': 0, 'cancelled': 0, 'amended': 0,
+                  'journal_trades': 0, 'last_sequence': after_sequence}
+        pending = []
+        # Match well before a shard ring fills, so replay never relies on
+        # the rings blocking
+        max_pending = max(1, min(shard.order_queue.capacity
+                                 for shard in engine.shards) // 2)
+        max_order_id = 0
+        skip_until = {
+            symbol_id: symbol_sequences[symbol]
+            for symbol_id, (symbol, _) in self.symbols.items()
+            if symbol in (symbol_sequences or {})
+        }
+
+        def drain():
+            if pending:
+                engine.submit_orders(pending)
+                pending.clear()
+            engine.run_until_idle()
+
+        for record in self.records(after_sequence):
+            if record.sequence <= skip_until.get(record.symbol_id, 0):
+                continue
+            record_type = record.type
+            if record_type == RECORD_ACCEPT:
+                symbol, tick_size = self.symbols[record.symbol_id]
+                order = engine.create_order(
+                    self.traders[record.aux1], symbol,
+                    OrderSide.BUY if record.side == SIDE_BUY else OrderSide.SELL,
+                    record.quantity, record.price_ticks * tick_size)
+                order.order_id = record.order_id
+                if record.aux2:
+                    order.filled_quantity = record.aux2
+                    order.original_quantity = record.aux2 + record.quantity
+                    order.status = OrderStatus.PARTIALLY_FILLED
+                pending.append(order)
+                if len(pending) >= max_pending:
+                    drain()
+                max_order_id = max(max_order_id, record.order_id)
+                counts['accepted'] += 1
+            elif record_type == RECORD_CANCEL:
+                drain()
+                engine.cancel_order(record.order_id)
+                if record.aux2 != CANCEL_REQUEUED:  # Else its re-accept follows
+                    counts['cancelled'] += 1
+            elif record_type == RECORD_AMEND:
+                drain()
+                engine.amend_order(record.order_id, quantity=record.quantity)
+                counts['amended'] += 1
+            elif record_type == RECORD_TRADE:
+                counts['journal_trades'] += 1
+            counts['last_sequence'] = record.sequence
+        drain()
+
+        # New orders continue after the replayed IDs
+        next_id = next(engine.order_ids)
+        engine.order_ids = itertools.count(max(next_id, max_order_id + 1))
+        return counts
+
@@ -0,0 +1,169 @@
+"""
+Log-bucketed latency histograms
+
+Values are recorded in integer nanoseconds into HDR-style buckets: every
+power-of-two range is split into 2**SUB_BUCKET_BITS linear sub-buckets, so
+the relative error of any reported percentile is bounded (~3%) while a
+record is just a bit_length, a shift and a list increment.
+"""
+
+# Linear sub-buckets per power of two (2**5 = 32 -> ~3% resolution)
+SUB_BUCKET_BITS = 5
+
+# Largest value tracked exactly (2**40 ns is ~18 minutes); larger values are
+# clamped into the top bucket
+MAX_VALUE_BITS = 40
+
+# Pipeline stages timed for every order, in order
+#   queue:    submit -> dequeued by the matching thread
+#   dispatch: dequeued -> matching started
+#   match:    matching started -> matching finished
+#   notify:   matching finished -> fill events published to traders
+#   total:    submit -> fill events published to traders
+STAGES = ('queue', 'dispatch', 'match', 'notify', 'total')
+
+_SUB_BUCKETS = 1 << SUB_BUCKET_BITS
+_BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS
+_MAX_VALUE = (1 << MAX_VALUE_BITS) - 1
+
+
+def bucket_index(value):
+    """Map a non-negative value to its bucket"""
+    shift = value.bit_length() - SUB_BUCKET_BITS - 1
+    if shift <= 0:
+        return value
+    return (shift << SUB_BUCKET_BITS) + (value >> shift)
+
+
+def bucket_bounds(index):
+    """Get the (lowest, highest) value that maps to a bucket"""
+    if index < 2 * _SUB_BUCKETS:
+        return index, index
+    shift = (index >> SUB_BUCKET_BITS) - 1
+    mantissa = index - (shift << SUB_BUCKET_BITS)
+    return mantissa << shift, ((mantissa + 1) << shift) - 1
+
+
+class LatencyHistogram:
+    """
+    Fixed-size histogram of nanosecond latencies
+
+    Written by one thread; readers may see a record half-applied (count
+    bumped before the bucket, say), which only nudges percentiles.
+    """
+
+    __slots__ = ('counts', 'count', 'total', 'min_value', 'max_value')
+
+    def __init__(self):
+        """Initialize an empty histogram"""
+        self.counts = [0] * _BUCKET_COUNT
+        self.count = 0
+        self.total = 0
+        self.min_value = None
+        self.max_value = 0
+
+    def record(self, value_ns):
+        """Record one latency in nanoseconds"""
+        if value_ns < 0:
+            value_ns = 0
+        elif value_ns > _MAX_VALUE:
+            value_ns = _MAX_VALUE
+        self.counts[bucket_index(value_ns)] += 1
+        self.count += 1
+        self.total += value_ns
+        if value_ns > self.max_value:
+            self.max_value = value_ns
+        if self.min_value is None or value_ns < self.min_value:
+            self.min_value = value_ns
+
+    def merge(self, other):
+        """Add another histogram's samples into this one"""
+        counts = self.counts
+        for index, bucket_count in enumerate(other.counts):
+            if bucket_count:
+                counts[index] += bucket_count
+        self.count += other.count
+        self.total += other.total
+        if other.max_value > self.max_value:
+            self.max_value = other.max_value
+        if other.min_value is not None and (self.min_value is None or
+                                            other.min_value < self.min_value):
+            self.min_value = other.min_value
+
+    def copy(self):
+        """Get an independent copy (for aggregation off the writer thread)"""
+        clone = LatencyHistogram()
+        clone.merge(self)
+        return clone
+
+    def percentile(self, percent):
+        """
+        Get the value at a percentile
+
+        Args:
+            percent (float): Percentile in [0, 100]
+
+        Returns:
+            int: Upper bound of the bucket holding that rank, in ns (0 if empty)
+        """
+        count = self.count
+        if count == 0:
+            return 0
+        rank = max(1, int(count * percent / 100.0 + 0.5))
+        seen = 0
+        for index, bucket_count in enumerate(self.counts):
+            if bucket_count:
+                seen += bucket_count
+                if seen >= rank:
+                    return min(bucket_bounds(index)[1], self.max_value)
+        return self.max_value
+
+    def mean(self):
+        """Get the mean latency in ns"""
+        return self.total / self.count if self.count else 0
+
+    def summary(self):
+        """Get count, mean, p50/p99/p99.9 and max in microseconds"""
+        return {
+            'count': self.count,
+            'mean_us': self.mean() / 1e3,
+            'p50_us': self.percentile(50) / 1e3,
+            'p99_us': self.percentile(99) / 1e3,
+            'p999_us': self.percentile(99.9) / 1e3,
+            'max_us': self.max_value / 1e3
+        }
+
+
+class StageHistograms:
+    """One histogram per pipeline stage for a symbol"""
+
+    __slots__ = STAGES
+
+    def __init__(self):
+        """Initialize empty histograms for every stage"""
+        for stage in STAGES:
+            setattr(self, stage, LatencyHistogram())
+
+    def record(self, submit_ns, dequeue_ns, match_start_ns, match_end_ns,
+               notify_end_ns):
+        """Record one order's stage timestamps (monotonic ns)"""
+        self.queue.record(dequeue_ns - submit_ns)
+        self.dispatch.record(match_start_ns - dequeue_ns)
+        self.match.record(match_end_ns - match_start_ns)
+        self.notify.record(notify_end_ns - match_end_ns)
+        self.total.record(notify_end_ns - submit_ns)
+
+    def merge(self, other):
+        """Add another symbol's (or shard's) stages into this one"""
+        for stage in STAGES:
+            getattr(self, stage).merge(getattr(other, stage))
+
+    def copy(self):
+        """Get an independent copy of every stage"""
+        clone = StageHistograms()
+        clone.merge(self)
+        return clone
+
+    def summary(self):
+        """Get per-stage summaries"""
+        return {stage: getattr(self, stage).summary() for stage in STAGES}
@@ -0,0 +1,90 @@
+"""
+Lock acquisition and contention counters
+
+CountingLock is a drop-in threading.Lock that counts acquisitions and, for
+those that found the lock held, the time spent waiting. An uncontended
+acquire is one non-blocking try, so it never reads the clock. Counters are
+updated while the lock is held, so they need no lock of their own.
+"""
+import threading
+import time
+
+
+class CountingLock:
+    """threading.Lock with acquisition and wait-time counters"""
+
+    __slots__ = ('name', '_lock', 'acquisitions', 'contended', 'wait_ns',
+                 'max_wait_ns')
+
+    def __init__(self, name=None):
+        """
+        Initialize the lock
+
+        Args:
+            name (str): Label used in statistics
+        """
+        self.name = name
+        self._lock = threading.Lock()
+        self.acquisitions = 0
+        self.contended = 0  # Acquisitions that had to wait
+        self.wait_ns = 0  # Total time spent waiting
+        self.max_wait_ns = 0
+
+    def acquire(self, blocking=True, timeout=-1):
+        """Acquire the lock (same arguments as threading.Lock.acquire)"""
+        lock = self._lock
+        if lock.acquire(False):
+            self.acquisitions += 1
+            return True
+        if not blocking:
+            return False
+        start_ns = time.perf_counter_ns()
+        if not lock.acquire(True, timeout):
+            return False
+        waited_ns = time.perf_counter_ns() - start_ns
+        self.acquisitions += 1
+        self.contended += 1
+        self.wait_ns += waited_ns
+        if waited_ns > self.max_wait_ns:
+            self.max_wait_ns = waited_ns
+        return True
+
+    __enter__ = acquire
+
+    def release(self):
+        """Release the lock"""
+        self._lock.release()
+
+    def __exit__(self, *exc_info):
+        self._lock.release()
+
+    def locked(self):
+        """Check whether the lock is held"""
+        return self._lock.locked()
+
+    def get_statistics(self):
+        """Get acquisition and wait counters"""
+        return lock_statistics([self])
+
+
+def lock_statistics(locks):
+    """
+    Combine the counters of several locks (e.g. one per shard)
+
+    Args:
+        locks (list): CountingLock instances
+
+    Returns:
+        dict: Acquisitions, contended share and wait times in microseconds
+    """
+    acquisitions = sum(lock.acquisitions for lock in locks)
+    contended = sum(lock.contended for lock in locks)
+    wait_ns = sum(lock.wait_ns for lock in locks)
+    return {
+        'acquisitions': acquisitions,
+        'contended': contended,
+        'contended_rate': contended / max(1, acquisitions),
+        'wait_us': wait_ns / 1e3,
+        'mean_wait_us': wait_ns / max(1, contended) / 1e3,
+        'max_wait_us': max((lock.max_wait_ns for lock in locks), default=0) / 1e3
+    }
@@ -0,0 +1,436 @@
+"""
+Incremental L2 market data
+
+Rather than polling full book snapshots, a subscriber takes one snapshot
+per symbol when it subscribes and then applies updates: a LevelDelta for
+every change in a price level's aggregate quantity or order count, and a
+TradePrint for every trade. Each update carries its symbol's next sequence
+number, so a snapshot plus every later update rebuilds the book exactly
+and a gap (updates dropped on queue overflow) is detected.
+
+Matching shards note the levels an order touched and, before releasing
+their orders_lock, compare those levels with the feed's copy of the
+published book; only changed levels produce deltas, so a level that was
+emptied and refilled within one batch publishes its net change. While no
+one is subscribed the shards track nothing.
+"""
+import threading
+from contextlib import ExitStack, contextmanager
+
+BID = 'BID'
+ASK = 'ASK'
+
+_EMPTY_LEVEL = (0, 0)
+
+
+class LevelDelta:
+    """New aggregate of one price level (quantity 0 removes the level)"""
+
+    __slots__ = ('sequence', 'symbol', 'side', 'price_ticks', 'price',
+                 'quantity', 'order_count', 'timestamp_ns')
+
+    def __init__(self, sequence, symbol, side, price_ticks, price, quantity,
+                 order_count, timestamp_ns):
+        """
+        Initialize a level delta
+
+        Args:
+            sequence (int): Symbol's market data sequence number
+            symbol (str): Trading symbol
+            side (str): BID or ASK
+            price_ticks (int): Level price in ticks
+            price (float): Level price
+            quantity (int): New total resting quantity at the level
+            order_count (int): New number of orders at the level
+            timestamp_ns (int): Wall-clock ns when the delta was published
+        """
+        self.sequence = sequence
+        self.symbol = symbol
+        self.side = side
+        self.price_ticks = price_ticks
+        self.price = price
+        self.quantity = quantity
+        self.order_count = order_count
+        self.timestamp_ns = timestamp_ns
+
+
+class TradePrint:
+    """One trade on the market data feed"""
+
+    __slots__ = ('sequence', 'symbol', 'price_ticks', 'price', 'quantity',
+                 'aggressor', 'trade_sequence', 'timestamp_ns')
+
+    def __init__(self, sequence, trade, timestamp_ns):
+        """
+        Initialize a trade print
+
+        Args:
+            sequence (int): Symbol's market data sequence number
+            trade (dict): Trade record (as built by MatchingShard._execute_trade)
+            timestamp_ns (int): Wall-clock ns when the trade executed
+        """
+        self.sequence = sequence
+        self.symbol = trade['symbol']
+        self.price_ticks = trade['price_ticks']
+        self.price = trade['price']
+        self.quantity = trade['quantity']
+        self.aggressor = trade['side']
+        self.trade_sequence = trade['sequence']
+        self.timestamp_ns = timestamp_ns
+
+
+class SymbolLevels:
+    """The feed's copy of one symbol's book as last published"""
+
+    __slots__ = ('symbol', 'ticks_to_price', 'sequence', 'bids', 'asks')
+
+    def __init__(self, orderbook):
+        self.symbol = orderbook.symbol
+        self.ticks_to_price = orderbook.ticks_to_price
+        self.sequence = 0
+        self.bids = {}  # tick -> (quantity, order_count)
+        self.asks = {}
+
+    def load(self, orderbook):
+        """Copy every level of the book (its shard's orders_lock held)"""
+        for levels, side in ((self.bids, orderbook.bids),
+                             (self.asks, orderbook.asks)):
+            levels.clear()
+            for level in side.get_top_levels(max(1, side.get_level_count()),
+                                             include_orders=False):
+                levels[level['price_ticks']] = (level['quantity'],
+                                                level['order_count'])
+
+    def snapshot(self):
+        """Get the levels best first with the sequence they reflect"""
+        ticks_to_price = self.ticks_to_price
+        return {
+            'symbol': self.symbol,
+            'sequence': self.sequence,
+            'bids': [(tick, ticks_to_price(tick), quantity, count)
+                     for tick, (quantity, count) in sorted(self.bids.items(),
+                                                           reverse=True)],
+            'asks': [(tick, ticks_to_price(tick), quantity, count)
+                     for tick, (quantity, count) in sorted(self.asks.items())]
+        }
+
+
+def empty_snapshot(symbol):
+    """Snapshot of a symbol that has published nothing yet"""
+    return {'symbol': symbol, 'sequence': 0, 'bids': [], 'asks': []}
+
+
+class MarketDataFeed:
+    """
+    Publishes L2 deltas and trade prints to subscribers
+
+    Updates are delivered through the engine's EventDispatcher, one
+    MarketDataEvent per update, off the matching threads.
+    """
+
+    def __init__(self, engine):
+        """
+        Initialize the feed
+
+        Args:
+            engine: Owning TradingEngine
+        """
+        self.engine = engine
+        self.active = False  # Shards track touched levels while True
+        self.levels = {}  # symbol -> SymbolLevels
+        self.subscribers = {}  # consumer_id -> (EventQueue, symbols or None)
+        self.deltas_published = 0
+        self.prints_published = 0
+
+    @contextmanager
+    def _matching_paused(self):
+        """Hold every shard's orders_lock (always taken in shard order)"""
+        with ExitStack() as stack:
+            for shard in self.engine.shards:
+                stack.enter_context(shard.orders_lock)
+            yield
+
+    def subscribe(self, consumer_id, callback, symbols=None):
+        """
+        Register a subscriber and snapshot the books it follows
+
+        Matching pauses while the snapshots are taken (and, for the first
+        subscriber, while the feed copies every book), so the snapshots
+        and the first update delivered afterwards line up exactly.
+
+        Args:
+            consumer_id: Key for the subscriber's queue
+            callback (callable): Called with a list of MarketDataEvent per batch
+            symbols (iterable): Symbols to follow (None follows every symbol,
+                including ones created later)
+
+        Returns:
+            dict: symbol -> snapshot ('symbol', 'sequence', and 'bids'/'asks'
+                as (price_ticks, price, quantity, order_count) best first)
+        """
+        symbols = frozenset(symbols) if symbols is not None else None
+        engine = self.engine
+        with self._matching_paused():
+            if not self.active:
+                for symbol, orderbook in list(engine.orderbooks.items()):
+                    levels = self.levels.get(symbol)
+                    if levels is None:
+                        levels = self.levels[symbol] = SymbolLevels(orderbook)
+                    levels.load(orderbook)
+                self.active = True
+
+            queue = engine.events.subscribe_market_data(consumer_id, callback)
+            self.subscribers[consumer_id] = (queue, symbols)
+
+            wanted = self.levels.keys() if symbols is None else symbols
+            return {
+                symbol: (self.levels[symbol].snapshot()
+                         if symbol in self.levels else empty_snapshot(symbol))
+                for symbol in wanted
+            }
+
+    def unsubscribe(self, consumer_id):
+        """Stop delivering to a subscriber (the last one stops tracking)"""
+        with self._matching_paused():
+            if self.subscribers.pop(consumer_id, None) is None:
+                return
+            self.engine.events.unsubscribe_market_data(consumer_id)
+            if not self.subscribers:
+                # Sequences continue; levels are recopied on resubscribe
+                self.active = False
+                for levels in self.levels.values():
+                    levels.bids.clear()
+                    levels.asks.clear()
+
+    def _levels_for(self, orderbook):
+        levels = self.levels.get(orderbook.symbol)
+        if levels is None:
+            # A book created while the feed was active starts empty
+            levels = self.levels[orderbook.symbol] = SymbolLevels(orderbook)
+        return levels
+
+    def publish(self, touched, prints, timestamp_ns):
+        """
+        Publish what one shard's processing changed (its orders_lock held)
+
+        Per symbol, the trade prints come first, then the deltas of the
+        levels whose aggregate changed.
+
+        Args:
+            touched (dict): orderbook -> (bid ticks, ask ticks) sets
+            prints (list): (trade record, trade time ns) in execution order
+            timestamp_ns (int): Wall-clock ns for the deltas
+        """
+        updates = {}  # symbol -> updates in sequence order
+        orderbooks = self.engine.orderbooks
+        for trade, trade_time_ns in prints:
+            levels = self._levels_for(orderbooks[trade['symbol']])
+            levels.sequence += 1
+            updates.setdefault(levels.symbol, []).append(
+                TradePrint(levels.sequence, trade, trade_time_ns))
+        self.prints_published += len(prints)
+
+        deltas = 0
+        for orderbook, (bid_ticks, ask_ticks) in touched.items():
+            levels = self._levels_for(orderbook)
+            symbol = levels.symbol
+            symbol_updates = updates.setdefault(symbol, [])
+            for side, ticks, book_side, published in (
+                    (BID, bid_ticks, orderbook.bids, levels.bids),
+                    (ASK, ask_ticks, orderbook.asks, levels.asks)):
+                if not ticks:
+                    continue
+                ticks = sorted(ticks)
+                for tick, totals in zip(ticks, book_side.get_levels_at(ticks)):
+                    if published.get(tick, _EMPTY_LEVEL) == totals:
+                        continue
+                    if totals[1]:
+                        published[tick] = totals
+                    else:
+                        published.pop(tick, None)
+                    levels.sequence += 1
+                    symbol_updates.append(
+                        LevelDelta(levels.sequence, symbol, side, tick,
+                                   orderbook.ticks_to_price(tick), totals[0],
+                                   totals[1], timestamp_ns))
+                    deltas += 1
+        self.deltas_published += deltas
+
+        batches = []
+        for queue, symbols in list(self.subscribers.values()):
+            batch = [
+                update for symbol, symbol_updates in updates.items()
+                if symbols is None or symbol in symbols
+                for update in symbol_updates
+            ]
+            if batch:
+                batches.append((queue, batch))
+        if batches:
+            self.engine.events.publish_market_data(batches)
+
+    def get_statistics(self):
+        """Get feed counters"""
+        return {
+            'subscribers': len(self.subscribers),
+            'symbols': len(self.levels),
+            'deltas_published': self.deltas_published,
+            'prints_published': self.prints_published
+        }
+
+
+class L2Book:
+    """
+    Local copy of one symbol's levels, rebuilt from a snapshot plus updates
+
+    Updates at or below the snapshot's sequence are already reflected and
+    are skipped; any other out-of-sequence update marks the book stale.
+    """
+
+    def __init__(self, snapshot):
+        """
+        Initialize from a snapshot returned by MarketDataFeed.subscribe
+
+        Args:
+            snapshot (dict): Symbol snapshot
+        """
+        self.symbol = snapshot['symbol']
+        self.sequence = snapshot['sequence']
+        self.bids = {
+            tick: (price, quantity, count)
+            for tick, price, quantity, count in snapshot['bids']
+        }
+        self.asks = {
+            tick: (price, quantity, count)
+            for tick, price, quantity, count in snapshot['asks']
+        }
+        self.last_trade = None
+        self.is_stale = False
+
+    def apply(self, update):
+        """
+        Apply one LevelDelta or TradePrint for this symbol
+
+        Returns:
+            bool: False if the update is out of sequence (the book is stale
+                and must be rebuilt from a new snapshot)
+        """
+        if update.sequence <= self.sequence:
+            return True
+        if update.sequence != self.sequence + 1 or self.is_stale:
+            self.is_stale = True
+            return False
+        self.sequence = update.sequence
+
+        if isinstance(update, TradePrint):
+            self.last_trade = update
+            return True
+        levels = self.bids if update.side == BID else self.asks
+        if update.order_count:
+            levels[update.price_ticks] = (update.price, update.quantity,
+                                          update.order_count)
+        else:
+            levels.pop(update.price_ticks, None)
+        return True
+
+    def get_best_bid(self):
+        """Get the best bid as (price, quantity), or None"""
+        if not self.bids:
+            return None
+        price, quantity, _ = self.bids[max(self.bids)]
+        return price, quantity
+
+    def get_best_ask(self):
+        """Get the best ask as (price, quantity), or None"""
+        if not self.asks:
+            return None
+        price, quantity, _ = self.asks[min(self.asks)]
+        return price, quantity
+
+    def get_top_levels(self, num_levels=5):
+        """
+        Get top N levels per side, shaped like OrderBook.get_top_levels
+        without the orders
+
+        Returns:
+            dict: 'bids' and 'asks' lists of price/price_ticks/quantity/
+                order_count dicts, best first
+        """
+        def side_levels(levels, reverse):
+            return [{
+                'price': price,
+                'price_ticks': tick,
+                'quantity': quantity,
+                'order_count': count
+            } for tick, (price, quantity, count) in sorted(
+                levels.items(), reverse=reverse)[:num_levels]]
+
+        return {
+            'bids': side_levels(self.bids, True),
+            'asks': side_levels(self.asks, False)
+        }
+
+
+class MarketDataSubscriber:
+    """
+    Keeps L2Books for a set of symbols current from the feed
+
+    Books are replaced atomically with a fresh snapshot when a gap is seen.
+    Updates are applied on the dispatcher thread; read books under lock.
+    """
+
+    def __init__(self, engine, consumer_id, symbols=None):
+        """
+        Initialize the subscriber (call subscribe() to start)
+
+        Args:
+            engine: TradingEngine to subscribe to
+            consumer_id: Key for the subscription
+            symbols (iterable): Symbols to follow (None for all)
+        """
+        self.engine = engine
+        self.consumer_id = consumer_id
+        self.symbols = list(symbols) if symbols is not None else None
+        self.books = {}  # symbol -> L2Book
+        self.lock = threading.Lock()
+        self.updates_applied = 0
+        self.resyncs = 0
+
+    def subscribe(self):
+        """Subscribe and build every book from its snapshot"""
+        with self.lock:
+            snapshots = self.engine.subscribe_market_data(
+                self.consumer_id, self.on_market_data, self.symbols)
+            self.books = {
+                symbol: L2Book(snapshot)
+                for symbol, snapshot in snapshots.items()
+            }
+
+    def unsubscribe(self):
+        """Stop receiving updates"""
+        self.engine.unsubscribe_market_data(self.consumer_id)
+
+    def on_market_data(self, events):
+        """Apply a batch of MarketDataEvent (called by the dispatcher)"""
+        with self.lock:
+            books = self.books
+            in_sync = True
+            for event in events:
+                update = event.update
+                book = books.get(update.symbol)
+                if book is None:
+                    # First update of a symbol created after the snapshot
+                    book = books[update.symbol] = L2Book(
+                        empty_snapshot(update.symbol))
+                if not book.apply(update):
+                    in_sync = False
+                    break
+                self.updates_applied += 1
+
+        if not in_sync:
+            self.resyncs += 1
+            self.subscribe()
+
+    def get_book(self, symbol):
+        """Get a symbol's local book (None if not followed or not seen yet)"""
+        with self.lock:
+            return self.books.get(symbol)
@@ -0,0 +1,845 @@
+import threading
+import time
+
+from models.order import OrderInfo, OrderSide
+from models.ring_buffer import MPSCRingBuffer
+from models.wait_strategy import create_wait_strategy
+from models.latency import StageHistograms
+from models.lock_stats import CountingLock
+from models.events import FillEvent
+from models.trade_columns import build_trade_record
+from models.auction import allocate, find_clearing_price
+
+
+class MatchingShard:
+    """
+    Matching worker that owns a subset of the engine's symbols
+
+    Each shard has its own ingress queue, execution thread, active-order map
+    and locks, so orders for symbols on different shards never contend.
+    """
+
+    # How long an idle worker parks before re-checking is_running
+    IDLE_PARK_SECONDS = 0.01
+
+    def __init__(self,
+                 shard_id,
+                 engine,
+                 batch_size=100,
+                 queue_capacity=65536,
+                 overflow_policy=MPSCRingBuffer.OVERFLOW_BLOCK,
+                 wait_strategy=None,
+                 max_batch_size=None):
+        """
+        Initialize a matching shard
+
+        Args:
+            shard_id (int): Index of this shard in the engine
+            engine: Owning TradingEngine (order books, traders, ID counters)
+            batch_size (int): Orders taken from the queue per batch while
+                it is shallow
+            queue_capacity (int): Slots in the ingress ring
+            overflow_policy (str): Ring behaviour when full ('block' or 'reject')
+            wait_strategy: How the idle worker waits for orders (see
+                models.wait_strategy; None for 'block')
+            max_batch_size (int): Largest batch taken when the queue is backed
+                up (None for 8 x batch_size)
+        """
+        self.shard_id = shard_id
+        self.engine = engine
+        self.clock = engine.clock
+        self.journal = engine.journal
+        self.market_data = engine.market_data
+        self.last_prices = engine.last_prices
+        self.symbols = set()  # Symbols routed to this shard
+        self.auctions = {}  # symbol -> BatchAuction (symbols in auction mode)
+        self.active_orders = {}  # order_id -> order
+        self.trader_orders = {}  # trader_id -> {order_id: order}
+
+        # Every trade, as this shard's writer into the engine's trade store
+        self.trade_columns = engine.trade_store.writer()
+
+        # Performance metrics
+        self.total_trades = 0
+        self.total_volume = 0
+        self.rejected_orders = 0  # Dropped by the shard (bad price, or no native memory)
+        self.latency = {}  # symbol -> StageHistograms (written by this thread)
+
+        # Fill events and pool releases deferred until an order finishes
+        # matching (matching thread only)
+        self.pending_fills = []  # FillEvent
+        self.pending_trades = []  # Trade records for trade subscribers
+        self.pending_releases = []
+
+        # Market data changes, published before orders_lock is released
+        # (tracked only while the feed has subscribers)
+        self.touched_levels = {}  # orderbook -> (bid ticks, ask ticks)
+        self.pending_prints = []  # (trade record, trade time ns)
+
+        # Threading
+        self.is_running = False
+        self.order_queue = MPSCRingBuffer(queue_capacity, overflow_policy,
+                                          on_full=self._drain_inline)
+        self.execution_thread = None
+        # Held by whichever thread matches while the worker is stopped
+        # (run_until_idle or a producer draining a full ring)
+        self.drain_lock = threading.Lock()
+        self.stats_lock = CountingLock('stats_lock')
+        # Held while matching; other threads read this shard's books under it
+        self.orders_lock = CountingLock('orders_lock')
+
+        # Order processing statistics (optimized for HFT)
+        self.orders_per_second = 0
+        self.last_stats_update = self.clock.monotonic_ns()
+        self.orders_processed_since_last_update = 0
+        self.batch_size = batch_size  # Process orders in batches for better performance
+        self.max_batch_size = max(batch_size, max_batch_size or 8 * batch_size)
+        self.wait_strategy = create_wait_strategy(wait_strategy)
+        self.batches_processed = 0
+        self.largest_batch = 0
+
+    def start(self):
+        """Start the shard's execution thread"""
+        with self.drain_lock:
+            if self.is_running:
+                return
+            self.is_running = True
+            self.execution_thread = threading.Thread(
+                target=self._execution_loop,
+                name=f"matching-shard-{self.shard_id}",
+                daemon=True)
+            self.execution_thread.start()
+
+    def stop(self):
+        """Stop the shard's execution thread"""
+        self.is_running = False
+        self.order_queue.wake()
+        if self.execution_thread and self.execution_thread.is_alive():
+            self.execution_thread.join(timeout=2.0)
+
+    def _drain_inline(self):
+        """
+        Match a batch on a producer blocked by a full ring with no worker
+
+        A stopped engine is driven by run_until_idle (Simulation, journal
+        replay, CSV import before start), so nothing else would ever free
+        the ring: the blocked producer matches the oldest batch itself and
+        delivers its events, as run_until_idle would.
+
+        Returns:
+            bool: True if slots were freed
+        """
+        if self.is_running:
+            return False
+        with self.drain_lock:
+            thread = self.execution_thread
+            if self.is_running or (thread is not None and thread.is_alive()):
+                return False
+            batch = self.order_queue.drain(self.max_batch_size)
+            if batch:
+                self._process_batch(batch)
+        # Outside drain_lock, so a callback may submit (and drain) again
+        if batch and not self.engine.events.is_running:
+            self.engine.events.deliver_pending()
+        return bool(batch)
+
+    def submit(self, order):
+        """
+        Queue an order for this shard
+
+        Returns:
+            bool: False if the ingress ring is full and rejecting
+        """
+        return self.order_queue.put(order)
+
+    def submit_many(self, orders):
+        """
+        Queue several orders for this shard in order
+
+        Returns:
+            int: Number accepted (the rest did not fit and are rejected)
+        """
+        return self.order_queue.put_many(orders)
+
+    def _execution_loop(self):
+        """Main execution loop that processes orders (optimized for HFT)"""
+        while self.is_running:
+            try:
+                # Take everything published so far, up to one batch
+                orders_to_process = self.order_queue.drain(self._batch_limit())
+
+                # If no orders, wait until a producer publishes (or the
+                # next auction is due)
+                if not orders_to_process:
+                    if self.auctions:
+                        self.run_due_auctions()
+                    self.wait_strategy.wait(self.order_queue,
+                                            self._idle_park_seconds())
+                    continue
+
+                # Process the batch
+                self.batches_processed += 1
+                if len(orders_to_process) > self.largest_batch:
+                    self.largest_batch = len(orders_to_process)
+                self._process_batch(orders_to_process)
+                if self.auctions:
+                    self.run_due_auctions()
+
+            except Exception as e:
+                print(f"Error in execution loop (shard {self.shard_id}): {e}")
+                time.sleep(0.001)  # Brief pause on error
+
+    def _batch_limit(self):
+        """
+        Orders to take in the next batch
+
+        A shallow queue is taken batch_size at a time, so the first order
+        never waits behind a long batch. When the backlog is deeper the
+        batch grows to cover it (up to max_batch_size), amortizing the
+        per-batch lock, market data and fill flush over more orders.
+        """
+        depth = len(self.order_queue)
+        if depth <= self.batch_size:
+            return self.batch_size
+        return min(depth, self.max_batch_size)
+
+    def _process_batch(self, orders):
+        """Process a batch of orders drained from the ingress ring"""
+        dequeue_ns = self.clock.monotonic_ns()
+        for order in orders:
+            self._process_order(order, dequeue_ns)
+
+    def _process_order(self, order, dequeue_ns):
+        """Process a single order"""
+        submit_time = order.submit_time
+        symbol = order.symbol
+        match_start_ns = self.clock.monotonic_ns()
+
+        with self.orders_lock:
+            # Convert the limit price to integer ticks before tracking it
+            orderbook = self.engine.get_orderbook(order.symbol)
+            if not self._prepare(order, orderbook):
+                return
+            self._track(order)
+            if self.journal is not None:
+                self.journal.record_accept(order, orderbook, self.clock.time_ns())
+
+            # Try to match the order (auction symbols match in batches)
+            auction = self.auctions.get(symbol) if self.auctions else None
+            if auction is None:
+                self._match_order(order, orderbook)
+
+            # If order still has quantity, add to book
+            if order.is_active() and order.quantity > 0:
+                if auction is None:
+                    orderbook.add_order(order)
+                    if self.market_data.active:
+                        self._touch(orderbook, order.side, order.price_ticks)
+                else:
+                    collect_ns = self.clock.monotonic_ns()
+                    if auction.is_due(collect_ns):
+                        # The batch's interval closed before this order
+                        # arrived; it belongs to the next one
+                        self._run_auction(orderbook, auction)
+                    if auction.collect(order, collect_ns):
+                        self._run_auction(orderbook, auction)
+            else:
+                # Remove from active orders if completely filled or cancelled
+                self._untrack(order.order_id)
+                self.pending_releases.append(order)
+            self._publish_market_data()
+
+        match_end_ns = self.clock.monotonic_ns()
+        self._flush_fills()
+
+        # Record per-stage latency
+        if submit_time is not None:
+            self._record_latency(symbol, submit_time, dequeue_ns,
+                                 match_start_ns, match_end_ns,
+                                 self.clock.monotonic_ns())
+
+        # Update statistics
+        self._update_processing_stats()
+
+    def _match_order(self, incoming_order, orderbook):
+        """Match an incoming order against the order book"""
+        if incoming_order.side == OrderSide.BUY:
+            # Match buy order against asks (sell orders)
+            self._match_buy_order(incoming_order, orderbook)
+        else:
+            # Match sell order against bids (buy orders)
+            self._match_sell_order(incoming_order, orderbook)
+
+    def _match_buy_order(self, buy_order, orderbook):
+        """Match a buy order against asks"""
+        while buy_order.quantity > 0 and buy_order.is_active():
+            best_ask = orderbook.asks.get_best_order()
+
+            if not best_ask or best_ask.price_ticks > buy_order.price_ticks:
+                break  # No more matching orders
+
+            # Execute trade
+            trade_quantity = min(buy_order.quantity, best_ask.quantity)
+            trade_price = best_ask.price_ticks  # Price-time priority: use ask price
+
+            self._execute_trade(buy_order, best_ask, trade_quantity,
+                                trade_price, orderbook)
+
+            # Remove ask order if completely filled
+            if best_ask.quantity == 0:
+                orderbook.remove_order(best_ask.order_id, OrderSide.SELL)
+                self._untrack(best_ask.order_id)
+                self.pending_releases.append(best_ask)
+
+    def _match_sell_order(self, sell_order, orderbook):
+        """Match a sell order against bids"""
+        while sell_order.quantity > 0 and sell_order.is_active():
+            best_bid = orderbook.bids.get_best_order()
+
+            if not best_bid or best_bid.price_ticks < sell_order.price_ticks:
+                break  # No more matching orders
+
+            # Execute trade
+            trade_quantity = min(sell_order.quantity, best_bid.quantity)
+            trade_price = best_bid.price_ticks  # Price-time priority: use bid price
+
+            self._execute_trade(sell_order, best_bid, trade_quantity,
+                                trade_price, orderbook)
+
+            # Remove bid order if completely filled
+            if best_bid.quantity == 0:
+                orderbook.remove_order(best_bid.order_id, OrderSide.BUY)
+                self._untrack(best_bid.order_id)
+                self.pending_releases.append(best_bid)
+
+    def _execute_trade(self, taker_order, maker_order, quantity, price_ticks,
+                       orderbook, resting_taker=False):
+        """
+        Execute a trade between an incoming order and a resting order
+
+        Args:
+            taker_order: Incoming (aggressive) order
+            maker_order: Resting order in the book
+            quantity (int): Quantity traded
+            price_ticks (int): Trade price in ticks
+            orderbook: Book the resting order belongs to
+            resting_taker (bool): The taker rests in the book too (auction
+                fills, where the later order is reported as the taker)
+        """
+        trade_time_ns = self.clock.time_ns()
+        price = orderbook.ticks_to_price(price_ticks)
+        sequence = next(self.engine.trade_ids)
+
+        # Fill both orders (the book keeps its level totals in sync)
+        if resting_taker:
+            orderbook.fill_uncrossed_order(taker_order, quantity, price)
+            orderbook.fill_uncrossed_order(maker_order, quantity, price)
+        else:
+            taker_order.fill(quantity, price)
+            orderbook.fill_resting_order(maker_order, quantity, price)
+
+        # Side is from the perspective of the aggressive order
+        if taker_order.side == OrderSide.BUY:
+            buy_order, sell_order = taker_order, maker_order
+            side = 0
+        else:
+            buy_order, sell_order = maker_order, taker_order
+            side = 1
+        symbol = buy_order.symbol
+        buy_order_id, sell_order_id = buy_order.order_id, sell_order.order_id
+        buyer_id, seller_id = buy_order.trader_id, sell_order.trader_id
+
+        with self.stats_lock:
+            self.total_trades += 1
+            self.total_volume += quantity
+
+        # Record the trade as columns (the trade store's writer and the
+        # book's tape and bars) and mark the symbol
+        self.trade_columns.append(sequence, trade_time_ns, symbol,
+                                  orderbook.tick_size, side, quantity,
+                                  price_ticks, price, buy_order_id,
+                                  sell_order_id, buyer_id, seller_id)
+        orderbook.add_trade(sequence, trade_time_ns, side, quantity,
+                            price_ticks, buy_order_id, sell_order_id, buyer_id,
+                            seller_id)
+        self.last_prices[symbol] = price
+        if self.journal is not None:
+            self.journal.record_trade(orderbook, trade_time_ns, sequence, side,
+                                      quantity, price_ticks, buy_order_id,
+                                      sell_order_id)
+
+        # Snapshot fill events now; they are published once the taker
+        # finishes matching
+        self.pending_fills.append(
+            FillEvent(buy_order, quantity, price, sequence, trade_time_ns))
+        self.pending_fills.append(
+            FillEvent(sell_order, quantity, price, sequence, trade_time_ns))
+        # A trade dict is only built for consumers that take one
+        publish_trade = self.engine.events.has_trade_subscribers()
+        if publish_trade or self.market_data.active:
+            trade = build_trade_record(sequence, trade_time_ns, symbol, side,
+                                       quantity, price_ticks, price,
+                                       buy_order_id, sell_order_id, buyer_id,
+                                       seller_id)
+            if publish_trade:
+                self.pending_trades.append(trade)
+        if self.market_data.active:
+            self._touch(orderbook, maker_order.side, maker_order.price_ticks)
+            if resting_taker:
+                self._touch(orderbook, taker_order.side, taker_order.price_ticks)
+            self.pending_prints.append((trade, trade_time_ns))
+
+    def set_auction(self, symbol, auction):
+        """
+        Put a symbol in batch-auction mode, or back to continuous matching
+
+        Orders sealed in a replaced auction carry over to the new one; when
+        switching to continuous matching they are re-queued through the
+        ingress ring in arrival order and match as they are re-processed.
+
+        Args:
+            symbol (str): Symbol routed to this shard
+            auction: models.auction.BatchAuction, or None for continuous
+        """
+        with self.orders_lock:
+            previous = self.auctions.pop(symbol, None)
+            sealed = previous.take_batch() if previous is not None else []
+            if auction is not None:
+                self.auctions[symbol] = auction
+                for order in sealed:
+                    auction.collect(order, self.clock.monotonic_ns())
+                return
+            for order in sealed:
+                self._untrack(order.order_id)
+
+        accepted = self.order_queue.put_many(sealed)
+        for order in sealed[accepted:]:
+            order.cancel()
+            self.engine.order_pool.release(order)
+
+    def run_due_auctions(self):
+        """
+        Uncross every auction whose interval has elapsed
+
+        Returns:
+            int: Number of auctions run
+        """
+        now_ns = self.clock.monotonic_ns()
+        due = [(symbol, auction) for symbol, auction in list(self.auctions.items())
+               if auction.is_due(now_ns)]
+        if not due:
+            return 0
+        with self.orders_lock:
+            for symbol, auction in due:
+                if auction.pending:
+                    self._run_auction(self.engine.get_orderbook(symbol), auction)
+            self._publish_market_data()
+        self._flush_fills()
+        return len(due)
+
+    def _idle_park_seconds(self):
+        """Park time for an idle worker, cut short by the next due auction"""
+        due = [auction.next_due_ns for auction in list(self.auctions.values())
+               if auction.pending and auction.next_due_ns is not None]
+        if not due:
+            return self.IDLE_PARK_SECONDS
+        wait_ns = min(due) - self.clock.monotonic_ns()
+        return max(0.0, min(self.IDLE_PARK_SECONDS, wait_ns / 1e9))
+
+    def _run_auction(self, orderbook, auction):
+        """Add a sealed batch to the book and uncross it (orders_lock held)"""
+        batch = auction.take_batch()
+        for order in batch:
+            orderbook.add_order(order)
+            if self.market_data.active:
+                self._touch(orderbook, order.side, order.price_ticks)
+        auction.auctions_run += 1
+        auction.orders_auctioned += len(batch)
+
+        best_bid = orderbook.bids.get_best_tick()
+        best_ask = orderbook.asks.get_best_tick()
+        if best_bid is None or best_ask is None or best_bid < best_ask:
+            return
+
+        bid_levels = self._crossed_levels(orderbook.bids,
+                                          lambda tick: tick >= best_ask)
+        ask_levels = self._crossed_levels(orderbook.asks,
+                                          lambda tick: tick <= best_bid)
+        reference_tick = auction.last_clearing_tick
+        if reference_tick is None and orderbook.get_last_trade_price():
+            reference_tick = orderbook.price_to_ticks(
+                orderbook.get_last_trade_price())
+        clearing = find_clearing_price(
+            [(level['price_ticks'], level['quantity']) for level in bid_levels],
+            [(level['price_ticks'], level['quantity']) for level in ask_levels],
+            reference_tick)
+        if clearing is None:
+            return
+        tick, volume = clearing
+        buys = allocate([level['orders'] for level in bid_levels
+                         if level['price_ticks'] >= tick], volume,
+                        auction.allocation)
+        sells = allocate([level['orders'] for level in ask_levels
+                          if level['price_ticks'] <= tick], volume,
+                         auction.allocation)
+
+        # Pair the two sides' fills in priority order; each pair prints at
+        # the clearing price
+        b = s = 0
+        buy_left = buys[0][1]
+        sell_left = sells[0][1]
+        while b < len(buys) and s < len(sells):
+            buy_order, sell_order = buys[b][0], sells[s][0]
+            quantity = min(buy_left, sell_left)
+            if buy_order.order_id > sell_order.order_id:
+                self._execute_trade(buy_order, sell_order, quantity, tick,
+                                    orderbook, resting_taker=True)
+            else:
+                self._execute_trade(sell_order, buy_order, quantity, tick,
+                                    orderbook, resting_taker=True)
+            buy_left -= quantity
+            sell_left -= quantity
+            if buy_left == 0:
+                b += 1
+                buy_left = buys[b][1] if b < len(buys) else 0
+            if sell_left == 0:
+                s += 1
+                sell_left = sells[s][1] if s < len(sells) else 0
+
+        for order, _ in buys + sells:
+            if order.quantity == 0:
+                orderbook.remove_order(order.order_id, order.side)
+                self._untrack(order.order_id)
+                self.pending_releases.append(order)
+        auction.volume_cleared += volume
+        auction.last_clearing_tick = tick
+
+    @staticmethod
+    def _crossed_levels(side, crosses):
+        """Best levels of a side (with orders) while crosses(tick) holds"""
+        count = 8
+        while True:
+            levels = side.get_top_levels(count)
+            crossed = [level for level in levels if crosses(level['price_ticks'])]
+            if len(crossed) < len(levels) or len(levels) < count:
+                return crossed
+            count *= 4
+
+    def _unseal(self, order):
+        """Take an order out of its auction batch (orders_lock held)"""
+        auction = self.auctions.get(order.symbol) if self.auctions else None
+        return (auction is not None and
+                auction.pending.pop(order.order_id, None) is not None)
+
+    def _touch(self, orderbook, side, tick):
+        """Note a level whose aggregate may have changed (orders_lock held)"""
+        touched = self.touched_levels.get(orderbook)
+        if touched is None:
+            touched = self.touched_levels[orderbook] = (set(), set())
+        touched[0 if side is OrderSide.BUY else 1].add(tick)
+
+    def _publish_market_data(self):
+        """Publish deltas for touched levels and trade prints (orders_lock held)"""
+        if self.touched_levels or self.pending_prints:
+            touched = self.touched_levels
+            prints = self.pending_prints
+            self.touched_levels = {}
+            self.pending_prints = []
+            self.market_data.publish(touched, prints, self.clock.time_ns())
+
+    def _flush_fills(self):
+        """Publish deferred fill and trade events, then recycle finished orders"""
+        events = self.engine.events
+        if self.pending_fills:
+            fills_by_trader = {}
+            for event in self.pending_fills:
+                fills_by_trader.setdefault(event.trader_id, []).append(event)
+            self.pending_fills = []
+            events.publish_fills(fills_by_trader)
+
+        if self.pending_trades:
+            trades = self.pending_trades
+            self.pending_trades = []
+            events.publish_trades(trades)
+
+        if self.pending_releases:
+            releases = self.pending_releases
+            self.pending_releases = []
+            release = self.engine.order_pool.release
+            for order in releases:
+                release(order)
+
+    def _record_latency(self, symbol, submit_ns, dequeue_ns, match_start_ns,
+                        match_end_ns, notify_end_ns):
+        """Record one order's stage timestamps in its symbol's histograms"""
+        histograms = self.latency.get(symbol)
+        if histograms is None:
+            histograms = self.latency[symbol] = StageHistograms()
+        histograms.record(submit_ns, dequeue_ns, match_start_ns, match_end_ns,
+                          notify_end_ns)
+
+    def get_latency_histograms(self):
+        """Get a copy of this shard's per-symbol stage histograms"""
+        return {
+            symbol: histograms.copy()
+            for symbol, histograms in list(self.latency.items())
+        }
+
+    def _update_processing_stats(self, count=1):
+        """Update processing statistics"""
+        current_time = self.clock.monotonic_ns()
+        self.orders_processed_since_last_update += count
+
+        # Update stats every second
+        if current_time - self.last_stats_update >= 1_000_000_000:
+            self.orders_per_second = self.orders_processed_since_last_update
+            self.orders_processed_since_last_update = 0
+            self.last_stats_update = current_time
+
+    def _prepare(self, order, orderbook):
+        """
+        Snap an incoming order to the book's ticks, rejecting a bad price
+
+        A rejected order is cancelled and returned to the pool before it is
+        tracked, journaled or matched (orders_lock held).
+
+        Returns:
+            bool: False if the order was rejected
+        """
+        try:
+            orderbook.prepare_order(order)
+        except ValueError:
+            order.cancel()
+            self.engine.order_pool.release(order)
+            self.rejected_orders += 1
+            return False
+        return True
+
+    def _track(self, order):
+        """Add an order to the active map and its trader's index (orders_lock held)"""
+        self.active_orders[order.order_id] = order
+        orders = self.trader_orders.get(order.trader_id)
+        if orders is None:
+            orders = self.trader_orders[order.trader_id] = {}
+        orders[order.order_id] = order
+
+    def _untrack(self, order_id):
+        """Remove an order from the active map and its trader's index (orders_lock held)"""
+        order = self.active_orders.pop(order_id, None)
+        if order is not None:
+            orders = self.trader_orders.get(order.trader_id)
+            if orders is not None:
+                orders.pop(order_id, None)
+                if not orders:
+                    del self.trader_orders[order.trader_id]
+        return order
+
+    def cancel_order(self, order_id):
+        """Cancel an order resting on this shard"""
+        with self.orders_lock:
+            return self._cancel_locked(order_id)
+
+    def _cancel_locked(self, order_id):
+        """Cancel an active order (orders_lock held)"""
+        order = self._untrack(order_id)
+        if order is None:
+            return False
+        order.cancel()
+
+        # Remove from order book (a sealed auction order never reached it)
+        orderbook = self.engine.get_orderbook(order.symbol)
+        if not self._unseal(order):
+            orderbook.remove_order(order_id, order.side)
+        if self.journal is not None:
+            self.journal.record_cancel(order, orderbook, self.clock.time_ns())
+        if self.market_data.active:
+            self._touch(orderbook, order.side, order.price_ticks)
+            self._publish_market_data()
+        self.engine.order_pool.release(order)
+        return True
+
+    def cancel_all(self, trader_id, symbol=None):
+        """
+        Cancel every resting order of a trader on this shard
+
+        Args:
+            trader_id (str): Owner of the orders
+            symbol (str): Only cancel orders for this symbol if given
+
+        Returns:
+            int: Number of orders cancelled
+        """
+        with self.orders_lock:
+            orders = self.trader_orders.get(trader_id)
+            if not orders:
+                return 0
+            order_ids = [
+                order_id for order_id, order in orders.items()
+                if symbol is None or order.symbol == symbol
+            ]
+            for order_id in order_ids:
+                self._cancel_locked(order_id)
+            return len(order_ids)
+
+    def amend_order(self, order_id, quantity=None, price=None):
+        """
+        Change a resting order's remaining quantity and/or limit price
+
+        A size-down at the same price is applied in place and keeps the
+        order's queue position. A price change or size-up removes the order
+        from the book and re-queues it through the ingress ring, so it may
+        match immediately and otherwise rests at the back of its new level;
+        until it is re-processed it cannot be cancelled or amended again.
+
+        Args:
+            order_id (int): Order to change
+            quantity (int): New remaining quantity (None keeps it; 0 cancels)
+            price (float): New limit price (None keeps it)
+
+        Returns:
+            bool: True if the amendment was applied or queued; False if the
+                order is not active here or the ring rejected it (the order
+                is then cancelled)
+
+        Raises:
+            ValueError: If the price is NaN, infinite or outside the book's
+                price band (the order is left unchanged)
+        """
+        with self.orders_lock:
+            order = self.active_orders.get(order_id)
+            if order is None:
+                return False
+            if quantity is None:
+                quantity = order.quantity
+            if quantity <= 0:
+                return self._cancel_locked(order_id)
+
+            orderbook = self.engine.get_orderbook(order.symbol)
+            price_ticks = order.price_ticks
+            if price is not None:
+                price_ticks = orderbook.price_to_ticks(price, order.side)
+                orderbook.check_price_band(price_ticks)
+
+            auction = self.auctions.get(order.symbol) if self.auctions else None
+            if auction is not None and order_id in auction.pending:
+                return self._amend_sealed(order, orderbook, auction, quantity,
+                                          price, price_ticks)
+
+            if price_ticks == order.price_ticks and quantity <= order.quantity:
+                # Size-down (or no-op) keeps priority
+                if quantity == order.quantity:
+                    return True
+                if not orderbook.reduce_order(order, quantity):
+                    return False
+                if self.journal is not None:
+                    self.journal.record_amend(order, orderbook,
+                                              self.clock.time_ns())
+                if self.market_data.active:
+                    self._touch(orderbook, order.side, order.price_ticks)
+                    self._publish_market_data()
+                return True
+
+            # Price change or size-up loses priority: pull and re-queue
+            orderbook.remove_order(order_id, order.side)
+            self._untrack(order_id)
+            if self.journal is not None:
+                self.journal.record_cancel(order, orderbook,
+                                           self.clock.time_ns(), requeued=True)
+            if self.market_data.active:
+                self._touch(orderbook, order.side, order.price_ticks)
+                self._publish_market_data()
+            order.amend(quantity, price)
+            order.timestamp_ns = order.submit_time = self.clock.monotonic_ns()
+
+        if self.order_queue.put(order):
+            return True
+        order.cancel()
+        self.engine.order_pool.release(order)
+        return False
+
+    def _amend_sealed(self, order, orderbook, auction, quantity, price,
+                      price_ticks):
+        """
+        Amend an order sealed in an auction batch (orders_lock held)
+
+        Nothing is in the book yet, so the change is applied directly; a
+        size-down at the same price keeps the order's place in the batch,
+        anything else moves it to the back.
+        """
+        if price_ticks == order.price_ticks and quantity <= order.quantity:
+            if quantity < order.quantity:
+                order.amend(quantity)
+                if self.journal is not None:
+                    self.journal.record_amend(order, orderbook,
+                                              self.clock.time_ns())
+            return True
+
+        del auction.pending[order.order_id]
+        if self.journal is not None:
+            self.journal.record_cancel(order, orderbook, self.clock.time_ns(),
+                                       requeued=True)
+        order.amend(quantity, price)
+        orderbook.prepare_order(order)
+        order.timestamp_ns = order.submit_time = self.clock.monotonic_ns()
+        if self.journal is not None:
+            self.journal.record_accept(order, orderbook, self.clock.time_ns())
+        auction.pending[order.order_id] = order
+        return True
+
+    def get_auction_statistics(self):
+        """Get per-symbol counters of this shard's auctions"""
+        with self.orders_lock:
+            return {
+                symbol: auction.get_statistics()
+                for symbol, auction in self.auctions.items()
+            }
+
+    def get_recent_trades(self, count=20):
+        """Get recent trades executed on this shard (0: all still in memory)"""
+        return self.trade_columns.last(count)
+
+    def get_recent_trades_for_symbol(self, symbol, count=10):
+        """Get recent trades for a specific symbol on this shard"""
+        if symbol not in self.symbols:
+            return []
+        return self.engine.get_orderbook(symbol).get_recent_trades(count)
+
+    def get_trader_orders(self, trader_id, symbol=None):
+        """
+        Get all active orders for a trader on this shard
+
+        Returns:
+            list: OrderInfo copies taken under orders_lock
+        """
+        with self.orders_lock:
+            orders = self.trader_orders.get(trader_id)
+            if not orders:
+                return []
+            return [
+                OrderInfo(order.order_id, order.symbol, order.side, order.price,
+                          order.quantity)
+                for order in orders.values()
+                if symbol is None or order.symbol == symbol
+            ]
+
+    def get_stats(self):
+        """Get a consistent copy of this shard's counters"""
+        with self.stats_lock:
+            return {
+                'shard_id': self.shard_id,
+                'symbols': sorted(self.symbols),
+                'total_trades': self.total_trades,
+                'total_volume': self.total_volume,
+                'rejected_orders': self.rejected_orders,
+                'orders_per_second': self.orders_per_second,
+                'active_orders': len(self.active_orders),
+                'queue_depth': len(self.order_queue),
+                'batches_processed': self.batches_processed,
+                'largest_batch': self.largest_batch,
+                'ingress': self.order_queue.get_statistics(),
+                'wait': self.wait_strategy.get_statistics(),
+                'locks': {
+                    'orders_lock': self.orders_lock.get_statistics(),
+                    'stats_lock': self.stats_lock.get_statistics()
+                }
+            }
@@ -0,0 +1,455 @@
+"""
+Optional compiled matching backend
+
+The native core (native/matching_core.c) keeps the price ladder, level FIFOs
+and order index in C and matches whole batches per call with the GIL
+released. Python keeps the Order objects, trade records and trader
+callbacks, so everything built on TradingEngine keeps working unchanged.
+
+Build the library with ``make -C native`` or point HFT_NATIVE_LIB at it.
+"""
+
+import ctypes
+import os
+
+from models.matching_shard import MatchingShard
+from models.order import OrderSide
+from models.orderbook import OrderBook, DEFAULT_TICK_SIZE
+
+NATIVE_BUY = 0
+NATIVE_SELL = 1
+
+# Sweep limits and quantity that never bind
+NO_LIMIT_ASK = 1 << 62
+NO_LIMIT_BID = -(1 << 62)
+
+_DEFAULT_LIBRARY = os.path.join(os.path.dirname(os.path.dirname(__file__)),
+                                'native', 'libmatching_core.so')
+
+
+class NativeOrder(ctypes.Structure):
+    """Incoming order as laid out by mc_order_t"""
+    _fields_ = [('order_id', ctypes.c_int64), ('price_ticks', ctypes.c_int64),
+                ('quantity', ctypes.c_int64), ('side', ctypes.c_int32),
+                ('rejected', ctypes.c_int32)]
+
+
+class NativeFill(ctypes.Structure):
+    """Fill event as laid out by mc_fill_t"""
+    _fields_ = [('taker_id', ctypes.c_int64), ('maker_id', ctypes.c_int64),
+                ('price_ticks', ctypes.c_int64), ('quantity', ctypes.c_int64),
+                ('maker_remaining', ctypes.c_int64),
+                ('taker_remaining', ctypes.c_int64)]
+
+
+_library = None
+
+
+def load_library(path=None):
+    """
+    Load the native matching library (cached after the first call)
+
+    Raises:
+        RuntimeError: If the shared library cannot be found or loaded
+    """
+    global _library
+    if _library is not None:
+        return _library
+
+    path = path or os.environ.get('HFT_NATIVE_LIB', _DEFAULT_LIBRARY)
+    try:
+        lib = ctypes.CDLL(path)
+    except OSError as e:
+        raise RuntimeError(
+            f"Native matching backend not available ({e}); "
+            f"build it with 'make -C native'") from e
+
+    handle = ctypes.c_void_p
+    i64 = ctypes.c_int64
+    i32 = ctypes.c_int32
+    i64_p = ctypes.POINTER(ctypes.c_int64)
+
+    lib.mc_book_create.restype = handle
+    lib.mc_book_create.argtypes = []
+    lib.mc_book_destroy.restype = None
+    lib.mc_book_destroy.argtypes = [handle]
+    lib.mc_process_batch.restype = i64
+    lib.mc_process_batch.argtypes = [handle, ctypes.POINTER(NativeOrder), i64]
+    lib.mc_fill_buffer.restype = ctypes.POINTER(NativeFill)
+    lib.mc_fill_buffer.argtypes = [handle]
+    lib.mc_add.restype = ctypes.c_int
+    lib.mc_add.argtypes = [handle, ctypes.POINTER(NativeOrder)]
+    lib.mc_cancel.restype = ctypes.c_int
+    lib.mc_cancel.argtypes = [handle, i64]
+    lib.mc_reduce.restype = ctypes.c_int
+    lib.mc_reduce.argtypes = [handle, i64, i64]
+    lib.mc_best_tick.restype = ctypes.c_int
+    lib.mc_best_tick.argtypes = [handle, i32, i64_p]
+    lib.mc_best_order_id.restype = i64
+    lib.mc_best_order_id.argtypes = [handle, i32]
+    lib.mc_top_levels.restype = i64
+    lib.mc_top_levels.argtypes = [handle, i32, i64, i64_p, i64_p, i64_p]
+    lib.mc_level_order_ids.restype = i64
+    lib.mc_level_order_ids.argtypes = [handle, i32, i64, i64_p, i64]
+    lib.mc_levels_at.restype = None
+    lib.mc_levels_at.argtypes = [handle, i32, i64, i64_p, i64_p, i64_p]
+    lib.mc_sweep.restype = None
+    lib.mc_sweep.argtypes = [handle, i32, i64, i64_p, i64, i64_p, i64_p, i64_p]
+    lib.mc_side_totals.restype = None
+    lib.mc_side_totals.argtypes = [handle, i32, i64_p, i64_p, i64_p]
+
+    _library = lib
+    return lib
+
+
+def is_available():
+    """Check if the native library can be loaded"""
+    try:
+        load_library()
+        return True
+    except RuntimeError:
+        return False
+
+
+class NativeBookSide:
+    """
+    Read/write view of one side of a native book
+
+    Mirrors the OrderBookSide API so OrderBook's composite queries (spread,
+    snapshot, statistics, depth) work unchanged.
+    """
+
+    def __init__(self, book, is_bid_side):
+        """
+        Initialize the side view
+
+        Args:
+            book (NativeOrderBook): Owning book
+            is_bid_side (bool): True for bids, False for asks
+        """
+        self.book = book
+        self.is_bid_side = is_bid_side
+        self.side_id = NATIVE_BUY if is_bid_side else NATIVE_SELL
+
+    def add_order(self, order):
+        """Rest an order without matching"""
+        native = NativeOrder(order.order_id, order.price_ticks, order.quantity,
+                             self.side_id, 0)
+        if self.book.lib.mc_add(self.book.handle, ctypes.byref(native)) != 0:
+            raise RuntimeError(f"native core could not rest order "
+                               f"{order.order_id} (duplicate ID or out of memory)")
+
+    def remove_order(self, order_id):
+        """Remove an order from this side"""
+        return bool(self.book.lib.mc_cancel(self.book.handle, order_id))
+
+    def reduce_order(self, order, quantity):
+        """Shrink a resting order in place, keeping its queue position"""
+        if not self.book.lib.mc_reduce(self.book.handle, order.order_id,
+                                       quantity):
+            return False
+        order.amend(quantity)
+        return True
+
+    def fill_order(self, order, quantity, price):
+        """Apply a fill the core already made to the Python order"""
+        order.fill(quantity, price)
+
+    def get_best_tick(self):
+        """Get the best price on this side in ticks"""
+        tick = ctypes.c_int64()
+        if self.book.lib.mc_best_tick(self.book.handle, self.side_id,
+                                      ctypes.byref(tick)):
+            return tick.value
+        return None
+
+    def get_best_price(self):
+        """Get the best price on this side"""
+        tick = self.get_best_tick()
+        return self.book.ticks_to_price(tick) if tick is not None else None
+
+    def get_best_order(self):
+        """Get the best order (first order at best price)"""
+        order_id = self.book.lib.mc_best_order_id(self.book.handle,
+                                                  self.side_id)
+        return self.book.order_lookup(order_id) if order_id else None
+
+    def _order_ids_at_tick(self, tick, capacity):
+        ids = (ctypes.c_int64 * capacity)()
+        count = self.book.lib.mc_level_order_ids(self.book.handle,
+                                                 self.side_id, tick, ids,
+                                                 capacity)
+        return ids[:count]
+
+    def get_orders_at_price(self, price):
+        """Get all orders at a specific price level"""
+        tick = self.book.price_to_ticks(price)
+        _, order_count, _ = self._totals()
+        ids = self._order_ids_at_tick(tick, max(1, order_count))
+        return [
+            order for order in map(self.book.order_lookup, ids)
+            if order is not None
+        ]
+
+    def get_top_levels(self, num_levels, include_orders=True):
+        """Get top N price levels with their orders"""
+        ticks = (ctypes.c_int64 * num_levels)()
+        quantities = (ctypes.c_int64 * num_levels)()
+        counts = (ctypes.c_int64 * num_levels)()
+        written = self.book.lib.mc_top_levels(self.book.handle, self.side_id,
+                                              num_levels, ticks, quantities,
+                                              counts)
+        levels = []
+        for i in range(written):
+            ids = self._order_ids_at_tick(ticks[i],
+                                          counts[i]) if include_orders else []
+            levels.append({
+                'price': self.book.ticks_to_price(ticks[i]),
+                'price_ticks': ticks[i],
+                'quantity': quantities[i],
+                'order_count': counts[i],
+                'orders': [
+                    order for order in map(self.book.order_lookup, ids)
+                    if order is not None
+                ]
+            })
+        return levels
+
+    def get_resting_orders(self):
+        """Get every resting order in priority order (best level first, FIFO within a level)"""
+        levels = self.get_top_levels(max(1, self.get_level_count()))
+        return [order for level in levels for order in level['orders']]
+
+    def get_volume_at_tick(self, tick):
+        """Get total resting quantity at a tick (the level total the core keeps)"""
+        return self.get_levels_at([tick])[0][0]
+
+    def get_levels_at(self, ticks):
+        """Get (total quantity, order count) at each tick, (0, 0) where empty"""
+        count = len(ticks)
+        tick_array = (ctypes.c_int64 * count)(*ticks)
+        quantities = (ctypes.c_int64 * count)()
+        counts = (ctypes.c_int64 * count)()
+        self.book.lib.mc_levels_at(self.book.handle, self.side_id, count,
+                                   tick_array, quantities, counts)
+        return list(zip(quantities, counts))
+
+    def sweep_many(self, quantities, limit_tick=None):
+        """
+        Sweep the side for each quantity in one native call
+
+        Returns:
+            list: (filled quantity, notional in ticks, last tick or None)
+        """
+        count = len(quantities)
+        if limit_tick is None:
+            limit_tick = NO_LIMIT_BID if self.is_bid_side else NO_LIMIT_ASK
+        wanted = (ctypes.c_int64 * count)(
+            *(min(quantity, NO_LIMIT_ASK) for quantity in quantities))
+        filled = (ctypes.c_int64 * count)()
+        notional = (ctypes.c_int64 * count)()
+        last_ticks = (ctypes.c_int64 * count)()
+        self.book.lib.mc_sweep(self.book.handle, self.side_id, count, wanted,
+                               limit_tick, filled, notional, last_ticks)
+        return [(filled[i], notional[i],
+                 last_ticks[i] if filled[i] else None) for i in range(count)]
+
+    def sweep(self, quantity, limit_tick=None):
+        """Sweep the side from its best level (see OrderBookSide.sweep)"""
+        return self.sweep_many([quantity], limit_tick)[0]
+
+    def _totals(self):
+        level_count = ctypes.c_int64()
+        order_count = ctypes.c_int64()
+        total_volume = ctypes.c_int64()
+        self.book.lib.mc_side_totals(self.book.handle, self.side_id,
+                                     ctypes.byref(level_count),
+                                     ctypes.byref(order_count),
+                                     ctypes.byref(total_volume))
+        return level_count.value, order_count.value, total_volume.value
+
+    def get_total_volume(self):
+        """Get total volume on this side"""
+        return self._totals()[2]
+
+    def get_level_count(self):
+        """Get the number of non-empty price levels"""
+        return self._totals()[0]
+
+    def get_order_count(self):
+        """Get the number of resting orders"""
+        return self._totals()[1]
+
+
+class NativeOrderBook(OrderBook):
+    """
+    OrderBook whose levels and matching live in the native core
+
+    Resting Order objects are resolved by ID through order_lookup (the
+    owning shard's active-order map).
+    """
+
+    def __init__(self, symbol, tick_size=DEFAULT_TICK_SIZE, order_lookup=None,
+                 lock=None, price_band=None):
+        """
+        Initialize a native order book
+
+        Args:
+            symbol (str): Trading symbol
+            tick_size (float): Minimum price increment for this symbol
+            order_lookup (callable): order_id -> Order (or None)
+            lock: Owner's lock for other readers (see OrderBook)
+            price_band (float): Limit price band around the last trade (see
+                OrderBook)
+        """
+        super().__init__(symbol, tick_size, lock, price_band)
+        self.lib = load_library()
+        self.handle = self.lib.mc_book_create()
+        if not self.handle:
+            raise MemoryError("Failed to allocate native order book")
+        self.order_lookup = order_lookup or (lambda order_id: None)
+        self.bids = NativeBookSide(self, is_bid_side=True)
+        self.asks = NativeBookSide(self, is_bid_side=False)
+
+    def __del__(self):
+        handle = getattr(self, 'handle', None)
+        if handle:
+            self.lib.mc_book_destroy(handle)
+            self.handle = None
+
+    def add_order(self, order):
+        """Rest an order on the appropriate side without matching"""
+        if order.price_ticks is None:
+            self.prepare_order(order)
+        super().add_order(order)
+
+    def fill_uncrossed_order(self, order, quantity, price):
+        """Fill a resting order the core did not match (batch auction)"""
+        self.version += 1
+        order.fill(quantity, price)
+        if order.quantity > 0:
+            self.lib.mc_reduce(self.handle, order.order_id, order.quantity)
+
+    def process_batch(self, orders):
+        """
+        Match a batch of prepared orders in sequence
+
+        Returns:
+            tuple: (fills, rejected) where fills is a list of (taker_id,
+                maker_id, price_ticks, quantity, maker_remaining,
+                taker_remaining) tuples in match order and rejected lists the
+                orders the core ran out of memory for (left out of the book)
+        """
+        batch = (NativeOrder * len(orders))()
+        for native, order in zip(batch, orders):
+            native.order_id = order.order_id
+            native.price_ticks = order.price_ticks
+            native.quantity = order.quantity
+            native.side = NATIVE_BUY if order.side is OrderSide.BUY else NATIVE_SELL
+
+        self.version += 1
+        fill_count = self.lib.mc_process_batch(self.handle, batch, len(orders))
+        rejected = [order for native, order in zip(batch, orders)
+                    if native.rejected]
+        if fill_count == 0:
+            return [], rejected
+
+        fills = self.lib.mc_fill_buffer(self.handle)
+        return [(fill.taker_id, fill.maker_id, fill.price_ticks, fill.quantity,
+                 fill.maker_remaining, fill.taker_remaining)
+                for fill in fills[:fill_count]], rejected
+
+
+class NativeMatchingShard(MatchingShard):
+    """
+    Matching shard that hands each batch to the native core
+
+    Orders are grouped per symbol and matched with one native call per book;
+    Python then applies the returned fills to the Order objects, records
+    trades and notifies traders exactly as the Python shard does.
+    """
+
+    def _process_batch(self, orders):
+        """Match a drained batch through the native books"""
+        dequeue_ns = self.clock.monotonic_ns()
+        engine = self.engine
+        active_orders = self.active_orders
+        pending_releases = self.pending_releases
+        groups = {}  # orderbook -> orders in arrival order
+        timings = []  # (symbol, submit_ns, match_start_ns, match_end_ns)
+
+        with self.orders_lock:
+            for order in orders:
+                if not order.is_active() or order.quantity <= 0:
+                    pending_releases.append(order)
+                    continue
+                orderbook = engine.get_orderbook(order.symbol)
+                if not self._prepare(order, orderbook):
+                    continue
+                if self.journal is not None:
+                    self.journal.record_accept(order, orderbook,
+                                               self.clock.time_ns())
+                self._track(order)
+                auction = self.auctions.get(order.symbol) if self.auctions else None
+                if auction is not None:
+                    # Sealed until its batch is uncrossed (in Python, over
+                    # the native book)
+                    collect_ns = self.clock.monotonic_ns()
+                    if auction.is_due(collect_ns):
+                        # The batch's interval closed before this order
+                        # arrived; it belongs to the next one
+                        self._run_auction(orderbook, auction)
+                    if auction.collect(order, collect_ns):
+                        self._run_auction(orderbook, auction)
+                    if order.submit_time is not None:
+                        timings.append((order.symbol, order.submit_time,
+                                        collect_ns, self.clock.monotonic_ns()))
+                    continue
+                groups.setdefault(orderbook, []).append(order)
+                if self.market_data.active:
+                    # Rested or not, its level is re-read when published
+                    self._touch(orderbook, order.side, order.price_ticks)
+
+            for orderbook, group in groups.items():
+                match_start_ns = self.clock.monotonic_ns()
+                fills, rejected = orderbook.process_batch(group)
+                for (taker_id, maker_id, price_ticks, quantity,
+                     maker_remaining, taker_remaining) in fills:
+                    self._execute_trade(active_orders[taker_id],
+                                        active_orders[maker_id], quantity,
+                                        price_ticks, orderbook)
+
+                    if maker_remaining == 0:
+                        pending_releases.append(self._untrack(maker_id))
+                    if taker_remaining == 0:
+                        pending_releases.append(self._untrack(taker_id))
+                for order in rejected:
+                    # The core had no memory for it and left the book as it was
+                    self._untrack(order.order_id)
+                    order.cancel()
+                    if self.journal is not None:
+                        self.journal.record_cancel(order, orderbook,
+                                                   self.clock.time_ns())
+                    pending_releases.append(order)
+                    self.rejected_orders += 1
+                match_end_ns = self.clock.monotonic_ns()
+
+                # One native call matches the whole group, so its orders
+                # share the group's match window
+                timings.extend((order.symbol, order.submit_time,
+                                match_start_ns, match_end_ns)
+                               for order in group
+                               if order.submit_time is not None)
+            self._publish_market_data()
+
+        # Orders are recycled here, after their fills are delivered
+        self._flush_fills()
+
+        # Record per-stage latency
+        notify_end_ns = self.clock.monotonic_ns()
+        for symbol, submit_ns, match_start_ns, match_end_ns in timings:
+            self._record_latency(symbol, submit_ns, dequeue_ns, match_start_ns,
+                                 match_end_ns, notify_end_ns)
+
+        # Update statistics
+        self._update_processing_stats(len(orders))
@@ -1,6 +1,7 @@
+from collections import namedtuple
 from datetime import datetime
 from enum import Enum
-import uuid
+import time
 
 class OrderSide(Enum):
     """Enumeration for order sides"""
@@ -14,12 +15,47 @@ class OrderStatus(Enum):
     FILLED = "FILLED"
     CANCELLED = "CANCELLED"
 
+# Copy of an active order handed to other threads (the Order itself goes
+# back to the pool once it is done)
+OrderInfo = namedtuple('OrderInfo', 'order_id symbol side price leaves_quantity')
+
+# Offset from the monotonic clock to wall-clock time, used only when a
+# monotonic timestamp has to be shown as a datetime
+_WALL_CLOCK_OFFSET_NS = time.time_ns() - time.monotonic_ns()
+
+def monotonic_ns_to_datetime(timestamp_ns):
+    """Convert a monotonic nanosecond timestamp to a wall-clock datetime"""
+    return datetime.fromtimestamp(monotonic_ns_to_wall_ns(timestamp_ns) / 1e9)
+
+def datetime_to_monotonic_ns(value):
+    """Convert a wall-clock datetime to the monotonic nanosecond timeline"""
+    return wall_ns_to_monotonic_ns(int(value.timestamp() * 1e9))
+
+def monotonic_ns_to_wall_ns(timestamp_ns):
+    """Convert a monotonic nanosecond timestamp to epoch nanoseconds"""
+    return timestamp_ns + _WALL_CLOCK_OFFSET_NS
+
+def wall_ns_to_monotonic_ns(timestamp_ns):
+    """Convert epoch nanoseconds (int or integer array) to the monotonic timeline"""
+    return timestamp_ns - _WALL_CLOCK_OFFSET_NS
+
 class Order:
     """
     Represents a trading order in the system
+    
+    Orders use a fixed slot layout and keep running fill counters instead of
+    a list of fill dicts. The order_id is an integer assigned by the engine
+    on submission. Per-fill history is only kept when track_fills is set.
     """
     
-    def __init__(self, trader_id, symbol, side, quantity, price):
+    __slots__ = (
+        'order_id', 'trader_id', 'symbol', 'side', 'quantity',
+        'original_quantity', 'price', 'price_ticks', 'status',
+        'timestamp_ns', 'submit_time', 'filled_quantity', 'filled_notional',
+        'fills', 'level', 'prev_in_level', 'next_in_level', 'pooled'
+    )
+    
+    def __init__(self, trader_id, symbol, side, quantity, price, track_fills=False):
         """
         Initialize a new order
         
@@ -28,18 +64,44 @@ class Order:
             symbol (str): Trading symbol (e.g., 'AAPL')
             side (OrderSide): BUY or SELL
             quantity (int): Number of shares
-            price (float): Price per share
+            price (float): Price per share (snapped to the book's tick grid on entry)
+            track_fills (bool): Keep a per-fill history in self.fills
         """
-        self.order_id = str(uuid.uuid4())
+        self.pooled = False  # True when owned by an OrderPool
+        self.reset(trader_id, symbol, side, quantity, price, track_fills)
+    
+    def reset(self, trader_id, symbol, side, quantity, price, track_fills=False):
+        """Reinitialize every field so the object can be reused for a new order"""
+        self.order_id = None  # Assigned by the engine on submission
         self.trader_id = trader_id
         self.symbol = symbol
         self.side = side
         self.quantity = quantity
         self.original_quantity = quantity
         self.price = price
+        self.price_ticks = None  # Integer tick price, assigned by the order book
         self.status = OrderStatus.PENDING
-        self.timestamp = datetime.now()
-        self.fills = []  # List of partial fills
+        self.timestamp_ns = time.monotonic_ns()
+        self.submit_time = None  # Monotonic ns, set by the engine
+        
+        # Running fill totals
+        self.filled_quantity = 0
+        self.filled_notional = 0.0
+        self.fills = [] if track_fills else None  # Optional fill history
+        
+        # Intrusive links into the resting price level (set by the order book)
+        self.level = None
+        self.prev_in_level = None
+        self.next_in_level = None
+    
+    @property
+    def timestamp(self):
+        """Order creation time as a datetime"""
+        return monotonic_ns_to_datetime(self.timestamp_ns)
+    
+    @timestamp.setter
+    def timestamp(self, value):
+        self.timestamp_ns = datetime_to_monotonic_ns(value)
     
     def fill(self, quantity, price):
         """
@@ -53,12 +115,10 @@ class Order:
             raise ValueError("Fill quantity exceeds remaining order quantity")
         
         # Record the fill
-        fill = {
-            'quantity': quantity,
-            'price': price,
-            'timestamp': datetime.now()
-        }
-        self.fills.append(fill)
+        self.filled_quantity += quantity
+        self.filled_notional += quantity * price
+        if self.fills is not None:
+            self.fills.append((quantity, price, time.monotonic_ns()))
         
         # Update remaining quantity
         self.quantity -= quantity
@@ -69,35 +129,50 @@ class Order:
         else:
             self.status = OrderStatus.PARTIALLY_FILLED
     
+    def amend(self, quantity, price=None):
+        """
+        Change the remaining quantity and optionally the limit price
+        
+        The book must be updated by the caller (see OrderBookSide.reduce_order
+        and MatchingShard.amend_order); a new price clears price_ticks so the
+        order is re-snapped to the tick grid when it is re-queued.
+        
+        Args:
+            quantity (int): New remaining quantity
+            price (float): New limit price, or None to keep the current one
+        """
+        self.original_quantity = self.filled_quantity + quantity
+        self.quantity = quantity
+        if price is not None and price != self.price:
+            self.price = price
+            self.price_ticks = None
+    
     def cancel(self):
         """Cancel the order"""
-        if self.status in [OrderStatus.PENDING, OrderStatus.PARTIALLY_FILLED]:
+        if self.is_active():
             self.status = OrderStatus.CANCELLED
     
     def get_filled_quantity(self):
         """Get total filled quantity"""
-        return sum(fill['quantity'] for fill in self.fills)
+        return self.filled_quantity
     
     def get_average_fill_price(self):
         """Get average fill price"""
-        if not self.fills:
+        if self.filled_quantity == 0:
             return 0.0
-        
-        total_value = sum(fill['quantity'] * fill['price'] for fill in self.fills)
-        total_quantity = sum(fill['quantity'] for fill in self.fills)
-        
-        return total_value / total_quantity if total_quantity > 0 else 0.0
+        return self.filled_notional / self.filled_quantity
     
     def is_complete(self):
         """Check if order is completely filled"""
-        return self.status == OrderStatus.FILLED
+        return self.status is OrderStatus.FILLED
     
     def is_active(self):
         """Check if order is still active (can be filled)"""
-        return self.status in [OrderStatus.PENDING, OrderStatus.PARTIALLY_FILLED]
+        status = self.status
+        return status is OrderStatus.PENDING or status is OrderStatus.PARTIALLY_FILLED
     
     def __str__(self):
-        return (f"Order({self.order_id[:8]}, {self.trader_id}, "
+        return (f"Order({self.order_id}, {self.trader_id}, "
                 f"{self.symbol}, {self.side.value}, "
                 f"{self.quantity}@{self.price:.2f})")
     
@@ -114,7 +189,78 @@ class Order:
             'quantity': self.quantity,
             'original_quantity': self.original_quantity,
             'price': self.price,
+            'price_ticks': self.price_ticks,
             'status': self.status.value,
             'timestamp': self.timestamp,
-            'fills': self.fills
+            'filled_quantity': self.filled_quantity,
+            'average_fill_price': self.get_average_fill_price(),
+            'fills': [
+                {
+                    'quantity': quantity,
+                    'price': price,
+                    'timestamp': monotonic_ns_to_datetime(fill_ns)
+                }
+                for quantity, price, fill_ns in (self.fills or [])
+            ]
+        }
+
+class OrderPool:
+    """
+    Free-list of Order objects recycled by the engine
+    
+    Orders acquired from the pool are returned to it by the engine once they
+    are filled or cancelled, so callers must not keep references to them
+    after completion.
+    """
+    
+    def __init__(self, max_size=10000, track_fills=False):
+        """
+        Initialize the pool
+        
+        Args:
+            max_size (int): Maximum number of idle orders kept for reuse
+            track_fills (bool): Keep per-fill history on pooled orders
+        """
+        self.max_size = max_size
+        self.track_fills = track_fills
+        self.free_orders = []
+        
+        # Pool statistics
+        self.allocated = 0
+        self.reused = 0
+    
+    def acquire(self, trader_id, symbol, side, quantity, price):
+        """Get an order from the free-list, allocating only when it is empty"""
+        try:
+            order = self.free_orders.pop()
+            self.reused += 1
+        except IndexError:
+            order = Order.__new__(Order)
+            order.pooled = True
+            self.allocated += 1
+        order.reset(trader_id, symbol, side, quantity, price, self.track_fills)
+        return order
+    
+    def release(self, order):
+        """Return a completed order to the free-list"""
+        if not order.pooled or order.symbol is None:
+            return  # Not a pooled order, or already released
+        if len(self.free_orders) >= self.max_size:
+            return
+        
+        # Drop references so recycled orders don't keep other objects alive
+        order.trader_id = None
+        order.symbol = None
+        order.fills = None
+        order.level = None
+        order.prev_in_level = None
+        order.next_in_level = None
+        self.free_orders.append(order)
+    
+    def get_statistics(self):
+        """Get pool usage statistics"""
+        return {
+            'allocated': self.allocated,
+            'reused': self.reused,
+            'free': len(self.free_orders)
         }
@@ -0,0 +1,799 @@
+"""
+Network order-entry gateway
+
+External strategies and load generators connect over TCP, or optionally
+send UDP datagrams. They exchange fixed-size MESSAGE_SIZE little-endian
+messages, with no framing beyond the size.
+
+A session starts with LOGON, naming the trader that owns the session's
+orders; the gateway then routes that trader's fills to the session. Each
+NEW_ORDER is acked with the engine order ID once the gateway takes it, and
+its FILLs stream back over the same session. CANCEL and AMEND name the
+order by engine order ID, or by client order ID when order_id is 0; as
+with TradingEngine.cancel_order, only resting orders can be cancelled, so
+a cancel that overtakes matching is rejected.
+
+One network thread reads every session. The new orders decoded in one
+poll round, across all sessions, go into the engine's ingress rings with
+one submit_orders call. A CANCEL or AMEND first submits the orders that
+arrived before it, so each session's messages apply in the order sent.
+ACKs are written before their orders are submitted, so a FILL never
+overtakes its ACK. An order the ring rejects (overflow policy 'reject') is
+then CANCELLED with REASON_QUEUE_FULL, as submit_orders cancels such
+orders. A TCP client that stops reading is disconnected once more than
+max_send_backlog bytes of responses are waiting for it.
+"""
+import math
+import selectors
+import socket
+import struct
+import threading
+import time
+from collections import namedtuple
+
+from models.latency import LatencyHistogram
+from models.order import OrderSide
+
+MESSAGE_SIZE = 64
+
+# Request types (client -> gateway)
+LOGON = 1  # symbol field = trader_id
+NEW_ORDER = 2
+CANCEL = 3
+AMEND = 4
+LOGOUT = 5
+
+# Response types (gateway -> client)
+LOGON_ACK = 11
+ACK = 12  # aux = the request's client_time_ns
+REJECT = 13
+FILL = 14  # quantity = fill size, aux = trade sequence
+CANCELLED = 15
+AMENDED = 16
+
+# Reject and cancel reasons
+REASON_NONE = 0
+REASON_NOT_LOGGED_ON = 1
+REASON_BAD_MESSAGE = 2
+REASON_BAD_ORDER = 3  # Side, quantity or price out of range (or price band)
+REASON_UNKNOWN_ORDER = 4  # Not a resting order of this session
+REASON_TRADER_IN_USE = 5  # Another session is logged on as the trader
+REASON_QUEUE_FULL = 6  # The ingress ring rejected the order
+
+# type, side, reserved, client_order_id, order_id, quantity, price,
+# client_time_ns, symbol
+REQUEST = struct.Struct('<BB6xqqqdq16s')
+# type, side, reserved, reason, client_order_id, order_id, quantity,
+# leaves quantity, price, aux, timestamp_ns
+RESPONSE = struct.Struct('<BB2xIqqqqdqq')
+
+assert REQUEST.size == MESSAGE_SIZE and RESPONSE.size == MESSAGE_SIZE
+
+SIDES = (OrderSide.BUY, OrderSide.SELL)
+SIDE_CODES = {OrderSide.BUY: 0, OrderSide.SELL: 1}
+NO_QUANTITY = -1  # AMEND keeps the quantity
+NO_PRICE = math.nan  # AMEND keeps the price
+
+# Largest UDP payload sent in one datagram (whole messages)
+MAX_DATAGRAM = 1008 * MESSAGE_SIZE
+
+GatewayResponse = namedtuple('GatewayResponse', [
+    'type', 'side', 'reason', 'client_order_id', 'order_id', 'quantity',
+    'leaves_quantity', 'price', 'aux', 'timestamp_ns'
+])
+
+
+def _name(value):
+    """Decode a NUL-padded name field, or None if it is not valid UTF-8"""
+    try:
+        return value.rstrip(b'\0').decode()
+    except UnicodeDecodeError:
+        return None
+
+
+class GatewaySession:
+    """One logged-on (or connecting) client and its counters"""
+
+    def __init__(self, session_id, transport, peer, sock,
+                 max_send_backlog=1 << 22):
+        """
+        Initialize a session
+
+        Args:
+            session_id (int): Gateway-wide session number
+            transport (str): 'tcp' or 'udp'
+            peer: Remote address
+            sock: Connected TCP socket, or the gateway's UDP socket
+            max_send_backlog (int): Most unsent bytes kept for a TCP client
+                before it is treated as not reading and disconnected
+        """
+        self.session_id = session_id
+        self.transport = transport
+        self.peer = peer
+        self.sock = sock
+        self.max_send_backlog = max_send_backlog
+        self.trader_id = None
+        self.consumer_id = None
+        self.inbound = bytearray()  # Partial message bytes (TCP)
+        self.outbound = bytearray()  # Bytes the socket did not take yet (TCP)
+        self.lock = threading.Lock()  # Sends and the order maps
+        self.closed = False
+        self.overflowed = False  # Backlog exceeded; the network thread closes
+
+        # order_id -> [client_order_id, receive ns until the first fill,
+        # leaves quantity as of the latest ACK, FILL or AMENDED sent]
+        self.orders = {}
+        self.client_orders = {}  # client_order_id -> order_id
+
+        # Statistics
+        self.connected_ns = time.perf_counter_ns()
+        self.messages_in = 0
+        self.bytes_in = 0
+        self.bytes_out = 0
+        self.orders_in = 0
+        self.cancels_in = 0
+        self.amends_in = 0
+        self.rejects = 0
+        self.fills = 0
+        self.send_drops = 0  # UDP datagrams the socket refused
+        self.ingress_latency = LatencyHistogram()  # Received -> in the ring
+        self.fill_latency = LatencyHistogram()  # Received -> first fill sent
+
+    def send(self, data):
+        """
+        Send response bytes now, or keep what the socket did not take
+
+        Returns:
+            bool: True if the network thread has work for this session
+                (bytes left to write, or a backlog overflow to close)
+        """
+        with self.lock:
+            if self.closed or self.overflowed:
+                return False
+            self.bytes_out += len(data)
+            if self.transport == 'udp':
+                for start in range(0, len(data), MAX_DATAGRAM):
+                    try:
+                        self.sock.sendto(data[start:start + MAX_DATAGRAM],
+                                         self.peer)
+                    except OSError:
+                        self.send_drops += 1
+                return False
+            if not self.outbound:
+                try:
+                    sent = self.sock.send(data)
+                except BlockingIOError:
+                    sent = 0
+                except OSError:
+                    return False  # Peer gone; the reader closes the session
+                data = data[sent:]
+            self.outbound += data
+            if len(self.outbound) > self.max_send_backlog:
+                # The client stopped reading: drop what is queued rather
+                # than buffer without bound
+                self.outbound.clear()
+                self.overflowed = True
+                return True
+            return bool(self.outbound)
+
+    def flush(self):
+        """Write kept bytes (network thread); returns True if some remain"""
+        with self.lock:
+            if self.outbound and not self.closed:
+                try:
+                    sent = self.sock.send(self.outbound)
+                    del self.outbound[:sent]
+                except BlockingIOError:
+                    pass
+                except OSError:
+                    self.outbound.clear()
+            return bool(self.outbound)
+
+    def track(self, order_id, client_order_id, receive_ns, quantity):
+        with self.lock:
+            self.orders[order_id] = [client_order_id, receive_ns, quantity]
+            self.client_orders[client_order_id] = order_id
+
+    def untrack(self, order_id):
+        with self.lock:
+            entry = self.orders.pop(order_id, None)
+            if entry is not None and self.client_orders.get(entry[0]) == order_id:
+                del self.client_orders[entry[0]]
+            return entry
+
+    def get_statistics(self):
+        """Get throughput and latency counters"""
+        seconds = max(1e-9, (time.perf_counter_ns() - self.connected_ns) / 1e9)
+        return {
+            'session_id': self.session_id,
+            'transport': self.transport,
+            'peer': str(self.peer),
+            'trader_id': self.trader_id,
+            'connected_seconds': seconds,
+            'messages_in': self.messages_in,
+            'messages_per_second': self.messages_in / seconds,
+            'orders_in': self.orders_in,
+            'orders_per_second': self.orders_in / seconds,
+            'cancels_in': self.cancels_in,
+            'amends_in': self.amends_in,
+            'rejects': self.rejects,
+            'fills': self.fills,
+            'open_orders': len(self.orders),
+            'bytes_in': self.bytes_in,
+            'bytes_out': self.bytes_out,
+            'send_backlog_bytes': len(self.outbound),
+            'send_drops': self.send_drops,
+            'ingress_latency': self.ingress_latency.summary(),
+            'fill_latency': self.fill_latency.summary()
+        }
+
+
+class OrderGateway:
+    """TCP (and optional UDP) order entry in front of an engine"""
+
+    # Longest time the network thread blocks waiting for traffic
+    POLL_SECONDS = 0.01
+    RECV_BYTES = 1 << 18
+
+    def __init__(self, engine, host='127.0.0.1', port=0, udp_port=None,
+                 max_batch=4096, cancel_on_disconnect=False,
+                 max_send_backlog=1 << 22):
+        """
+        Open the listening sockets (nothing is served until start)
+
+        Args:
+            engine: TradingEngine (or PartitionedEngine) to submit to
+            host (str): Interface to listen on
+            port (int): TCP port (0 picks a free one, see self.port)
+            udp_port (int): Also accept datagrams on this port (None for
+                TCP only, 0 for a free port)
+            max_batch (int): Most new orders submitted in one call
+            cancel_on_disconnect (bool): Cancel a trader's resting orders
+                when its session ends
+            max_send_backlog (int): Most unsent response bytes per TCP
+                session; a client that lets more pile up is disconnected
+        """
+        self.engine = engine
+        self.max_batch = max_batch
+        self.cancel_on_disconnect = cancel_on_disconnect
+        self.max_send_backlog = max_send_backlog
+
+        self.selector = selectors.DefaultSelector()
+        self.listener = socket.create_server((host, port))
+        self.listener.setblocking(False)
+        self.host, self.port = self.listener.getsockname()[:2]
+        self.selector.register(self.listener, selectors.EVENT_READ, 'accept')
+
+        self.udp = None
+        self.udp_port = None
+        if udp_port is not None:
+            self.udp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            self.udp.bind((host, udp_port))
+            self.udp.setblocking(False)
+            self.udp_port = self.udp.getsockname()[1]
+            self.selector.register(self.udp, selectors.EVENT_READ, 'udp')
+
+        # Fill callbacks wake the network thread to write what a socket
+        # did not take
+        self.wake_reader, self.wake_writer = socket.socketpair()
+        self.wake_reader.setblocking(False)
+        self.wake_writer.setblocking(False)
+        self.selector.register(self.wake_reader, selectors.EVENT_READ, 'wake')
+
+        self.sessions = {}  # socket (TCP) or address (UDP) -> GatewaySession
+        self.trader_sessions = {}  # trader_id -> GatewaySession
+        self.backlogged = set()  # Sessions with unsent bytes
+        self.backlog_lock = threading.Lock()
+        self.session_ids = 0
+        # (session, order, client_order_id, client_time_ns, receive ns)
+        self.pending = []
+
+        # Statistics
+        self.sessions_opened = 0
+        self.sessions_closed = 0
+        self.slow_disconnects = 0  # Sessions closed for a full send backlog
+        self.batches_submitted = 0
+        self.orders_submitted = 0
+        self.largest_batch = 0
+
+        self.is_running = False
+        self.thread = None
+
+    def start(self):
+        """Start serving on the network thread"""
+        if not self.is_running:
+            self.is_running = True
+            self.thread = threading.Thread(target=self._run,
+                                           name="order-gateway",
+                                           daemon=True)
+            self.thread.start()
+
+    def stop(self):
+        """Stop serving and close every session and socket"""
+        self.is_running = False
+        self._wake()
+        if self.thread and self.thread.is_alive():
+            self.thread.join(timeout=2.0)
+        for session in list(self.sessions.values()):
+            self._close_session(session)
+        for sock in (self.listener, self.udp, self.wake_reader,
+                     self.wake_writer):
+            if sock is not None:
+                sock.close()
+        self.selector.close()
+
+    def _wake(self):
+        try:
+            self.wake_writer.send(b'\0')
+        except (BlockingIOError, OSError):
+            pass  # Already woken, or closing
+
+    def _run(self):
+        while self.is_running:
+            try:
+                for key, mask in self.selector.select(self.POLL_SECONDS):
+                    if key.data == 'accept':
+                        self._accept()
+                    elif key.data == 'udp':
+                        self._read_datagrams()
+                    elif key.data == 'wake':
+                        self._drain_wake()
+                    else:
+                        if mask & selectors.EVENT_READ:
+                            self._read(key.data)
+                        if mask & selectors.EVENT_WRITE:
+                            self._write(key.data)
+                self._submit_pending()
+                self._write_backlogged()
+            except Exception as e:
+                print(f"Error in order gateway: {e}")
+
+    def _new_session(self, transport, peer, sock):
+        self.session_ids += 1
+        self.sessions_opened += 1
+        return GatewaySession(self.session_ids, transport, peer, sock,
+                              self.max_send_backlog)
+
+    def _accept(self):
+        while True:
+            try:
+                sock, peer = self.listener.accept()
+            except BlockingIOError:
+                return
+            sock.setblocking(False)
+            sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            session = self._new_session('tcp', peer, sock)
+            self.sessions[sock] = session
+            self.selector.register(sock, selectors.EVENT_READ, session)
+
+    def _drain_wake(self):
+        try:
+            while self.wake_reader.recv(4096):
+                pass
+        except BlockingIOError:
+            pass
+
+    def _read(self, session):
+        try:
+            data = session.sock.recv(self.RECV_BYTES)
+        except BlockingIOError:
+            return
+        except OSError:
+            data = b''
+        if not data:
+            self._close_session(session)
+            return
+        receive_ns = time.perf_counter_ns()
+        session.bytes_in += len(data)
+        inbound = session.inbound
+        if inbound or len(data) % MESSAGE_SIZE:
+            # Reassemble messages split across reads
+            inbound += data
+            usable = len(inbound) - len(inbound) % MESSAGE_SIZE
+            data = bytes(inbound[:usable])
+            del inbound[:usable]
+        if data:
+            self._handle_messages(session, data, receive_ns)
+
+    def _read_datagrams(self):
+        while True:
+            try:
+                data, peer = self.udp.recvfrom(65536)
+            except BlockingIOError:
+                return
+            except OSError:
+                continue  # e.g. ICMP unreachable from an earlier send
+            receive_ns = time.perf_counter_ns()
+            session = self.sessions.get(peer)
+            if session is None:
+                session = self._new_session('udp', peer, self.udp)
+                self.sessions[peer] = session
+            session.bytes_in += len(data)
+            usable = len(data) - len(data) % MESSAGE_SIZE
+            self._handle_messages(session, memoryview(data)[:usable],
+                                  receive_ns)
+            if session.closed:
+                self.sessions.pop(peer, None)
+
+    def _handle_messages(self, session, data, receive_ns):
+        """Apply a run of whole request messages from one session"""
+        replies = []
+        for (kind, side, client_order_id, order_id, quantity, price,
+             client_time_ns, symbol) in REQUEST.iter_unpack(data):
+            session.messages_in += 1
+            if kind == NEW_ORDER and session.trader_id is not None:
+                name = _name(symbol)
+                if name is None:
+                    replies.append(self._reject(session, REASON_BAD_MESSAGE,
+                                                client_order_id, side))
+                    continue
+                if (side > 1 or quantity <= 0 or not price > 0
+                        or math.isinf(price) or not name
+                        or not self.engine.get_orderbook(
+                            name).price_in_band(price, SIDES[side])):
+                    replies.append(self._reject(session, REASON_BAD_ORDER,
+                                                client_order_id, side))
+                    continue
+                session.orders_in += 1
+                order = self.engine.create_order(session.trader_id, name,
+                                                 SIDES[side], quantity, price)
+                order.order_id = next(self.engine.order_ids)
+                self.pending.append((session, order, client_order_id,
+                                     client_time_ns, receive_ns))
+                if len(self.pending) >= self.max_batch:
+                    self._submit_pending()
+            elif kind == CANCEL and session.trader_id is not None:
+                session.cancels_in += 1
+                self._submit_pending()  # Orders sent before the cancel first
+                replies.append(self._cancel(session, client_order_id,
+                                            order_id))
+            elif kind == AMEND and session.trader_id is not None:
+                session.amends_in += 1
+                self._submit_pending()
+                replies.append(self._amend(session, client_order_id, order_id,
+                                           quantity, price))
+            elif kind == LOGON and session.trader_id is None:
+                name = _name(symbol)
+                replies.append(
+                    self._logon(session, name) if name is not None else
+                    self._reject(session, REASON_BAD_MESSAGE, client_order_id))
+            elif kind == LOGOUT:
+                self._submit_pending()
+                if replies:
+                    session.send(b''.join(replies))
+                self._close_session(session)
+                return
+            else:
+                reason = (REASON_NOT_LOGGED_ON if session.trader_id is None
+                          else REASON_BAD_MESSAGE)
+                replies.append(self._reject(session, reason, client_order_id,
+                                            side))
+        if replies:
+            self._send(session, b''.join(replies))
+
+    def _reject(self, session, reason, client_order_id, side=0,
+                order_id=0, kind=REJECT):
+        session.rejects += 1
+        return RESPONSE.pack(kind, side, reason, client_order_id, order_id,
+                             0, 0, 0.0, 0, time.time_ns())
+
+    def _logon(self, session, trader_id):
+        if not trader_id or trader_id in self.trader_sessions:
+            return self._reject(session, REASON_TRADER_IN_USE, 0)
+        session.trader_id = trader_id
+        session.consumer_id = f"gateway:{session.session_id}"
+        self.trader_sessions[trader_id] = session
+        self.engine.register_fill_consumer(
+            session.consumer_id,
+            lambda events: self._on_fills(session, events), [trader_id])
+        return RESPONSE.pack(LOGON_ACK, 0, REASON_NONE, 0, 0, 0, 0, 0.0,
+                             session.session_id, time.time_ns())
+
+    def _resolve(self, session, client_order_id, order_id):
+        """Engine ID of one of the session's orders, or None"""
+        if not order_id:
+            order_id = session.client_orders.get(client_order_id)
+        return order_id if order_id in session.orders else None
+
+    def _cancel(self, session, client_order_id, order_id):
+        order_id = self._resolve(session, client_order_id, order_id)
+        if order_id is None or not self.engine.cancel_order(order_id):
+            return self._reject(session, REASON_UNKNOWN_ORDER, client_order_id,
+                                order_id=order_id or 0)
+        entry = session.untrack(order_id)
+        return RESPONSE.pack(CANCELLED, 0, REASON_NONE,
+                             entry[0] if entry else client_order_id, order_id,
+                             0, 0, 0.0, 0, time.time_ns())
+
+    def _amend(self, session, client_order_id, order_id, quantity, price):
+        order_id = self._resolve(session, client_order_id, order_id)
+        quantity = None if quantity == NO_QUANTITY else quantity
+        price = None if math.isnan(price) else price
+        if (order_id is None or (quantity is None and price is None)
+                or (price is not None and not 0 < price < math.inf)):
+            return self._reject(session, REASON_UNKNOWN_ORDER, client_order_id,
+                                order_id=order_id or 0)
+        try:
+            amended = self.engine.amend_order(order_id, quantity, price)
+        except ValueError:
+            # Outside the book's price band; the order is unchanged
+            return self._reject(session, REASON_BAD_ORDER, client_order_id,
+                                order_id=order_id)
+        if not amended:
+            return self._reject(session, REASON_UNKNOWN_ORDER, client_order_id,
+                                order_id=order_id)
+        if quantity is not None and quantity <= 0:
+            session.untrack(order_id)  # Amended to nothing: cancelled
+            leaves = 0
+        else:
+            # A price-only amend keeps the leaves last reported on the
+            # session (FILLs sent after this one carry any later change)
+            with session.lock:
+                entry = session.orders.get(order_id)
+                if entry is not None and quantity is not None:
+                    entry[2] = quantity
+                leaves = entry[2] if entry is not None else quantity or 0
+        return RESPONSE.pack(AMENDED, 0, REASON_NONE, client_order_id,
+                             order_id, leaves, leaves, price or 0.0, 0,
+                             time.time_ns())
+
+    def _submit_pending(self):
+        """ACK the orders decoded so far, then submit them in one call"""
+        pending = self.pending
+        if not pending:
+            return
+        self.pending = []
+
+        # Track and ACK first, so fills (sent from the dispatcher thread)
+        # always follow the ACK on the session
+        acks = {}
+        now_ns = time.time_ns()
+        orders = []
+        for session, order, client_order_id, client_time_ns, receive_ns in pending:
+            session.track(order.order_id, client_order_id, receive_ns,
+                          order.quantity)
+            acks.setdefault(session, []).append(
+                RESPONSE.pack(ACK, SIDE_CODES[order.side], REASON_NONE,
+                              client_order_id, order.order_id, order.quantity,
+                              order.quantity, order.price, client_time_ns,
+                              now_ns))
+            orders.append(order)
+        for session, messages in acks.items():
+            self._send(session, b''.join(messages))
+
+        rejected_orders = []
+        self.engine.submit_orders(orders, rejected_orders)
+        submitted_ns = time.perf_counter_ns()
+        self.batches_submitted += 1
+        self.orders_submitted += len(orders)
+        if len(orders) > self.largest_batch:
+            self.largest_batch = len(orders)
+
+        for session, _, _, _, receive_ns in pending:
+            session.ingress_latency.record(submitted_ns - receive_ns)
+        if not rejected_orders:
+            return
+
+        # Only orders that never entered a ring may be read now (accepted
+        # ones may already be matched and recycled)
+        rejected_ids = {id(order) for order in rejected_orders}
+        rejected = {}
+        for session, order, client_order_id, _, _ in pending:
+            if id(order) in rejected_ids:
+                session.untrack(order.order_id)
+                rejected.setdefault(session, []).append(
+                    self._reject(session, REASON_QUEUE_FULL, client_order_id,
+                                 SIDE_CODES[order.side], order.order_id,
+                                 CANCELLED))
+        for session, messages in rejected.items():
+            self._send(session, b''.join(messages))
+
+    def _on_fills(self, session, events):
+        """Encode a batch of the session trader's fills (dispatcher thread)"""
+        now_ns = time.perf_counter_ns()
+        messages = []
+        for event in events:
+            with session.lock:
+                entry = session.orders.get(event.order_id)
+            if entry is None:
+                client_order_id = 0  # Order not placed through this session
+            else:
+                client_order_id = entry[0]
+                if entry[1] is not None:
+                    session.fill_latency.record(now_ns - entry[1])
+                    entry[1] = None
+                entry[2] = event.remaining_quantity
+                if event.remaining_quantity <= 0:
+                    session.untrack(event.order_id)
+            messages.append(
+                RESPONSE.pack(FILL, SIDE_CODES[event.side], REASON_NONE,
+                              client_order_id, event.order_id, event.quantity,
+                              event.remaining_quantity, event.price,
+                              event.trade_sequence, event.timestamp_ns))
+        session.fills += len(messages)
+        self._send(session, b''.join(messages))
+
+    def _send(self, session, data):
+        if session.send(data):
+            with self.backlog_lock:
+                self.backlogged.add(session)
+            if threading.current_thread() is not self.thread:
+                self._wake()
+
+    def _write_backlogged(self):
+        """Flush, and watch for writability on, sessions with unsent bytes"""
+        with self.backlog_lock:
+            if not self.backlogged:
+                return
+            backlogged = self.backlogged
+            self.backlogged = set()
+        for session in backlogged:
+            if session.closed:
+                continue
+            if session.overflowed:
+                self.slow_disconnects += 1
+                self._close_session(session)
+                continue
+            if session.flush():
+                self.selector.modify(session.sock,
+                                     selectors.EVENT_READ | selectors.EVENT_WRITE,
+                                     session)
+
+    def _write(self, session):
+        if not session.flush() and not session.closed:
+            self.selector.modify(session.sock, selectors.EVENT_READ, session)
+
+    def _close_session(self, session):
+        if session.closed:
+            return
+        with session.lock:
+            session.closed = True
+        self.sessions_closed += 1
+        if session.consumer_id is not None:
+            self.engine.unregister_fill_consumer(session.consumer_id)
+        if session.trader_id is not None:
+            if self.trader_sessions.get(session.trader_id) is session:
+                del self.trader_sessions[session.trader_id]
+            if self.cancel_on_disconnect:
+                self.engine.cancel_all(session.trader_id)
+        if session.transport == 'tcp':
+            self.sessions.pop(session.sock, None)
+            try:
+                self.selector.unregister(session.sock)
+            except (KeyError, ValueError):
+                pass
+            session.sock.close()
+        else:
+            self.sessions.pop(session.peer, None)
+
+    def get_statistics(self):
+        """Get gateway and per-session counters"""
+        return {
+            'host': self.host,
+            'port': self.port,
+            'udp_port': self.udp_port,
+            'sessions_open': len(self.sessions),
+            'sessions_opened': self.sessions_opened,
+            'sessions_closed': self.sessions_closed,
+            'slow_disconnects': self.slow_disconnects,
+            'batches_submitted': self.batches_submitted,
+            'orders_submitted': self.orders_submitted,
+            'average_batch': self.orders_submitted / max(1, self.batches_submitted),
+            'largest_batch': self.largest_batch,
+            'sessions': [session.get_statistics()
+                         for session in list(self.sessions.values())]
+        }
+
+
+class GatewayClient:
+    """Blocking TCP client for strategies and load generators"""
+
+    def __init__(self, host, port, trader_id, timeout=5.0):
+        """
+        Connect and log on
+
+        Args:
+            host (str): Gateway host
+            port (int): Gateway TCP port
+            trader_id (str): Trader the session trades as (up to 16 bytes)
+            timeout (float): Seconds to wait for the LOGON_ACK
+
+        Raises:
+            ConnectionError: If the gateway rejects the logon
+        """
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.inbound = bytearray()
+        self.outbox = []  # Encoded requests not yet sent
+        self.client_order_ids = 0
+        self.trader_id = trader_id
+
+        self.sock.sendall(REQUEST.pack(LOGON, 0, 0, 0, 0, 0.0, 0,
+                                       trader_id.encode()))
+        self.pending_responses = []
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            for response in self.poll(max(0.0, deadline - time.monotonic())):
+                if response.type == LOGON_ACK:
+                    self.session_id = response.aux
+                    return
+                if response.type == REJECT:
+                    self.sock.close()
+                    raise ConnectionError(
+                        f"Logon rejected (reason {response.reason})")
+        self.sock.close()
+        raise ConnectionError("No logon acknowledgement")
+
+    def new_order(self, symbol, side, quantity, price, client_order_id=None):
+        """
+        Queue a new order (sent by flush)
+
+        Returns:
+            int: The client order ID the gateway echoes back
+        """
+        if client_order_id is None:
+            self.client_order_ids += 1
+            client_order_id = self.client_order_ids
+        self.outbox.append(
+            REQUEST.pack(NEW_ORDER, SIDE_CODES[side], client_order_id, 0,
+                         quantity, price, time.perf_counter_ns(),
+                         symbol.encode()))
+        return client_order_id
+
+    def cancel(self, order_id=0, client_order_id=0):
+        """Queue a cancel by engine order ID (or client order ID)"""
+        self.outbox.append(REQUEST.pack(CANCEL, 0, client_order_id, order_id,
+                                        0, 0.0, time.perf_counter_ns(), b''))
+
+    def amend(self, order_id=0, quantity=None, price=None, client_order_id=0):
+        """Queue an amend; None keeps the quantity or price"""
+        self.outbox.append(
+            REQUEST.pack(AMEND, 0, client_order_id, order_id,
+                         NO_QUANTITY if quantity is None else quantity,
+                         NO_PRICE if price is None else price,
+                         time.perf_counter_ns(), b''))
+
+    def flush(self):
+        """Send every queued request in one write"""
+        if self.outbox:
+            self.sock.sendall(b''.join(self.outbox))
+            self.outbox = []
+
+    def poll(self, timeout=0.0):
+        """
+        Read responses that have arrived
+
+        Args:
+            timeout (float): Seconds to wait for the first bytes
+
+        Returns:
+            list: GatewayResponse per message, in arrival order
+        """
+        responses = self.pending_responses
+        self.pending_responses = []
+        self.sock.settimeout(timeout if timeout > 0 else 0.0)
+        try:
+            while True:
+                data = self.sock.recv(1 << 18)
+                if not data:
+                    break
+                self.inbound += data
+                self.sock.settimeout(0.0)
+        except (BlockingIOError, socket.timeout):
+            pass
+        usable = len(self.inbound) - len(self.inbound) % MESSAGE_SIZE
+        if usable:
+            data = bytes(self.inbound[:usable])
+            del self.inbound[:usable]
+            responses.extend(map(GatewayResponse._make,
+                                 RESPONSE.iter_unpack(data)))
+        return responses
+
+    def close(self):
+        """Log out and disconnect"""
+        try:
+            self.flush()
+            self.sock.sendall(REQUEST.pack(LOGOUT, 0, 0, 0, 0, 0.0, 0, b''))
+        except OSError:
+            pass
+        self.sock.close()
@@ -1,164 +1,826 @@
-import heapq
-from collections import defaultdict, deque
+from collections import namedtuple
 from datetime import datetime
+from decimal import Decimal
+import heapq
+import math
 import threading
 
 from models.order import Order, OrderSide, OrderStatus
+from models.trade_tape import TradeTape
+from models.bars import SymbolBars
+from models.depth_index import DepthIndex
+
+# Ticks in each side's dense window around the touch (a multiple of 64,
+# the occupancy bitmap's word size); levels beyond it are kept sparsely
+LADDER_WINDOW = 4096
+
+# Default minimum price increment (matches the 2-decimal prices traders quote)
+DEFAULT_TICK_SIZE = 0.01
+
+# Trades retained per symbol, and how many of the latest feed the running VWAP
+TRADE_TAPE_CAPACITY = 1000
+TRADE_VWAP_WINDOW = 5
+
+# Result of a sweep-cost query: quantity the book can fill, its total cost,
+# the average fill price and the worst level's price (None if nothing fills)
+Sweep = namedtuple('Sweep', 'quantity notional average_price worst_price')
+
+# Top of a published book side (a level, not an individual order)
+BookTop = namedtuple('BookTop', 'price price_ticks quantity order_count')
+
+class TickScale:
+    """
+    Fixed-point conversion between float prices and integer ticks
+    
+    The book stores and compares prices as integer ticks; floats only
+    appear at the edges (order entry, trade records and displays).
+    """
+    
+    __slots__ = ('tick_size', 'decimals')
+    
+    def __init__(self, tick_size=DEFAULT_TICK_SIZE):
+        """
+        Initialize a tick scale
+        
+        Args:
+            tick_size (float): Minimum price increment
+        """
+        if tick_size <= 0:
+            raise ValueError("Tick size must be positive")
+        self.tick_size = tick_size
+        self.decimals = max(0, -Decimal(str(tick_size)).as_tuple().exponent)
+    
+    def to_ticks(self, price):
+        """Convert a price to the nearest tick"""
+        return int(round(price / self.tick_size))
+    
+    def to_ticks_for_side(self, price, side):
+        """
+        Convert a limit price to ticks without making it more aggressive
+        
+        Off-tick buy prices round down and off-tick sell prices round up.
+        
+        Raises:
+            ValueError: If the price is NaN or infinite
+        """
+        exact = price / self.tick_size
+        if not math.isfinite(exact):
+            raise ValueError(f"Price {price} is not a finite number")
+        nearest = round(exact)
+        if abs(exact - nearest) < 1e-9:
+            return int(nearest)
+        if side == OrderSide.BUY:
+            return int(math.floor(exact))
+        return int(math.ceil(exact))
+    
+    def to_price(self, ticks):
+        """Convert ticks back to a float price"""
+        return round(ticks * self.tick_size, self.decimals)
+
+class PriceLevel:
+    """
+    FIFO queue of resting orders at a single price tick
+    
+    Orders are linked intrusively through their level/prev_in_level/
+    next_in_level attributes, so any order can unlink itself in O(1). The
+    level keeps its total resting quantity and order count up to date.
+    """
+    
+    __slots__ = ('price', 'tick', 'head', 'tail', 'order_count', 'total_quantity')
+    
+    def __init__(self, price, tick):
+        """
+        Initialize an empty price level
+        
+        Args:
+            price (float): Display price of this level
+            tick (int): Price of this level in ticks
+        """
+        self.price = price
+        self.tick = tick
+        self.head = None  # Oldest order (first to match)
+        self.tail = None  # Newest order
+        self.order_count = 0
+        self.total_quantity = 0
+    
+    def append(self, order):
+        """Append an order to the back of the queue"""
+        order.level = self
+        order.prev_in_level = self.tail
+        order.next_in_level = None
+        if self.tail is not None:
+            self.tail.next_in_level = order
+        else:
+            self.head = order
+        self.tail = order
+        self.order_count += 1
+        self.total_quantity += order.quantity
+    
+    def unlink(self, order):
+        """Remove an order from anywhere in the queue"""
+        prev_order = order.prev_in_level
+        next_order = order.next_in_level
+        
+        if prev_order is not None:
+            prev_order.next_in_level = next_order
+        else:
+            self.head = next_order
+        
+        if next_order is not None:
+            next_order.prev_in_level = prev_order
+        else:
+            self.tail = prev_order
+        
+        order.level = None
+        order.prev_in_level = None
+        order.next_in_level = None
+        self.order_count -= 1
+        self.total_quantity -= order.quantity
+    
+    def is_empty(self):
+        """Check if the level has no resting orders"""
+        return self.head is None
+    
+    def __iter__(self):
+        order = self.head
+        while order is not None:
+            yield order
+            order = order.next_in_level
+    
+    def __len__(self):
+        return self.order_count
 
 class OrderBookSide:
     """
     Represents one side of an order book (bids or asks)
+    
+    Price levels near the touch live in a contiguous tick-indexed window of
+    LADDER_WINDOW ticks, with a cursor pointing at the best non-empty level
+    and an occupancy bitmap (one bit per tick, plus one bit per non-empty
+    64-tick word) that finds the next non-empty level in O(1). Levels
+    outside the window are kept sparsely in a dict with a heap over their
+    ticks, so a stray far price costs one entry rather than a ladder
+    reaching it. Far levels are always worse than every level in the
+    window: a better price outside it moves the window there, and so does
+    the window emptying while far levels remain.
+    
+    Level and side totals are updated on add, fill and cancel, so queries
+    never re-sum resting orders. Sweep queries use a cumulative DepthIndex
+    over the window built on first use; afterwards each change only queues
+    a level delta for it.
+    
+    A side has a single writer, the matching thread that owns its book, and
+    takes no locks: every method assumes the caller is that thread or holds
+    the book's lock. Other threads read through OrderBook.
     """
     
-    def __init__(self, is_bid_side=True):
+    def __init__(self, is_bid_side=True, tick_scale=None):
         """
         Initialize order book side
         
         Args:
             is_bid_side (bool): True for bid side (buy orders), False for ask side (sell orders)
+            tick_scale (TickScale): Price/tick conversion shared with the book
         """
         self.is_bid_side = is_bid_side
-        self.price_levels = {}  # price -> list of orders
-        self.price_heap = []  # Priority queue for prices
+        self.tick_scale = tick_scale or TickScale()
+        self.levels = []  # window index -> PriceLevel (None when empty)
+        self.base_tick = 0  # Tick stored at levels[0]
+        self.best_index = -1  # Window index of the best level, -1 when empty
+        self.occupied = []  # 64-tick words of the window, bit set per level
+        self.occupied_words = 0  # Bit per non-zero word of occupied
+        self.far_levels = {}  # tick -> PriceLevel outside the window
+        self.far_heap = []  # Far ticks, best first (negated for bids); lazy
+        self.level_count = 0  # Number of non-empty price levels
+        self.total_volume = 0  # Resting quantity across all levels
         self.orders = {}  # order_id -> order mapping
-        self.lock = threading.Lock()
+        self.depth = None  # DepthIndex once a sweep query has run
+
+    def _place_window(self, best_tick):
+        """
+        Centre the window on best_tick, moving levels in or out of it
+        
+        O(levels + LADDER_WINDOW); runs only when the touch leaves the window.
+        """
+        levels = [level for level in self.levels if level is not None]
+        levels.extend(self.far_levels.values())
+        
+        self.base_tick = best_tick - LADDER_WINDOW // 2
+        self.levels = [None] * LADDER_WINDOW
+        self.occupied = [0] * (LADDER_WINDOW // 64)
+        self.occupied_words = 0
+        self.far_levels = {}
+        self.far_heap = []
+        self.depth = None  # Rebuilt over the new window when next queried
+        for level in levels:
+            index = level.tick - self.base_tick
+            if 0 <= index < LADDER_WINDOW:
+                self.levels[index] = level
+                self._mark(index)
+            else:
+                self._add_far(level)
+        self.best_index = best_tick - self.base_tick if levels else -1
+    
+    def _mark(self, index):
+        word = index >> 6
+        bits = self.occupied[word]
+        if not bits:
+            self.occupied_words |= 1 << word
+        self.occupied[word] = bits | (1 << (index & 63))
+    
+    def _unmark(self, index):
+        word = index >> 6
+        bits = self.occupied[word] & ~(1 << (index & 63))
+        self.occupied[word] = bits
+        if not bits:
+            self.occupied_words &= ~(1 << word)
+    
+    def _next_index(self, index):
+        """Window index of the next non-empty level worse than index, or -1"""
+        occupied = self.occupied
+        word = index >> 6
+        if self.is_bid_side:
+            # Highest set bit below index
+            bits = occupied[word] & ((1 << (index & 63)) - 1)
+            if not bits:
+                words = self.occupied_words & ((1 << word) - 1)
+                if not words:
+                    return -1
+                word = words.bit_length() - 1
+                bits = occupied[word]
+            return (word << 6) + bits.bit_length() - 1
+        # Lowest set bit above index
+        bits = occupied[word] & -(2 << (index & 63))
+        if not bits:
+            words = self.occupied_words & -(2 << word)
+            if not words:
+                return -1
+            word = (words & -words).bit_length() - 1
+            bits = occupied[word]
+        return (word << 6) + (bits & -bits).bit_length() - 1
+    
+    def _add_far(self, level):
+        self.far_levels[level.tick] = level
+        heapq.heappush(self.far_heap,
+                       -level.tick if self.is_bid_side else level.tick)
+    
+    def _remove_far(self, level):
+        del self.far_levels[level.tick]
+        if len(self.far_heap) > 2 * len(self.far_levels) + 64:
+            # Drop the entries of removed levels before they pile up
+            self.far_heap = [-tick if self.is_bid_side else tick
+                             for tick in self.far_levels]
+            heapq.heapify(self.far_heap)
+    
+    def _best_far_tick(self):
+        """Best far tick, discarding heap entries of removed levels"""
+        heap = self.far_heap
+        while heap:
+            tick = -heap[0] if self.is_bid_side else heap[0]
+            if tick in self.far_levels:
+                return tick
+            heapq.heappop(heap)
+        return None
+    
+    def _is_better(self, tick, other_tick):
+        return tick > other_tick if self.is_bid_side else tick < other_tick
+    
+    def _find_level(self, tick):
+        """Get the level at a tick, in or outside the window"""
+        index = tick - self.base_tick
+        if 0 <= index < len(self.levels):
+            return self.levels[index]
+        return self.far_levels.get(tick)
+    
+    def _best_level(self):
+        """Get the best non-empty level"""
+        if self.best_index < 0:
+            return None
+        return self.levels[self.best_index]
+    
+    def _advance_best(self):
+        """Move the best cursor to the next level after the best level empties"""
+        index = self._next_index(self.best_index)
+        if index >= 0:
+            self.best_index = index
+        elif self.far_levels:
+            # Window exhausted: bring it to the best far level
+            self._place_window(self._best_far_tick())
+        else:
+            self.best_index = -1
+    
+    def _iter_levels(self):
+        """Iterate non-empty levels from best to worst"""
+        if self.best_index < 0:
+            return
+        
+        levels = self.levels
+        index = self.best_index
+        while index >= 0:
+            yield levels[index]
+            index = self._next_index(index)
+        if self.far_levels:
+            far_levels = self.far_levels
+            for tick in sorted(far_levels, reverse=self.is_bid_side):
+                yield far_levels[tick]
     
     def add_order(self, order):
         """Add an order to this side of the book"""
-        with self.lock:
-            price = order.price
-            
-            # Add to price level
-            if price not in self.price_levels:
-                self.price_levels[price] = deque()
-                # For bids: higher prices have higher priority (max heap)
-                # For asks: lower prices have higher priority (min heap)
-                if self.is_bid_side:
-                    heapq.heappush(self.price_heap, -price)  # Negative for max heap
-                else:
-                    heapq.heappush(self.price_heap, price)   # Positive for min heap
-            
-            self.price_levels[price].append(order)
-            self.orders[order.order_id] = order
-    
+        tick = order.price_ticks
+        if not self.levels:
+            self._place_window(tick)
+        
+        index = tick - self.base_tick
+        in_window = 0 <= index < LADDER_WINDOW
+        if not in_window:
+            level = self.far_levels.get(tick)
+            if level is None and (self.best_index < 0 or self._is_better(
+                    tick, self.base_tick + self.best_index)):
+                # A new touch outside the window: move the window to it
+                self._place_window(tick)
+                index = tick - self.base_tick
+                in_window = True
+                self.best_index = -1  # Set below when the level is created
+        
+        if in_window:
+            level = self.levels[index]
+            if level is None:
+                level = PriceLevel(self.tick_scale.to_price(tick), tick)
+                self.levels[index] = level
+                self._mark(index)
+                self.level_count += 1
+                
+                # For bids: higher prices have higher priority
+                # For asks: lower prices have higher priority
+                if self.best_index < 0:
+                    self.best_index = index
+                elif self.is_bid_side and index > self.best_index:
+                    self.best_index = index
+                elif not self.is_bid_side and index < self.best_index:
+                    self.best_index = index
+        elif level is None:
+            level = PriceLevel(self.tick_scale.to_price(tick), tick)
+            self._add_far(level)
+            self.level_count += 1
+        
+        level.append(order)
+        self.orders[order.order_id] = order
+        self.total_volume += order.quantity
+        if self.depth is not None:
+            self._queue_depth_change(tick, order.quantity)
+
     def remove_order(self, order_id):
         """Remove an order from this side of the book"""
-        with self.lock:
-            if order_id not in self.orders:
-                return False
-            
-            order = self.orders[order_id]
-            price = order.price
-            
-            # Remove from price level
-            if price in self.price_levels:
-                try:
-                    self.price_levels[price].remove(order)
-                    if not self.price_levels[price]:
-                        # Remove empty price level
-                        del self.price_levels[price]
-                        # Note: We don't remove from heap for efficiency
-                        # The heap cleanup happens in get_best_price()
-                except ValueError:
-                    pass  # Order not in deque
-            
-            # Remove from orders mapping
-            del self.orders[order_id]
-            return True
+        order = self.orders.pop(order_id, None)
+        if order is None:
+            return False
+        
+        self.total_volume -= order.quantity
+        level = order.level
+        if level is not None:
+            if self.depth is not None:
+                self._queue_depth_change(level.tick, -order.quantity)
+            level.unlink(order)
+            if level.is_empty():
+                # Remove empty price level
+                self.level_count -= 1
+                index = level.tick - self.base_tick
+                if 0 <= index < LADDER_WINDOW:
+                    self.levels[index] = None
+                    self._unmark(index)
+                    if index == self.best_index:
+                        self._advance_best()
+                else:
+                    self._remove_far(level)
+        
+        return True
+    
+    def fill_order(self, order, quantity, price):
+        """Fill part of a resting order and update the level/side totals"""
+        order.fill(quantity, price)
+        self.total_volume -= quantity
+        if order.level is not None:
+            order.level.total_quantity -= quantity
+            if self.depth is not None:
+                self._queue_depth_change(order.level.tick, -quantity)
+
+    def reduce_order(self, order, quantity):
+        """
+        Shrink a resting order in place, keeping its queue position
+        
+        Returns:
+            bool: False if the order is not resting on this side or the new
+                quantity is not strictly between 0 and the current quantity
+        """
+        if order.order_id not in self.orders or not 0 < quantity < order.quantity:
+            return False
+        delta = order.quantity - quantity
+        order.amend(quantity)
+        self.total_volume -= delta
+        if order.level is not None:
+            order.level.total_quantity -= delta
+            if self.depth is not None:
+                self._queue_depth_change(order.level.tick, -delta)
+        return True
+    
+    def _queue_depth_change(self, tick, delta):
+        """Queue a level change for the depth index"""
+        if not 0 <= tick - self.base_tick < LADDER_WINDOW:
+            return  # Far levels are swept from far_levels directly
+        pending = self.depth.pending
+        pending.append((tick, delta))
+        if len(pending) > self.depth.size:
+            self.depth = None  # Not queried for a while: rebuild when it is
+    
+    def _depth_index(self):
+        """Get the depth index with every change applied"""
+        depth = self.depth
+        if depth is None or len(depth.pending) > depth.size // 4:
+            depth = self.depth = DepthIndex(self.levels, self.base_tick,
+                                            self.is_bid_side)
+        elif depth.pending:
+            depth.apply_pending()
+        return depth
+    
+    def sweep(self, quantity, limit_tick=None):
+        """
+        Take quantity from the best level outwards, stopping at limit_tick
+        
+        Args:
+            quantity (int): Quantity to take
+            limit_tick (int): Worst tick to take from (None for no limit)
+        
+        Returns:
+            tuple: (filled quantity, notional in ticks, last tick taken from
+                or None if nothing fills)
+        """
+        result = self._depth_index().sweep(quantity, limit_tick)
+        if self.far_levels and result[0] < quantity:
+            result = self._sweep_far(result, quantity, limit_tick)
+        return result
+    
+    def sweep_many(self, quantities, limit_tick=None):
+        """sweep() for several quantities against one state of the side"""
+        sweep = self._depth_index().sweep
+        results = [sweep(quantity, limit_tick) for quantity in quantities]
+        if self.far_levels:
+            results = [self._sweep_far(result, quantity, limit_tick)
+                       if result[0] < quantity else result
+                       for result, quantity in zip(results, quantities)]
+        return results
     
+    def _sweep_far(self, result, quantity, limit_tick):
+        """Continue a sweep of the whole window into the far levels"""
+        filled, notional, last_tick = result
+        far_levels = self.far_levels
+        for tick in sorted(far_levels, reverse=self.is_bid_side):
+            if limit_tick is not None and self._is_better(limit_tick, tick):
+                break
+            take = min(quantity - filled, far_levels[tick].total_quantity)
+            if take <= 0:
+                continue
+            filled += take
+            notional += take * tick
+            last_tick = tick
+            if filled >= quantity:
+                break
+        return filled, notional, last_tick
+
     def get_best_price(self):
         """Get the best price on this side"""
-        with self.lock:
-            # Clean up heap - remove prices that no longer have orders
-            while self.price_heap:
-                if self.is_bid_side:
-                    price = -self.price_heap[0]  # Convert back from negative
-                else:
-                    price = self.price_heap[0]
-                
-                if price in self.price_levels and self.price_levels[price]:
-                    return price
-                else:
-                    heapq.heappop(self.price_heap)
-            
-            return None
+        level = self._best_level()
+        return level.price if level is not None else None
+    
+    def get_best_tick(self):
+        """Get the best price on this side in ticks"""
+        level = self._best_level()
+        return level.tick if level is not None else None
     
     def get_best_order(self):
         """Get the best order (first order at best price)"""
-        with self.lock:
-            best_price = self.get_best_price()
-            if best_price and best_price in self.price_levels:
-                if self.price_levels[best_price]:
-                    return self.price_levels[best_price][0]
-            return None
+        level = self._best_level()
+        return level.head if level is not None else None
     
     def get_orders_at_price(self, price):
         """Get all orders at a specific price level"""
-        with self.lock:
-            return list(self.price_levels.get(price, []))
+        level = self._find_level(self.tick_scale.to_ticks(price))
+        return list(level) if level is not None else []
     
-    def get_top_levels(self, num_levels):
-        """Get top N price levels with their orders"""
-        with self.lock:
-            levels = []
-            prices_seen = set()
-            
-            # Create a copy of heap for iteration
-            heap_copy = self.price_heap[:]
-            
-            while heap_copy and len(levels) < num_levels:
-                if self.is_bid_side:
-                    price = -heapq.heappop(heap_copy)
-                else:
-                    price = heapq.heappop(heap_copy)
-                
-                if price in prices_seen:
-                    continue
-                    
-                prices_seen.add(price)
-                
-                if price in self.price_levels and self.price_levels[price]:
-                    # Aggregate orders at this price level
-                    orders = list(self.price_levels[price])
-                    total_quantity = sum(order.quantity for order in orders)
-                    
-                    levels.append({
-                        'price': price,
-                        'quantity': total_quantity,
-                        'order_count': len(orders),
-                        'orders': orders
-                    })
+    def get_top_levels(self, num_levels, include_orders=True):
+        """
+        Get top N price levels with their orders
+        
+        Args:
+            num_levels (int): Maximum number of levels to return
+            include_orders (bool): Copy each level's resting orders into
+                'orders'; without them the cost is O(num_levels)
+        """
+        levels = []
+        
+        for level in self._iter_levels():
+            if len(levels) >= num_levels:
+                break
             
-            return levels
+            levels.append({
+                'price': level.price,
+                'price_ticks': level.tick,
+                'quantity': level.total_quantity,
+                'order_count': level.order_count,
+                'orders': list(level) if include_orders else []
+            })
+        
+        return levels
+    
+    def get_resting_orders(self):
+        """Get every resting order in priority order (best level first, FIFO within a level)"""
+        return [order for level in self._iter_levels() for order in level]
+    
+    def get_volume_at_tick(self, tick):
+        """Get total resting quantity at a tick"""
+        level = self._find_level(tick)
+        return level.total_quantity if level is not None else 0
+    
+    def get_levels_at(self, ticks):
+        """
+        Get the aggregate of each of several levels
+        
+        Args:
+            ticks (list): Prices in ticks
+        
+        Returns:
+            list: (total quantity, order count) per tick, (0, 0) where empty
+        """
+        totals = []
+        for tick in ticks:
+            level = self._find_level(tick)
+            if level is None:
+                totals.append((0, 0))
+            else:
+                totals.append((level.total_quantity, level.order_count))
+        return totals
     
     def get_total_volume(self):
         """Get total volume on this side"""
-        with self.lock:
-            return sum(order.quantity for order in self.orders.values())
+        return self.total_volume
+    
+    def get_level_count(self):
+        """Get the number of non-empty price levels"""
+        return self.level_count
+    
+    def get_order_count(self):
+        """Get the number of resting orders"""
+        return len(self.orders)
+
+class PublishedBookSide:
+    """
+    Read-only OrderBookSide query API over published top levels
+
+    Answers from levels copied out of a book (by a StatsSurface, or from a
+    partition's stats block) without touching the book or its lock.
+    Individual resting orders are not visible; get_best_order returns the
+    top level as a BookTop. Only the top levels are known, so callers ask
+    covers() before answering a query that reaches deeper.
+    """
+
+    def __init__(self, is_bid_side, levels, totals):
+        """
+        Initialize the side view
+
+        Args:
+            is_bid_side (bool): True for bids, False for asks
+            levels (list): Level dicts (price, price_ticks, quantity,
+                order_count), best first
+            totals (tuple): (levels, orders, volume) of the whole side
+        """
+        self.is_bid_side = is_bid_side
+        self.levels = levels
+        self.totals = totals
+
+    def covers(self, tick=None):
+        """Whether every level at tick or better is published (None: every level)"""
+        levels = self.levels
+        if len(levels) >= self.totals[0]:
+            return True
+        if tick is None or not levels:
+            return False
+        last = levels[-1]['price_ticks']
+        return last <= tick if self.is_bid_side else last >= tick
+
+    def get_best_tick(self):
+        """Get the best price on this side in ticks"""
+        levels = self.levels
+        return levels[0]['price_ticks'] if levels else None
+
+    def get_best_price(self):
+        """Get the best price on this side"""
+        levels = self.levels
+        return levels[0]['price'] if levels else None
+
+    def get_best_order(self):
+        """Get the best level as a BookTop (price, quantity, order count)"""
+        levels = self.levels
+        if not levels:
+            return None
+        level = levels[0]
+        return BookTop(level['price'], level['price_ticks'], level['quantity'],
+                       level['order_count'])
+
+    def get_orders_at_price(self, price):
+        """Resting orders are not published"""
+        return []
+
+    def get_top_levels(self, num_levels, include_orders=True):
+        """Get top N published levels (without orders)"""
+        return [dict(level, orders=[]) for level in self.levels[:num_levels]]
+
+    def get_resting_orders(self):
+        """Resting orders are not published"""
+        return []
+
+    def sweep_many(self, quantities, limit_tick=None):
+        """
+        Sweep the published levels for each quantity (see
+        OrderBookSide.sweep); beyond them the book looks empty, so check
+        covers(limit_tick) for sizes they do not fill
+        """
+        is_bid_side = self.is_bid_side
+        levels = [(level['price_ticks'], level['quantity'])
+                  for level in self.levels
+                  if limit_tick is None or (level['price_ticks'] >= limit_tick
+                                            if is_bid_side else
+                                            level['price_ticks'] <= limit_tick)]
+        results = []
+        for quantity in quantities:
+            taken = notional = 0
+            last_tick = None
+            for tick, available in levels:
+                if taken >= quantity:
+                    break
+                take = min(quantity - taken, available)
+                taken += take
+                notional += take * tick
+                last_tick = tick
+            results.append((taken, notional, last_tick))
+        return results
+
+    def sweep(self, quantity, limit_tick=None):
+        """Sweep the published levels (see sweep_many)"""
+        return self.sweep_many([quantity], limit_tick)[0]
+
+    def get_volume_at_tick(self, tick):
+        """Get total resting quantity at a published tick"""
+        for level in self.levels:
+            if level['price_ticks'] == tick:
+                return level['quantity']
+        return 0
+
+    def get_levels_at(self, ticks):
+        """Get (total quantity, order count) at each published tick"""
+        levels = {
+            level['price_ticks']: (level['quantity'], level['order_count'])
+            for level in self.levels
+        }
+        return [levels.get(tick, (0, 0)) for tick in ticks]
+
+    def get_total_volume(self):
+        """Get total volume on this side"""
+        return self.totals[2]
+
+    def get_level_count(self):
+        """Get the number of non-empty price levels"""
+        return self.totals[0]
+
+    def get_order_count(self):
+        """Get the number of resting orders"""
+        return self.totals[1]
 
 class OrderBook:
     """
     Complete order book for a trading symbol
+    
+    The book is changed only by the thread that owns it (its shard's
+    matching thread, or a caller holding that shard's orders_lock); add,
+    remove, fill and reduce take no locks. Queries made here are for other
+    threads. While a StatsSurface publishes the book's top levels (see
+    publish_levels) they are answered from its latest copy without any
+    lock, up to one publish interval old; a query the copy is too shallow
+    for, or any query before the first publish, holds self.lock, the
+    owner's lock, and sees the book between matching passes. Owner code
+    queries the sides directly.
     """
     
-    def __init__(self, symbol):
+    def __init__(self, symbol, tick_size=DEFAULT_TICK_SIZE, lock=None,
+                 price_band=None):
         """
         Initialize order book for a symbol
         
         Args:
             symbol (str): Trading symbol (e.g., 'AAPL')
+            tick_size (float): Minimum price increment for this symbol
+            lock: Lock the owner holds while changing the book (its shard's
+                orders_lock); None for a private lock
+            price_band (float): Largest distance of a limit price from the
+                last trade, as a fraction of it (None, the default, for no
+                band)
         """
+        if price_band is not None and not price_band > 0:
+            raise ValueError("price_band must be positive or None")
         self.symbol = symbol
-        self.bids = OrderBookSide(is_bid_side=True)   # Buy orders
-        self.asks = OrderBookSide(is_bid_side=False)  # Sell orders
-        self.trade_history = deque(maxlen=1000)  # Recent trades
-        self.lock = threading.Lock()
+        self.price_band = price_band
+        self.tick_scale = TickScale(tick_size)
+        self.tick_size = self.tick_scale.tick_size
+        self.bids = OrderBookSide(is_bid_side=True, tick_scale=self.tick_scale)   # Buy orders
+        self.asks = OrderBookSide(is_bid_side=False, tick_scale=self.tick_scale)  # Sell orders
+        self.trade_tape = TradeTape(symbol, self.tick_scale,
+                                    TRADE_TAPE_CAPACITY,
+                                    TRADE_VWAP_WINDOW)  # Recent trades
+        self.bars = SymbolBars(self.tick_scale)  # Streaming 1s/1m/session bars
+        self.lock = lock if lock is not None else threading.Lock()
+        self.version = 0  # Bumped by the owner on every book change
+        # (bids, asks) PublishedBookSide pair readers use, or None
+        self.published = None
+    
+    def price_to_ticks(self, price, side=None):
+        """
+        Convert a float price to integer ticks
+        
+        Args:
+            price (float): Price to convert
+            side (OrderSide): If given, off-tick limit prices round towards
+                the passive side instead of to the nearest tick
+        """
+        if side is None:
+            return self.tick_scale.to_ticks(price)
+        return self.tick_scale.to_ticks_for_side(price, side)
+    
+    def ticks_to_price(self, ticks):
+        """Convert integer ticks back to a float price"""
+        return self.tick_scale.to_price(ticks)
+    
+    def round_price(self, price):
+        """Round a float price to the nearest valid tick"""
+        return self.tick_scale.to_price(self.tick_scale.to_ticks(price))
+    
+    def prepare_order(self, order):
+        """
+        Assign integer ticks to an incoming order and snap its price to the tick grid
+        
+        Raises:
+            ValueError: If the price is NaN, infinite or outside the price
+                band (the order is left unchanged)
+        """
+        price_ticks = self.tick_scale.to_ticks_for_side(order.price, order.side)
+        self.check_price_band(price_ticks)
+        order.price_ticks = price_ticks
+        order.price = self.tick_scale.to_price(price_ticks)
+    
+    def check_price_band(self, price_ticks):
+        """
+        Reject a limit price too far from the last trade
+        
+        No price is rejected before the symbol's first trade. Reads the
+        tape's published last price, so any thread may call it.
+        
+        Raises:
+            ValueError: If price_ticks is outside price_band of the last
+                trade price
+        """
+        band = self.price_band
+        if band is None:
+            return
+        reference = self.trade_tape.get_last_price_ticks()
+        if reference is not None and abs(price_ticks - reference) > band * reference:
+            raise ValueError(
+                f"Price {self.ticks_to_price(price_ticks)} is outside the "
+                f"{band:.0%} band around the last trade "
+                f"{self.ticks_to_price(reference)}")
+    
+    def price_in_band(self, price, side):
+        """
+        Check a limit price before it is queued (gateway and import ingress)
+        
+        The matching thread checks again when it processes the order, so a
+        price admitted here can still be rejected if the last trade moves
+        in between.
+        
+        Returns:
+            bool: False if the price is not finite or is outside the band
+        """
+        try:
+            self.check_price_band(self.tick_scale.to_ticks_for_side(price, side))
+        except ValueError:
+            return False
+        return True
     
     def add_order(self, order):
         """Add an order to the appropriate side of the book"""
         if order.symbol != self.symbol:
             raise ValueError(f"Order symbol {order.symbol} doesn't match book symbol {self.symbol}")
         
+        if order.price_ticks is None:
+            self.prepare_order(order)
+        
+        self.version += 1
         if order.side == OrderSide.BUY:
             self.bids.add_order(order)
         else:
@@ -166,78 +828,256 @@ class OrderBook:
     
     def remove_order(self, order_id, side):
         """Remove an order from the book"""
+        self.version += 1
         if side == OrderSide.BUY:
             return self.bids.remove_order(order_id)
         else:
             return self.asks.remove_order(order_id)
     
+    def reduce_order(self, order, quantity):
+        """Shrink a resting order in place, keeping its queue position"""
+        self.version += 1
+        if order.side == OrderSide.BUY:
+            return self.bids.reduce_order(order, quantity)
+        else:
+            return self.asks.reduce_order(order, quantity)
+    
+    def fill_resting_order(self, order, quantity, price):
+        """Fill part of a resting order, keeping level and side totals in sync"""
+        self.version += 1
+        if order.side == OrderSide.BUY:
+            self.bids.fill_order(order, quantity, price)
+        else:
+            self.asks.fill_order(order, quantity, price)
+    
+    def fill_uncrossed_order(self, order, quantity, price):
+        """Fill part of a resting order matched outside the book (batch auction)"""
+        self.fill_resting_order(order, quantity, price)
+    
     def get_best_bid(self):
-        """Get the best bid order"""
-        return self.bids.get_best_order()
+        """
+        Get the best bid as (price, quantity), or None
+        
+        A copy of the level, never a resting Order: pooled orders are
+        recycled once filled, so only the matching thread may hold them.
+        """
+        return self._read(lambda bids, asks: self._best_level(bids))
     
     def get_best_ask(self):
-        """Get the best ask order"""
-        return self.asks.get_best_order()
+        """Get the best ask as (price, quantity), or None (see get_best_bid)"""
+        return self._read(lambda bids, asks: self._best_level(asks))
+    
+    def _best_level(self, book_side):
+        tick = book_side.get_best_tick()
+        if tick is None:
+            return None
+        return self.ticks_to_price(tick), book_side.get_volume_at_tick(tick)
     
     def get_best_bid_price(self):
         """Get the best bid price"""
-        return self.bids.get_best_price()
+        return self._read(lambda bids, asks: bids.get_best_price())
     
     def get_best_ask_price(self):
         """Get the best ask price"""
-        return self.asks.get_best_price()
+        return self._read(lambda bids, asks: asks.get_best_price())
     
-    def get_spread(self):
-        """Get the bid-ask spread"""
-        best_bid = self.get_best_bid_price()
-        best_ask = self.get_best_ask_price()
+    def get_best_bid_tick(self):
+        """Get the best bid price in ticks"""
+        return self._read(lambda bids, asks: bids.get_best_tick())
+    
+    def get_best_ask_tick(self):
+        """Get the best ask price in ticks"""
+        return self._read(lambda bids, asks: asks.get_best_tick())
+    
+    @staticmethod
+    def _best_ticks(bids, asks):
+        return bids.get_best_tick(), asks.get_best_tick()
+    
+    def publish_levels(self, bids, asks, bid_totals, ask_totals):
+        """
+        Publish a copy of the top levels for readers (see OrderBook)
+        
+        Args:
+            bids (list): Top bid level dicts, best first, taken with the
+                owner's lock held
+            asks (list): Top ask level dicts, best first
+            bid_totals (tuple): (levels, orders, volume) of all bids
+            ask_totals (tuple): (levels, orders, volume) of all asks
+        """
+        self.published = (PublishedBookSide(True, bids, bid_totals),
+                          PublishedBookSide(False, asks, ask_totals))
+    
+    def unpublish_levels(self):
+        """Send readers back to the live book (the publisher stopped)"""
+        self.published = None
+    
+    def _read(self, query, covered=None):
+        """
+        Answer a query from the published levels, else from the live book
         
+        Args:
+            query (callable): query(bids, asks) reading two book sides
+            covered (callable): covered(bids, asks) is False when the
+                published levels are too shallow for the query
+        """
+        published = self.published
+        if published is not None and (covered is None or covered(*published)):
+            return query(*published)
+        with self.lock:
+            return query(self.bids, self.asks)
+    
+    def _spread(self, best_bid, best_ask):
         if best_bid is not None and best_ask is not None:
-            return best_ask - best_bid
+            return self.ticks_to_price(best_ask - best_bid)
         return None
     
-    def get_mid_price(self):
-        """Get the mid price (average of best bid and ask)"""
-        best_bid = self.get_best_bid_price()
-        best_ask = self.get_best_ask_price()
-        
+    def _mid_price(self, best_bid, best_ask):
         if best_bid is not None and best_ask is not None:
-            return (best_bid + best_ask) / 2
+            return (best_bid + best_ask) * self.tick_size / 2
         return None
     
-    def get_top_levels(self, num_levels=5):
+    def get_version(self):
+        """
+        Get the change counter (a reader redraws the book only when it moved)
+        
+        Read without the lock: a stale value only delays one redraw.
+        """
+        return self.version
+    
+    def get_spread(self):
+        """Get the bid-ask spread"""
+        return self._spread(*self._read(self._best_ticks))
+    
+    def get_mid_price(self):
+        """Get the mid price (average of best bid and ask)"""
+        return self._mid_price(*self._read(self._best_ticks))
+    
+    def get_top_levels(self, num_levels=5, include_orders=True):
         """
         Get top N levels from both sides of the book
         
+        Args:
+            num_levels (int): Maximum number of levels per side
+            include_orders (bool): Include each level's resting orders (read
+                from the live book; they are the matching thread's objects)
+        
         Returns:
             tuple: (bids, asks) where each is a list of price level dictionaries
         """
-        bids = self.bids.get_top_levels(num_levels)
-        asks = self.asks.get_top_levels(num_levels)
-        return bids, asks
+        def covered(bids, asks):
+            return not include_orders and all(
+                len(side.levels) >= num_levels or side.covers()
+                for side in (bids, asks))
+        return self._read(
+            lambda bids, asks: (bids.get_top_levels(num_levels, include_orders),
+                                asks.get_top_levels(num_levels, include_orders)),
+            covered)
     
-    def add_trade(self, trade):
-        """Add a trade to the history"""
-        with self.lock:
-            self.trade_history.append(trade)
+    def add_trade(self, sequence, timestamp_ns, side, quantity, price_ticks,
+                  buy_order_id, sell_order_id, buyer_id, seller_id):
+        """
+        Add a trade to the tape and bars (called by the owning matching thread)
+        
+        Arguments are the trade's fields as in TradeTape.append; nothing is
+        allocated per trade.
+        """
+        self.trade_tape.append(sequence, timestamp_ns, side, quantity,
+                               price_ticks, buy_order_id, sell_order_id,
+                               buyer_id, seller_id)
+        self.bars.record(price_ticks, quantity, timestamp_ns)
     
     def get_recent_trades(self, count=10):
-        """Get recent trades"""
-        with self.lock:
-            return list(self.trade_history)[-count:]
+        """Get the last count trades, oldest first (0 for all retained)"""
+        return self.trade_tape.last(count)
+    
+    def get_last_trade_price(self):
+        """Get the most recent trade price, or None if nothing has traded"""
+        return self.trade_tape.get_last_price()
+    
+    def get_recent_vwap(self):
+        """Get the running VWAP of the last few trades, or None if nothing has traded"""
+        return self.trade_tape.get_vwap()
+    
+    def get_bar(self, interval=None):
+        """Get the in-progress bar for an interval in seconds (None for the session)"""
+        return self.bars.get_bar(interval)
+    
+    def get_bars(self, interval, count=0):
+        """Get recent bars for an interval in seconds, oldest first"""
+        return self.bars.get_bars(interval, count)
     
     def get_volume_at_price(self, price, side):
         """Get total volume at a specific price"""
-        if side == OrderSide.BUY:
-            orders = self.bids.get_orders_at_price(price)
-        else:
-            orders = self.asks.get_orders_at_price(price)
+        tick = self.price_to_ticks(price)
+        index = 0 if side == OrderSide.BUY else 1
+        return self._read(
+            lambda *sides: sides[index].get_volume_at_tick(tick),
+            lambda *sides: sides[index].covers(tick))
+    
+    def _sweep(self, side, quantities, limit_tick):
+        """
+        Sweep results for each quantity, from the published levels when
+        they fill it or hold every level within limit_tick
+        """
+        index = 1 if side == OrderSide.BUY else 0  # BUY takes asks
+        published = self.published
+        if published is not None:
+            book_side = published[index]
+            results = book_side.sweep_many(quantities, limit_tick)
+            if book_side.covers(limit_tick) or all(
+                    result[0] >= quantity
+                    for result, quantity in zip(results, quantities)):
+                return results
+        with self.lock:
+            return (self.bids, self.asks)[index].sweep_many(quantities,
+                                                            limit_tick)
+    
+    def _to_sweep(self, result):
+        quantity, notional_ticks, last_tick = result
+        if not quantity:
+            return Sweep(0, 0.0, None, None)
+        notional = self.tick_scale.to_price(notional_ticks)
+        return Sweep(quantity, notional, notional / quantity,
+                     self.tick_scale.to_price(last_tick))
+    
+    def sweep_cost(self, side, quantity, price_limit=None):
+        """
+        Cost of filling quantity with one aggressive order, without matching
+        
+        Args:
+            side (OrderSide): Side of the aggressive order (BUY takes asks)
+            quantity (int): Quantity to fill
+            price_limit (float): Optional limit price of the order
         
-        return sum(order.quantity for order in orders)
+        Returns:
+            Sweep: Fillable quantity (less than requested when the book is
+                too thin), notional, average price and worst level price
+        """
+        limit_tick = (None if price_limit is None else
+                      self.tick_scale.to_ticks_for_side(price_limit, side))
+        return self._to_sweep(self._sweep(side, [quantity], limit_tick)[0])
+    
+    def sweep_costs(self, side, quantities, price_limit=None):
+        """sweep_cost() for many sizes at once, against one state of the book"""
+        limit_tick = (None if price_limit is None else
+                      self.tick_scale.to_ticks_for_side(price_limit, side))
+        return [self._to_sweep(result)
+                for result in self._sweep(side, quantities, limit_tick)]
+    
+    def quantity_within(self, side, price_limit):
+        """
+        Quantity an aggressive order could fill at price_limit or better
+        
+        Args:
+            side (OrderSide): Side of the aggressive order (BUY takes asks)
+            price_limit (float): Limit price
+        """
+        limit_tick = self.tick_scale.to_ticks_for_side(price_limit, side)
+        return self._sweep(side, [math.inf], limit_tick)[0][0]
     
     def get_market_depth(self, max_levels=10):
         """Get market depth (cumulative volume at each price level)"""
-        bids, asks = self.get_top_levels(max_levels)
+        bids, asks = self.get_top_levels(max_levels, include_orders=False)
         
         # Calculate cumulative volumes
         bid_depth = []
@@ -264,24 +1104,25 @@ class OrderBook:
         return bid_depth, ask_depth
     
     def get_snapshot(self):
-        """Get a complete snapshot of the order book"""
-        bids, asks = self.get_top_levels(10)
+        """Get a snapshot of the top 10 levels (without resting orders)"""
+        bids, asks = self.get_top_levels(10, include_orders=False)
+        best_bid = bids[0]['price_ticks'] if bids else None
+        best_ask = asks[0]['price_ticks'] if asks else None
         
         return {
             'symbol': self.symbol,
             'timestamp': datetime.now(),
             'bids': bids,
             'asks': asks,
-            'best_bid': self.get_best_bid_price(),
-            'best_ask': self.get_best_ask_price(),
-            'spread': self.get_spread(),
-            'mid_price': self.get_mid_price()
+            'best_bid': bids[0]['price'] if bids else None,
+            'best_ask': asks[0]['price'] if asks else None,
+            'spread': self._spread(best_bid, best_ask),
+            'mid_price': self._mid_price(best_bid, best_ask)
         }
     
     def is_crossed(self):
         """Check if the book is crossed (bid >= ask)"""
-        best_bid = self.get_best_bid_price()
-        best_ask = self.get_best_ask_price()
+        best_bid, best_ask = self._read(self._best_ticks)
         
         if best_bid is not None and best_ask is not None:
             return best_bid >= best_ask
@@ -289,16 +1130,18 @@ class OrderBook:
     
     def get_statistics(self):
         """Get order book statistics"""
-        bids, asks = self.get_top_levels(5)
-        
-        return {
-            'symbol': self.symbol,
-            'total_bid_volume': self.bids.get_total_volume(),
-            'total_ask_volume': self.asks.get_total_volume(),
-            'bid_levels': len(self.bids.price_levels),
-            'ask_levels': len(self.asks.price_levels),
-            'total_orders': len(self.bids.orders) + len(self.asks.orders),
-            'spread': self.get_spread(),
-            'mid_price': self.get_mid_price(),
-            'is_crossed': self.is_crossed()
-        }
+        def query(bids, asks):
+            return {
+                'symbol': self.symbol,
+                'total_bid_volume': bids.get_total_volume(),
+                'total_ask_volume': asks.get_total_volume(),
+                'bid_levels': bids.get_level_count(),
+                'ask_levels': asks.get_level_count(),
+                'total_orders': bids.get_order_count() + asks.get_order_count()
+            }, self._best_ticks(bids, asks)
+        stats, (best_bid, best_ask) = self._read(query)
+        stats['spread'] = self._spread(best_bid, best_ask)
+        stats['mid_price'] = self._mid_price(best_bid, best_ask)
+        stats['is_crossed'] = (best_bid is not None and best_ask is not None
+                               and best_bid >= best_ask)
+        return stats
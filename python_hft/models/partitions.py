@@ -0,0 +1,1018 @@
+"""
+Multi-process engine partitions
+
+PartitionedEngine keeps the TradingEngine interface Trader and the
+dashboard use, but matches in worker processes: symbols are hashed onto
+partitions, and each partition is a separate process running its own
+single-shard TradingEngine, so matching on different partitions runs on
+different cores instead of taking turns on one GIL.
+
+The gateway (the creating process) encodes orders, cancels and amends as
+fixed-size records into each partition's request ring and reads trade
+records back from its response ring (both SharedRing files). Fills are
+derived from the trades and delivered to traders through the gateway's
+own EventDispatcher. The gateway numbers trades with its own sequence
+as their records arrive (each drain round merged by timestamp); the
+partition's number is kept as partition_sequence on published trade events.
+Each partition publishes its stats and top levels through a StatsSurface
+shared file, which the gateway reads without a lock.
+
+The gateway's view of an order is a shadow updated from trade records,
+so right after a cancel or amend it runs ahead of the partition, and
+book queries reflect the partition's last stats publish.
+"""
+import heapq
+import itertools
+import math
+import multiprocessing
+import os
+import shutil
+import struct
+import tempfile
+import threading
+import time
+import zlib
+from collections import namedtuple
+from datetime import datetime
+
+from models.clock import WALL_CLOCK
+from models.engine import TradingEngine
+from models.events import EventDispatcher, FillEvent
+from models.lock_stats import CountingLock
+from models.order import Order, OrderInfo, OrderSide
+from models.orderbook import OrderBook, PublishedBookSide, DEFAULT_TICK_SIZE
+from models.shared_ring import SharedRing, shared_memory_directory
+from models.stats_surface import SharedStatsReader, StatsSurface
+from models.trade_columns import build_trade_record
+from models.trade_store import TradeStore
+
+RECORD_SIZE = 64
+
+# Request record kinds (gateway -> partition)
+DEFINE_SYMBOL = 1
+DEFINE_TRADER = 2
+SUBMIT = 3
+CANCEL = 4
+AMEND = 5
+STOP = 6
+
+# Response record kinds (partition -> gateway)
+TRADE = 10
+
+# kind, code, tick size, name
+NAME_RECORD = struct.Struct('<Bxxxid48s')
+# kind, side, symbol code, trader code, order_id, quantity, price
+ORDER_RECORD = struct.Struct('<Bbxxiiqqd')
+# kind, aggressor side, symbol, buyer, seller, sequence, quantity,
+# price_ticks, buy_order_id, sell_order_id, timestamp_ns
+TRADE_RECORD = struct.Struct('<Bbxxiiiqqqqqq')
+
+SIDES = (OrderSide.BUY, OrderSide.SELL)
+NO_QUANTITY = -1  # AMEND keeps the quantity
+NO_PRICE = math.nan  # AMEND keeps the price
+
+# Fill of an order the gateway no longer shadows (cancelled or amended away)
+_UntrackedOrder = namedtuple('_UntrackedOrder',
+                             'trader_id order_id symbol side quantity')
+
+
+def _encode_name(name):
+    encoded = name.encode()
+    if len(encoded) > 48:
+        raise ValueError(f"Name longer than 48 bytes: {name!r}")
+    return encoded
+
+
+def run_partition(config, ready):
+    """
+    Worker process entry point: match one partition's orders until STOP
+
+    Args:
+        config (dict): Ring/stats paths and engine settings from the gateway
+        ready: multiprocessing Event set once the partition accepts records
+    """
+    # The gateway applies the price band before orders reach a partition
+    engine = TradingEngine(backend=config['backend'],
+                           default_tick_size=config['default_tick_size'],
+                           batch_size=config['batch_size'],
+                           price_band=None)
+    # Partition sequences stay unique across partitions (the gateway
+    # numbers trades globally in the order it receives them)
+    engine.trade_ids = itertools.count(config['partition_id'] + 1,
+                                       config['partition_count'])
+    requests = SharedRing(config['request_path'], RECORD_SIZE,
+                          config['ring_capacity'])
+    responses = SharedRing(config['response_path'], RECORD_SIZE,
+                           config['ring_capacity'])
+    surface = StatsSurface(engine,
+                           top_levels=config['top_levels'],
+                           traders=[],
+                           shared_path=config['stats_path'])
+    interval_ns = int(config['stats_interval_seconds'] * 1e9)
+    # Stay under the shard ring so submit_orders never waits on itself
+    max_records = min(4096, engine.shards[0].order_queue.capacity // 2)
+
+    symbols = {}  # code -> name
+    symbol_codes = {}  # name -> code
+    traders = {}
+    trader_codes = {}
+
+    def pack_trade(buffer, offset, trade):
+        TRADE_RECORD.pack_into(
+            buffer, offset, TRADE, 0 if trade['side'] == 'BUY' else 1,
+            symbol_codes[trade['symbol']], trader_codes[trade['buyer_id']],
+            trader_codes[trade['seller_id']], trade['sequence'],
+            trade['quantity'], trade['price_ticks'], trade['buy_order_id'],
+            trade['sell_order_id'], int(trade['timestamp'].timestamp() * 1e9))
+
+    engine.subscribe_trades(
+        'gateway',
+        lambda events: responses.put_many(pack_trade,
+                                          [event.trade for event in events]))
+
+    pending = []
+
+    def match_pending():
+        if pending:
+            engine.submit_orders(list(pending))
+            pending.clear()
+        engine.run_until_idle()
+
+    surface.publish_now()
+    last_publish_ns = time.monotonic_ns()
+    ready.set()
+
+    idle_rounds = 0
+    stopping = False
+    while not stopping:
+        data = requests.drain(max_records)
+        if not data:
+            idle_rounds += 1
+            if time.monotonic_ns() - last_publish_ns >= interval_ns:
+                surface.publish_now()
+                last_publish_ns = time.monotonic_ns()
+            requests.wait_for_records(idle_rounds)
+            continue
+        idle_rounds = 0
+
+        for offset in range(0, len(data), RECORD_SIZE):
+            kind = data[offset]
+            if kind == SUBMIT:
+                (_, side, symbol, trader, order_id, quantity,
+                 price) = ORDER_RECORD.unpack_from(data, offset)
+                order = engine.create_order(traders[trader], symbols[symbol],
+                                            SIDES[side], quantity, price)
+                order.order_id = order_id
+                pending.append(order)
+            elif kind == CANCEL or kind == AMEND:
+                # Match what arrived before it first, as one engine would
+                match_pending()
+                (_, _, _, _, order_id, quantity,
+                 price) = ORDER_RECORD.unpack_from(data, offset)
+                if kind == CANCEL:
+                    engine.cancel_order(order_id)
+                else:
+                    engine.amend_order(
+                        order_id,
+                        None if quantity == NO_QUANTITY else quantity,
+                        None if math.isnan(price) else price)
+            elif kind == DEFINE_SYMBOL:
+                _, code, tick_size, name = NAME_RECORD.unpack_from(data, offset)
+                name = name.rstrip(b'\0').decode()
+                symbols[code] = name
+                symbol_codes[name] = code
+                engine.set_tick_size(name, tick_size)
+            elif kind == DEFINE_TRADER:
+                _, code, _, name = NAME_RECORD.unpack_from(data, offset)
+                name = name.rstrip(b'\0').decode()
+                traders[code] = name
+                trader_codes[name] = code
+            elif kind == STOP:
+                stopping = True
+                break
+        match_pending()
+
+        if time.monotonic_ns() - last_publish_ns >= interval_ns:
+            surface.publish_now()
+            last_publish_ns = time.monotonic_ns()
+
+    surface.publish_now()
+    surface.close()
+    requests.close()
+    responses.close()
+
+
+class Partition:
+    """Gateway-side handle of one worker process and its rings"""
+
+    # How long stop() waits on the worker between empty response drains
+    IDLE_JOIN_SECONDS = 0.001
+
+    def __init__(self, partition_id, directory, config, context,
+                 drain_responses):
+        """
+        Create the partition's rings and start its process
+
+        Args:
+            partition_id (int): Index of the partition
+            directory (str): Directory for the ring and stats files
+            config (dict): Settings shared by every partition
+            context: multiprocessing context to start the worker with
+            drain_responses (callable): Applies pending response records
+                and returns how many; run while waiting on the worker, which
+                may itself be blocked on a full response ring
+        """
+        self.partition_id = partition_id
+        self.drain_responses = drain_responses
+        prefix = os.path.join(directory, f"partition-{partition_id}")
+        capacity = config['ring_capacity']
+        self.requests = SharedRing(prefix + '.requests', RECORD_SIZE, capacity,
+                                   create=True)
+        self.responses = SharedRing(prefix + '.responses', RECORD_SIZE,
+                                    capacity, create=True)
+        self.stats_path = prefix + '.stats'
+        self.stats_reader = None
+        self.block = None
+        self.block_read_ns = 0
+        self.block_max_age_ns = int(config['stats_interval_seconds'] * 1e9 / 2)
+
+        self.lock = threading.Lock()  # Serializes request producers
+        self.defined_symbols = set()
+        self.defined_traders = set()
+        self.symbols = set()
+
+        self.ready = context.Event()
+        self.process = context.Process(
+            target=run_partition,
+            args=(dict(config,
+                       partition_id=partition_id,
+                       request_path=self.requests.path,
+                       response_path=self.responses.path,
+                       stats_path=self.stats_path), self.ready),
+            name=f"engine-partition-{partition_id}",
+            daemon=True)
+        self.process.start()
+
+    def wait_ready(self, timeout):
+        """Wait for the worker to start accepting records"""
+        if not self.ready.wait(timeout):
+            raise RuntimeError(
+                f"Partition {self.partition_id} did not start within {timeout}s")
+        self.stats_reader = SharedStatsReader(self.stats_path)
+
+    def send(self, records):
+        """
+        Write (struct, values) request records in order (lock held)
+
+        Raises:
+            RuntimeError: If the request ring is full and the worker has
+                exited (records not yet written are dropped)
+        """
+        self.requests.put_many(
+            lambda buffer, offset, record: record[0].pack_into(
+                buffer, offset, *record[1]), records, self._wait_for_room)
+
+    def _wait_for_room(self):
+        """Keep responses flowing while the request ring is full"""
+        if not self.process.is_alive():
+            raise RuntimeError(f"Partition {self.partition_id} has exited")
+        self.drain_responses()
+
+    def read_block(self):
+        """Get the partition's last published stats block (cached briefly)"""
+        now = time.monotonic_ns()
+        if self.stats_reader is not None and (
+                now - self.block_read_ns >= self.block_max_age_ns):
+            try:
+                self.block = self.stats_reader.read()
+            except TimeoutError:
+                pass
+            self.block_read_ns = now
+        return self.block
+
+    def stop(self, timeout=5.0):
+        """
+        Stop the worker after it has matched what was sent
+
+        Responses are drained until it exits, so trades it is still
+        writing are not lost to a full response ring.
+        """
+        if self.process.is_alive():
+            try:
+                with self.lock:
+                    self.send([(ORDER_RECORD, (STOP, 0, 0, 0, 0, 0, 0.0))])
+            except RuntimeError:
+                return  # Already gone
+            deadline = time.monotonic() + timeout
+            while self.process.is_alive() and time.monotonic() < deadline:
+                if not self.drain_responses():
+                    self.process.join(self.IDLE_JOIN_SECONDS)
+            if self.process.is_alive():
+                self.process.terminate()
+                self.process.join(1.0)
+
+    def close(self):
+        """Unmap the rings and stats file"""
+        self.requests.close()
+        self.responses.close()
+        if self.stats_reader is not None:
+            self.stats_reader.close()
+            self.stats_reader = None
+
+
+class PartitionBookSide(PublishedBookSide):
+    """
+    Read-only view of one side of a partition's book
+
+    The PublishedBookSide queries over the partition's last published top
+    levels, so OrderBook's composite queries (spread, mid, statistics) work
+    unchanged; the levels are re-read from the stats block on each use.
+    """
+
+    def __init__(self, book, is_bid_side):
+        """
+        Initialize the side view
+
+        Args:
+            book (PartitionOrderBook): Owning book
+            is_bid_side (bool): True for bids, False for asks
+        """
+        self.book = book
+        self.is_bid_side = is_bid_side
+        self.levels_key = 'bids' if is_bid_side else 'asks'
+        self.totals_key = 'bid_totals' if is_bid_side else 'ask_totals'
+
+    @property
+    def levels(self):
+        published = self.book.get_published_levels()
+        return published[self.levels_key] if published else []
+
+    @property
+    def totals(self):
+        published = self.book.get_published_levels()
+        return published[self.totals_key] if published else (0, 0, 0)
+
+
+class PartitionOrderBook(OrderBook):
+    """
+    Gateway-side book of a partitioned symbol
+
+    Tick conversion, the trade tape and bars are local (fed from trade
+    records); depth comes from the owning partition's published levels.
+    """
+
+    def __init__(self, symbol, tick_size, partition,
+                 price_band=None):
+        """
+        Initialize the book view
+
+        Args:
+            symbol (str): Trading symbol
+            tick_size (float): Minimum price increment for this symbol
+            partition (Partition): Partition that matches the symbol
+            price_band (float): Limit price band around the last trade seen
+                by the gateway (see OrderBook)
+        """
+        super().__init__(symbol, tick_size, price_band=price_band)
+        self.partition = partition
+        self.bids = PartitionBookSide(self, is_bid_side=True)
+        self.asks = PartitionBookSide(self, is_bid_side=False)
+
+    def get_published_levels(self):
+        """Get this symbol's entry in the partition's last stats block"""
+        block = self.partition.read_block()
+        return block['orderbooks'].get(self.symbol) if block else None
+
+    def get_version(self):
+        """Get the partition book's version as of its last stats publish"""
+        block = self.partition.read_block()
+        return block['versions']['books'].get(self.symbol, 0) if block else 0
+
+
+class PartitionedEngine:
+    """
+    TradingEngine facade over worker-process partitions
+
+    Covers the engine API traders, the dashboard and the CSV importer
+    use, and keeps every trade in its own TradeStore; journals, snapshots
+    and market data stay features of the in-process TradingEngine.
+    """
+
+    # How long an idle response reader parks before re-checking is_running
+    IDLE_PARK_SECONDS = 0.001
+
+    def __init__(self,
+                 num_partitions=None,
+                 backend='python',
+                 tick_sizes=None,
+                 default_tick_size=DEFAULT_TICK_SIZE,
+                 batch_size=100,
+                 ring_capacity=65536,
+                 event_queue_capacity=65536,
+                 stats_interval_seconds=0.25,
+                 top_levels=5,
+                 start_timeout=60.0,
+                 price_band=None):
+        """
+        Start the partition processes
+
+        Args:
+            num_partitions (int): Worker processes (defaults to the CPU count)
+            backend (str): Matching backend of each partition's engine
+            tick_sizes (dict): Optional symbol -> tick size overrides
+            default_tick_size (float): Tick size for symbols without an override
+            batch_size (int): Maximum orders each partition matches per batch
+            ring_capacity (int): Records per request and response ring
+            event_queue_capacity (int): Undelivered fill events kept per trader
+            stats_interval_seconds (float): How often partitions publish stats
+            top_levels (int): Book levels per side partitions publish
+            start_timeout (float): Seconds to wait for every worker to start
+            price_band (float): Orders and amends priced further than this
+                fraction from their symbol's last trade are rejected at
+                submit (None, the default, for no band)
+        """
+        num_partitions = num_partitions or os.cpu_count() or 1
+        self.backend = backend
+        self.clock = WALL_CLOCK
+        self.orderbooks = {}  # symbol -> PartitionOrderBook
+        self.tick_sizes = dict(tick_sizes or {})
+        self.default_tick_size = default_tick_size
+        self.price_band = price_band
+        self.traders = {}
+        self.last_prices = {}  # symbol -> last trade price (mark table)
+        self.books_lock = CountingLock('books_lock')
+
+        self.order_ids = itertools.count(1)
+        # Gateway-wide trade sequence, in the order trade records arrive
+        self.trade_ids = itertools.count(1)
+        self.events = EventDispatcher(event_queue_capacity)
+
+        # Shadows of active orders, updated from trade records
+        self.active_orders = {}  # order_id -> Order
+        self.trader_orders = {}  # trader_id -> {order_id: Order}
+        self.orders_lock = CountingLock('orders_lock')
+        # Response rings have one consumer: the reader thread, or a thread
+        # waiting on a full request ring, or shutdown
+        self.responses_lock = threading.Lock()
+
+        # Codes shared by every partition's records
+        self.symbol_codes = {}
+        self.symbol_names = []
+        self.trader_codes = {}
+        self.trader_names = []
+        self.codes_lock = threading.Lock()
+
+        # Trades seen by the gateway, one store writer per partition
+        self.trade_store = TradeStore()
+        self.trade_writers = [
+            self.trade_store.writer() for _ in range(num_partitions)
+        ]
+        self.total_trades = 0
+        self.total_volume = 0
+        self.rejected_orders = 0  # Cancelled at submit (price not convertible or out of band)
+        self.stats_lock = CountingLock('stats_lock')
+
+        self.directory = tempfile.mkdtemp(prefix='hft-partitions-',
+                                          dir=shared_memory_directory())
+        config = {
+            'partition_count': num_partitions,
+            'backend': backend,
+            'default_tick_size': default_tick_size,
+            'batch_size': batch_size,
+            'ring_capacity': ring_capacity,
+            'stats_interval_seconds': stats_interval_seconds,
+            'top_levels': top_levels
+        }
+        context = multiprocessing.get_context('spawn')
+        self.partitions = [
+            Partition(partition_id, self.directory, config, context,
+                      self._drain_responses)
+            for partition_id in range(num_partitions)
+        ]
+        for partition in self.partitions:
+            partition.wait_ready(start_timeout)
+
+        self.start_time = datetime.fromtimestamp(self.clock.time_ns() / 1e9)
+        self.start_time_ns = self.clock.monotonic_ns()
+        self.is_running = False
+        self.reader_thread = None
+
+    def start(self):
+        """Start delivering trades and fills from the partitions"""
+        if not self.is_running:
+            self.is_running = True
+            self.events.start()
+            self.trade_store.start()
+            self.reader_thread = threading.Thread(target=self._response_loop,
+                                                  name="partition-gateway",
+                                                  daemon=True)
+            self.reader_thread.start()
+
+    def stop(self):
+        """Stop delivery (partitions keep their books until shutdown)"""
+        self.is_running = False
+        if self.reader_thread and self.reader_thread.is_alive():
+            self.reader_thread.join(timeout=2.0)
+        self.events.stop()
+        self.trade_store.stop()
+
+    def shutdown(self):
+        """Stop delivery, end the worker processes and remove their files"""
+        self.stop()
+        for partition in self.partitions:
+            partition.stop()
+        while self._drain_responses():
+            pass
+        self.events.deliver_pending()
+        for partition in self.partitions:
+            partition.close()
+        shutil.rmtree(self.directory, ignore_errors=True)
+        self.trade_store.close()
+
+    def register_trader(self, trader):
+        """Register a trader and route its fill events to it"""
+        self.traders[trader.trader_id] = trader
+        self.events.add_consumer(trader.trader_id, trader.on_fill_events)
+
+    def register_fill_consumer(self, consumer_id, callback, trader_ids=None):
+        """Receive FillEvent batches for one or more traders"""
+        self.events.add_consumer(consumer_id, callback, trader_ids)
+
+    def unregister_fill_consumer(self, consumer_id):
+        """Stop routing fills to a consumer"""
+        self.events.remove_consumer(consumer_id)
+
+    def subscribe_trades(self, consumer_id, callback):
+        """Receive every trade as batches of TradeEvent"""
+        self.events.subscribe_trades(consumer_id, callback)
+
+    def unsubscribe_trades(self, consumer_id):
+        """Stop a trade subscription"""
+        self.events.unsubscribe_trades(consumer_id)
+
+    def get_partition(self, symbol):
+        """Get the partition that matches a symbol"""
+        # Same stable hash as TradingEngine's shard routing
+        return self.partitions[zlib.crc32(symbol.encode()) %
+                               len(self.partitions)]
+
+    def get_orderbook(self, symbol):
+        """Get or create the gateway book view for a symbol"""
+        orderbook = self.orderbooks.get(symbol)
+        if orderbook is None:
+            with self.books_lock:
+                orderbook = self.orderbooks.get(symbol)
+                if orderbook is None:
+                    partition = self.get_partition(symbol)
+                    orderbook = PartitionOrderBook(symbol,
+                                                   self.get_tick_size(symbol),
+                                                   partition, self.price_band)
+                    partition.symbols.add(symbol)
+                    self.orderbooks[symbol] = orderbook
+        return orderbook
+
+    def get_tick_size(self, symbol):
+        """Get the tick size configured for a symbol"""
+        return self.tick_sizes.get(symbol, self.default_tick_size)
+
+    def set_tick_size(self, symbol, tick_size):
+        """Configure the tick size for a symbol before its book is created"""
+        if symbol in self.orderbooks:
+            raise ValueError(
+                f"Order book for {symbol} already exists; tick size is fixed")
+        self.tick_sizes[symbol] = tick_size
+
+    def create_order(self, trader_id, symbol, side, quantity, price):
+        """
+        Create an order
+
+        The gateway keeps it as its shadow of the order while active.
+        """
+        return Order(trader_id, symbol, side, quantity, price)
+
+    def _code(self, codes, names, name):
+        code = codes.get(name)
+        if code is None:
+            with self.codes_lock:
+                code = codes.get(name)
+                if code is None:
+                    _encode_name(name)
+                    code = codes[name] = len(names)
+                    names.append(name)
+        return code
+
+    def submit_order(self, order):
+        """
+        Submit an order to its symbol's partition
+
+        Returns:
+            int: The order ID, or None if the order was rejected
+        """
+        if not self.submit_orders([order]):
+            return None
+        return order.order_id
+
+    def submit_orders(self, orders, rejected=None):
+        """
+        Submit a batch of orders, one ring write per partition
+
+        An order whose price cannot be converted to ticks (NaN or infinite)
+        is cancelled and not sent.
+
+        Args:
+            orders (list): Orders from create_order
+            rejected (list): If given, receives the cancelled orders
+
+        Returns:
+            int: Number of orders submitted
+
+        Raises:
+            RuntimeError: If a partition's request ring is full and its
+                worker has exited
+        """
+        submit_time = self.clock.monotonic_ns()
+        batches = {}
+        accepted = []
+        for order in orders:
+            if order.order_id is None:
+                order.order_id = next(self.order_ids)
+            order.submit_time = submit_time
+            orderbook = self.get_orderbook(order.symbol)
+            try:
+                orderbook.prepare_order(order)
+            except ValueError:
+                order.cancel()
+                with self.stats_lock:
+                    self.rejected_orders += 1
+                if rejected is not None:
+                    rejected.append(order)
+                continue
+            batches.setdefault(orderbook.partition, []).append(order)
+            accepted.append(order)
+
+        with self.orders_lock:
+            for order in accepted:
+                self._track(order)
+
+        for partition, batch in batches.items():
+            with partition.lock:
+                records = []
+                for order in batch:
+                    symbol = self._code(self.symbol_codes, self.symbol_names,
+                                        order.symbol)
+                    trader = self._code(self.trader_codes, self.trader_names,
+                                        order.trader_id)
+                    if symbol not in partition.defined_symbols:
+                        partition.defined_symbols.add(symbol)
+                        records.append((NAME_RECORD, (
+                            DEFINE_SYMBOL, symbol,
+                            self.get_tick_size(order.symbol),
+                            _encode_name(order.symbol))))
+                    if trader not in partition.defined_traders:
+                        partition.defined_traders.add(trader)
+                        records.append((NAME_RECORD, (
+                            DEFINE_TRADER, trader, 0.0,
+                            _encode_name(order.trader_id))))
+                    records.append((ORDER_RECORD, (
+                        SUBMIT, 0 if order.side is OrderSide.BUY else 1,
+                        symbol, trader, order.order_id, order.quantity,
+                        order.price)))
+                partition.send(records)
+        return len(accepted)
+
+    def _track(self, order):
+        """Add a shadow order (orders_lock held)"""
+        self.active_orders[order.order_id] = order
+        orders = self.trader_orders.get(order.trader_id)
+        if orders is None:
+            orders = self.trader_orders[order.trader_id] = {}
+        orders[order.order_id] = order
+
+    def _untrack(self, order_id):
+        """Remove a shadow order (orders_lock held)"""
+        order = self.active_orders.pop(order_id, None)
+        if order is not None:
+            orders = self.trader_orders.get(order.trader_id)
+            if orders is not None:
+                orders.pop(order_id, None)
+                if not orders:
+                    del self.trader_orders[order.trader_id]
+        return order
+
+    def _send_order_request(self, kind, order, quantity=NO_QUANTITY,
+                            price=NO_PRICE):
+        partition = self.get_partition(order.symbol)
+        with partition.lock:
+            partition.send([(ORDER_RECORD, (kind, 0, 0, 0, order.order_id,
+                                            quantity, price))])
+
+    def cancel_order(self, order_id):
+        """
+        Cancel an order
+
+        Returns:
+            bool: True if the order was active as far as the gateway knows
+                (the partition applies the cancel asynchronously)
+        """
+        with self.orders_lock:
+            order = self._untrack(order_id)
+        if order is None:
+            return False
+        order.cancel()
+        self._send_order_request(CANCEL, order)
+        return True
+
+    def cancel_all(self, trader_id, symbol=None):
+        """
+        Cancel every active order of a trader
+
+        Returns:
+            int: Number of cancels sent
+        """
+        with self.orders_lock:
+            orders = self.trader_orders.get(trader_id)
+            order_ids = [
+                order_id for order_id, order in (orders or {}).items()
+                if symbol is None or order.symbol == symbol
+            ]
+        return sum(1 for order_id in order_ids if self.cancel_order(order_id))
+
+    def amend_order(self, order_id, quantity=None, price=None):
+        """
+        Change an order's quantity and/or price (applied asynchronously)
+
+        Returns:
+            bool: True if the amendment was sent
+
+        Raises:
+            ValueError: If the price is NaN, infinite or outside the price
+                band (the order is left unchanged)
+        """
+        with self.orders_lock:
+            order = self.active_orders.get(order_id)
+            if order is None:
+                return False
+            if quantity is not None and quantity <= 0:
+                order = None
+            else:
+                orderbook = self.get_orderbook(order.symbol)
+                if price is not None:
+                    # Raises ValueError before the shadow order is changed
+                    orderbook.check_price_band(
+                        orderbook.price_to_ticks(price, order.side))
+                order.amend(order.quantity if quantity is None else quantity,
+                            price)
+                orderbook.prepare_order(order)
+        if order is None:
+            return self.cancel_order(order_id)
+        self._send_order_request(
+            AMEND, order, NO_QUANTITY if quantity is None else quantity,
+            NO_PRICE if price is None else price)
+        return True
+
+    def _response_loop(self):
+        """Read trade records from every partition until stopped"""
+        idle_rounds = 0
+        while self.is_running:
+            if self._drain_responses():
+                idle_rounds = 0
+                continue
+            idle_rounds += 1
+            time.sleep(0 if idle_rounds < 16 else self.IDLE_PARK_SECONDS)
+        self._drain_responses()
+
+    def _drain_responses(self):
+        """
+        Apply up to 4096 pending trade records per partition
+
+        Returns 0 without waiting if another thread is already draining.
+
+        Returns:
+            int: Number of records applied
+        """
+        if not self.responses_lock.acquire(False):
+            return 0
+        try:
+            chunks = []
+            for partition in self.partitions:
+                data = partition.responses.drain(4096)
+                if data:
+                    chunks.append(
+                        (data, self.trade_writers[partition.partition_id]))
+            if chunks:
+                self._apply_trades(chunks)
+            return sum(len(data) for data, _ in chunks) // RECORD_SIZE
+        finally:
+            self.responses_lock.release()
+
+    @staticmethod
+    def _records(data, trade_columns):
+        """Yield (trade record fields, writer) for one partition's records"""
+        for record in TRADE_RECORD.iter_unpack(data):
+            yield record, trade_columns
+
+    def _apply_trades(self, chunks):
+        """
+        Turn trade records into trades, shadow fills and fill events
+
+        Args:
+            chunks (list): (records, partition trade writer) drained in one
+                round; their records are merged by timestamp before the
+                gateway numbers them
+        """
+        symbol_names = self.symbol_names
+        trader_names = self.trader_names
+        orderbooks = self.orderbooks
+        trade_ids = self.trade_ids
+        traded = volume = 0
+        # Trade dicts only for subscribers; the store and tapes take columns
+        publish_trades = self.events.has_trade_subscribers()
+        trades = []
+        fills_by_trader = {}
+
+        streams = [self._records(data, columns) for data, columns in chunks]
+        records = streams[0] if len(streams) == 1 else heapq.merge(
+            *streams, key=lambda item: item[0][10])  # timestamp_ns
+
+        with self.orders_lock:
+            active_orders = self.active_orders
+            for ((_, aggressor, symbol_code, buyer_code, seller_code,
+                  partition_sequence, quantity, price_ticks, buy_order_id,
+                  sell_order_id, timestamp_ns),
+                 trade_columns) in records:
+                symbol = symbol_names[symbol_code]
+                orderbook = orderbooks[symbol]
+                price = orderbook.ticks_to_price(price_ticks)
+                # Partitions number their trades independently, so the
+                # store (merged by sequence) gets the gateway's own order
+                sequence = next(trade_ids)
+                buyer_id = trader_names[buyer_code]
+                seller_id = trader_names[seller_code]
+                trade_columns.append(sequence, timestamp_ns, symbol,
+                                     orderbook.tick_size, aggressor, quantity,
+                                     price_ticks, price, buy_order_id,
+                                     sell_order_id, buyer_id, seller_id)
+                orderbook.add_trade(sequence, timestamp_ns, aggressor,
+                                    quantity, price_ticks, buy_order_id,
+                                    sell_order_id, buyer_id, seller_id)
+                self.last_prices[symbol] = price
+                traded += 1
+                volume += quantity
+                if publish_trades:
+                    trade = build_trade_record(sequence, timestamp_ns, symbol,
+                                               aggressor, quantity,
+                                               price_ticks, price,
+                                               buy_order_id, sell_order_id,
+                                               buyer_id, seller_id)
+                    trade['partition_sequence'] = partition_sequence
+                    trades.append(trade)
+
+                for order_id, trader_id, side in (
+                        (buy_order_id, buyer_id, OrderSide.BUY),
+                        (sell_order_id, seller_id, OrderSide.SELL)):
+                    order = active_orders.get(order_id)
+                    if order is not None:
+                        order.fill(min(quantity, order.quantity), price)
+                        if not order.is_active():
+                            self._untrack(order_id)
+                    else:
+                        order = _UntrackedOrder(trader_id, order_id, symbol,
+                                                side, 0)
+                    fills_by_trader.setdefault(trader_id, []).append(
+                        FillEvent(order, quantity, price, sequence,
+                                  timestamp_ns))
+
+        with self.stats_lock:
+            self.total_trades += traded
+            self.total_volume += volume
+
+        self.events.publish_fills(fills_by_trader)
+        if trades:
+            self.events.publish_trades(trades)
+
+    def get_recent_trades(self, count=20):
+        """Get recent trades across all partitions (0 or less: every trade)"""
+        return self.trade_store.get_recent_trades(count)
+
+    def get_recent_trades_for_symbol(self, symbol, count=10):
+        """Get recent trades for a specific symbol"""
+        orderbook = self.orderbooks.get(symbol)
+        return orderbook.get_recent_trades(count) if orderbook else []
+
+    def get_all_trades(self):
+        """Get every trade the gateway has seen, in sequence order"""
+        return self.trade_store.get_all_trades()
+
+    # Full-history trade queries, as on TradingEngine
+    iter_trades = TradingEngine.iter_trades
+    get_trade = TradingEngine.get_trade
+    get_trade_batches = TradingEngine.get_trade_batches
+
+    def get_trader_orders(self, trader_id, symbol=None):
+        """
+        Get a trader's active orders (copies of the gateway shadows)
+
+        Returns:
+            list: OrderInfo tuples
+        """
+        with self.orders_lock:
+            orders = self.trader_orders.get(trader_id)
+            if not orders:
+                return []
+            return [
+                OrderInfo(order.order_id, order.symbol, order.side, order.price,
+                          order.quantity)
+                for order in orders.values()
+                if symbol is None or order.symbol == symbol
+            ]
+
+    @staticmethod
+    def _merge_latency(summaries):
+        """Combine per-partition latency summaries (percentiles are upper bounds)"""
+        merged = {}
+        for stage in (summaries[0] if summaries else {}):
+            stages = [summary[stage] for summary in summaries]
+            count = sum(s['count'] for s in stages)
+            merged[stage] = {
+                'count': count,
+                'mean_us': sum(s['mean_us'] * s['count']
+                               for s in stages) / max(1, count),
+                'p50_us': max(s['p50_us'] for s in stages),
+                'p99_us': max(s['p99_us'] for s in stages),
+                'p999_us': max(s['p999_us'] for s in stages),
+                'max_us': max(s['max_us'] for s in stages)
+            }
+        return merged
+
+    def get_performance_stats(self):
+        """Get performance statistics aggregated across partitions"""
+        runtime_seconds = (self.clock.monotonic_ns() -
+                           self.start_time_ns) / 1e9
+        blocks = [partition.read_block() for partition in self.partitions]
+        performance = [block['performance'] for block in blocks if block]
+        latency = self._merge_latency(
+            [stats['latency'] for stats in performance])
+        requests = [
+            partition.requests.get_statistics()
+            for partition in self.partitions
+        ]
+
+        with self.stats_lock:
+            total_trades = self.total_trades
+            total_volume = self.total_volume
+            rejected_orders = self.rejected_orders
+
+        return {
+            'total_trades': total_trades,
+            'total_volume': total_volume,
+            'trades_per_second': total_trades / max(1, runtime_seconds),
+            'orders_per_second':
+            sum(stats['orders_per_second'] for stats in performance),
+            'avg_latency_ms':
+            latency['total']['mean_us'] / 1e3 if latency else 0,
+            'latency': latency,
+            'active_orders': len(self.active_orders),
+            'rejected_orders': rejected_orders,
+            'runtime_seconds': runtime_seconds,
+            'symbols_active': len(self.orderbooks),
+            'orders_allocated':
+            sum(stats['orders_allocated'] for stats in performance),
+            'orders_reused':
+            sum(stats['orders_reused'] for stats in performance),
+            'queue_depth': sum(stats['depth'] for stats in requests),
+            'queue_high_water_mark':
+            max(stats['high_water_mark'] for stats in requests),
+            'queue_overflows': 0,
+            'queue_backpressure_waits':
+            sum(stats['backpressure_waits'] for stats in requests),
+            'fill_events': self.events.get_statistics(),
+            'trade_store': self.trade_store.get_statistics(),
+            'backend': self.backend,
+            'shard_count': len(self.partitions),
+            'partitions': [{
+                'partition_id': partition.partition_id,
+                'pid': partition.process.pid,
+                'alive': partition.process.is_alive(),
+                'symbols': sorted(partition.symbols),
+                'stats_version': block['version'] if block else 0,
+                'total_trades':
+                block['performance']['total_trades'] if block else 0,
+                'requests': request_stats,
+                'responses': partition.responses.get_statistics(),
+                'locks': block['performance'].get('locks') if block else None
+            } for partition, block, request_stats in zip(
+                self.partitions, blocks, requests)],
+            # The gateway's own locks; each partition's are listed with it
+            'locks': {
+                'orders_lock': self.orders_lock.get_statistics(),
+                'stats_lock': self.stats_lock.get_statistics(),
+                'books_lock': self.books_lock.get_statistics()
+            }
+        }
+
+    # Built from the book views exactly as the in-process engine does
+    get_market_summary = TradingEngine.get_market_summary
+    get_symbol_statistics = TradingEngine.get_symbol_statistics
+    get_mark = TradingEngine.get_mark
+    get_marks = TradingEngine.get_marks
+    get_versions = TradingEngine.get_versions
@@ -0,0 +1,179 @@
+import itertools
+import threading
+import time
+
+
+class MPSCRingBuffer:
+    """
+    Bounded multi-producer/single-consumer ring buffer
+
+    Producers claim a sequence number from an atomic counter and publish into
+    the matching slot; each slot carries its own sequence so the consumer
+    only reads fully published items, in claim order (Vyukov-style queue).
+    No mutex is taken on put or drain: the only shared operations are the
+    GIL-atomic counter increment and single reference stores.
+    """
+
+    OVERFLOW_BLOCK = 'block'  # Producer waits for space (backpressure)
+    OVERFLOW_REJECT = 'reject'  # Producer gets False and the item is dropped
+
+    def __init__(self, capacity=65536, overflow_policy=OVERFLOW_BLOCK,
+                 on_full=None):
+        """
+        Initialize the ring buffer
+
+        Args:
+            capacity (int): Number of slots, rounded up to a power of two
+            overflow_policy (str): 'block' to wait for space, 'reject' to
+                fail put() when the ring is full
+            on_full (callable): Called by a producer blocked on a full ring
+                instead of just yielding; returns True if it freed slots
+                (e.g. drained the ring inline when no consumer is running)
+        """
+        if overflow_policy not in (self.OVERFLOW_BLOCK, self.OVERFLOW_REJECT):
+            raise ValueError(f"Unknown overflow policy: {overflow_policy}")
+
+        size = 1
+        while size < capacity:
+            size <<= 1
+        self.capacity = size
+        self.mask = size - 1
+        self.overflow_policy = overflow_policy
+        self.on_full = on_full
+
+        self.items = [None] * size
+        # Slot i is free for sequence s when sequences[i] == s, and holds a
+        # published item for sequence s when sequences[i] == s + 1
+        self.sequences = list(range(size))
+        self.claims = itertools.count()
+        self.head = 0  # Next sequence the consumer reads (consumer-owned)
+        self.tail = 0  # Last published sequence + 1 (approximate, for depth)
+
+        # Consumer parking
+        self.consumer_parked = False
+        self.wakeup = threading.Event()
+
+        # Statistics (approximate under concurrent producers)
+        self.overflows = 0
+        self.backpressure_waits = 0
+        self.high_water_mark = 0
+
+    def put(self, item):
+        """
+        Publish an item
+
+        Returns:
+            bool: False if the ring was full and the policy is 'reject'
+        """
+        if self.tail - self.head >= self.capacity:
+            if self.overflow_policy == self.OVERFLOW_REJECT:
+                self.overflows += 1
+                return False
+            self.backpressure_waits += 1
+            while self.tail - self.head >= self.capacity:
+                self._wait_for_space()
+
+        sequence = next(self.claims)
+        index = sequence & self.mask
+        sequences = self.sequences
+        if sequences[index] != sequence:
+            # Another producer raced past the capacity check; wait for the
+            # consumer to free this slot
+            self.backpressure_waits += 1
+            while sequences[index] != sequence:
+                self._wait_for_space()
+
+        self.items[index] = item
+        sequences[index] = sequence + 1
+        if sequence >= self.tail:
+            self.tail = sequence + 1
+
+        if self.consumer_parked:
+            self.wakeup.set()
+        return True
+
+    def _wait_for_space(self):
+        """Let the consumer (or the on_full hook) free a slot"""
+        if self.on_full is None or not self.on_full():
+            time.sleep(0)  # Yield to the consumer
+
+    def put_many(self, items):
+        """Publish several items; returns the number accepted"""
+        accepted = 0
+        for item in items:
+            if not self.put(item):
+                break
+            accepted += 1
+        return accepted
+
+    def drain(self, max_n):
+        """
+        Take up to max_n published items in one pass (consumer only)
+
+        Returns:
+            list: Items in publish order, empty if none are ready
+        """
+        items = self.items
+        sequences = self.sequences
+        mask = self.mask
+        capacity = self.capacity
+        head = self.head
+        batch = []
+
+        while len(batch) < max_n:
+            index = head & mask
+            if sequences[index] != head + 1:
+                break  # Next item not published yet
+            batch.append(items[index])
+            items[index] = None
+            sequences[index] = head + capacity  # Free the slot for the next lap
+            head += 1
+
+        if batch:
+            depth = self.tail - self.head
+            if depth > self.high_water_mark:
+                self.high_water_mark = depth
+            self.head = head
+        return batch
+
+    def has_items(self):
+        """Check if the next item is ready to be drained"""
+        head = self.head
+        return self.sequences[head & self.mask] == head + 1
+
+    def wait_for_items(self, timeout):
+        """
+        Park the consumer until a producer publishes or the timeout expires
+
+        Returns:
+            bool: True if items are ready
+        """
+        self.consumer_parked = True
+        try:
+            if self.has_items():
+                return True
+            self.wakeup.wait(timeout)
+            self.wakeup.clear()
+            return self.has_items()
+        finally:
+            self.consumer_parked = False
+
+    def wake(self):
+        """Wake a parked consumer (used on shutdown)"""
+        self.wakeup.set()
+
+    def __len__(self):
+        """Approximate number of items waiting"""
+        return max(0, self.tail - self.head)
+
+    def get_statistics(self):
+        """Get ring occupancy and overflow counters"""
+        return {
+            'capacity': self.capacity,
+            'depth': len(self),
+            'high_water_mark': self.high_water_mark,
+            'enqueued': self.tail,
+            'dequeued': self.head,
+            'overflows': self.overflows,
+            'backpressure_waits': self.backpressure_waits
+        }
@@ -0,0 +1,174 @@
+import mmap
+import os
+import struct
+import tempfile
+import time
+
+_COUNTER = struct.Struct('<Q')
+
+
+def shared_memory_directory():
+    """Directory for shared ring and stats files (RAM-backed where available)"""
+    return '/dev/shm' if os.path.isdir('/dev/shm') else tempfile.gettempdir()
+
+
+class SharedRing:
+    """
+    Bounded single-producer/single-consumer ring of fixed-size records
+    shared between processes
+
+    The ring lives in a memory-mapped file: two counters on separate cache
+    lines (head, written only by the producer; tail, written only by the
+    consumer) followed by the slots. The producer writes records and then
+    publishes them with one head store; the consumer copies what is
+    published and frees it with one tail store. No lock is shared between
+    the processes; ordering relies on the platform's store ordering
+    (x86-64 and the interpreter's own barriers between the two stores).
+    Several threads of the producing process must serialize their puts.
+    """
+
+    HEADER_SIZE = 128
+    HEAD_OFFSET = 0
+    TAIL_OFFSET = 64
+
+    # Consumer back-off while waiting for records (seconds)
+    MAX_IDLE_SLEEP = 0.001
+
+    def __init__(self, path, record_size, capacity=65536, create=False):
+        """
+        Map a ring file
+
+        Args:
+            path (str): Ring file (created and zeroed if create is True)
+            record_size (int): Bytes per record
+            capacity (int): Number of slots, rounded up to a power of two
+            create (bool): Create the file (the side that owns the ring)
+        """
+        size = 1
+        while size < capacity:
+            size <<= 1
+        self.path = path
+        self.record_size = record_size
+        self.capacity = size
+        self.mask = size - 1
+        file_size = self.HEADER_SIZE + record_size * size
+
+        if create:
+            with open(path, 'wb') as f:
+                f.truncate(file_size)
+        with open(path, 'r+b') as f:
+            self.map = mmap.mmap(f.fileno(), file_size)
+        self.buffer = memoryview(self.map)
+
+        # Statistics (of this process's side)
+        self.backpressure_waits = 0
+        self.high_water_mark = 0
+
+    def _load(self, offset):
+        return _COUNTER.unpack_from(self.buffer, offset)[0]
+
+    def _store(self, offset, value):
+        _COUNTER.pack_into(self.buffer, offset, value)
+
+    def put_many(self, pack_into, items, on_full=None):
+        """
+        Write records and publish them (producer only)
+
+        Blocks while the ring is full, publishing what was written so far
+        so the consumer can make room.
+
+        Args:
+            pack_into (callable): pack_into(buffer, offset, item) writes one
+                record of at most record_size bytes
+            items (iterable): Items to write, in order
+            on_full (callable): Called on each round of waiting for room;
+                it may do other work (e.g. drain the reply ring the
+                consumer is blocked on) or raise to give up
+
+        Returns:
+            int: Number of records written
+        """
+        buffer = self.buffer
+        record_size = self.record_size
+        mask = self.mask
+        capacity = self.capacity
+        header_size = self.HEADER_SIZE
+        head = self._load(self.HEAD_OFFSET)
+        tail = self._load(self.TAIL_OFFSET)
+        written = 0
+
+        for item in items:
+            if head - tail >= capacity:
+                self._store(self.HEAD_OFFSET, head)
+                self.backpressure_waits += 1
+                while head - tail >= capacity:
+                    if on_full is not None:
+                        on_full()
+                    time.sleep(0)  # Yield to the consumer
+                    tail = self._load(self.TAIL_OFFSET)
+            pack_into(buffer, header_size + (head & mask) * record_size, item)
+            head += 1
+            written += 1
+
+        self._store(self.HEAD_OFFSET, head)
+        depth = head - tail
+        if depth > self.high_water_mark:
+            self.high_water_mark = depth
+        return written
+
+    def drain(self, max_n):
+        """
+        Copy out up to max_n published records (consumer only)
+
+        Returns:
+            bytes: The records back to back (empty if none are ready)
+        """
+        head = self._load(self.HEAD_OFFSET)
+        tail = self._load(self.TAIL_OFFSET)
+        count = min(head - tail, max_n)
+        if count <= 0:
+            return b''
+
+        record_size = self.record_size
+        start = self.HEADER_SIZE + (tail & self.mask) * record_size
+        first = min(count, self.capacity - (tail & self.mask))
+        data = bytes(self.buffer[start:start + first * record_size])
+        if first < count:
+            # Wrapped: the rest starts at slot 0
+            data += bytes(self.buffer[self.HEADER_SIZE:self.HEADER_SIZE +
+                                      (count - first) * record_size])
+        self._store(self.TAIL_OFFSET, tail + count)
+        return data
+
+    def wait_for_records(self, idle_rounds):
+        """
+        Back off while the ring is empty (consumer only)
+
+        Args:
+            idle_rounds (int): Consecutive empty drains so far; the sleep
+                grows with it up to MAX_IDLE_SLEEP
+        """
+        if idle_rounds < 16:
+            time.sleep(0)
+        else:
+            time.sleep(min(self.MAX_IDLE_SLEEP, 1e-5 * (idle_rounds - 15)))
+
+    def __len__(self):
+        """Number of records published but not yet drained"""
+        return self._load(self.HEAD_OFFSET) - self._load(self.TAIL_OFFSET)
+
+    def get_statistics(self):
+        """Get ring occupancy counters"""
+        return {
+            'capacity': self.capacity,
+            'depth': len(self),
+            'high_water_mark': self.high_water_mark,
+            'enqueued': self._load(self.HEAD_OFFSET),
+            'dequeued': self._load(self.TAIL_OFFSET),
+            'backpressure_waits': self.backpressure_waits
+        }
+
+    def close(self):
+        """Unmap the ring (the file is removed by its owner)"""
+        self.buffer.release()
+        self.map.close()
@@ -0,0 +1,315 @@
+"""
+Order book snapshots and snapshot + journal-tail recovery
+
+A snapshot holds every resting order (in priority order per book side),
+the engine's ID counters and, per shard, the journal sequence the copy is
+consistent with. Each shard is copied under its own orders_lock, so only
+that shard waits while its books are read, and the file is written after
+every lock is released. Recovery loads the newest snapshot into a fresh
+engine and replays only the journal records after each shard's sequence,
+so restart time follows book size rather than session length.
+
+Orders sealed in a batch auction are saved in arrival order and go back
+into the symbol's auction on load (or through the ingress ring if the
+restored engine matches that symbol continuously).
+
+Trade history, tapes and bars are not part of a snapshot; they restart
+with the trades the journal tail regenerates.
+"""
+import itertools
+import os
+import pickle
+import threading
+from contextlib import contextmanager
+
+from models.order import (OrderSide, OrderStatus, monotonic_ns_to_wall_ns,
+                          wall_ns_to_monotonic_ns)
+from models.journal import JournalReader
+
+SNAPSHOT_VERSION = 1
+
+
+def snapshot_files(directory):
+    """Get a directory's snapshot files, oldest first"""
+    if not os.path.isdir(directory):
+        return []
+    return sorted(
+        os.path.join(directory, name) for name in os.listdir(directory)
+        if name.startswith('snapshot-') and name.endswith('.snap'))
+
+
+def _order_record(order):
+    return (order.order_id, order.trader_id, order.quantity, order.price_ticks,
+            order.original_quantity, order.filled_quantity,
+            order.filled_notional, monotonic_ns_to_wall_ns(order.timestamp_ns))
+
+
+def _side_records(side):
+    """Compact tuples for a book side's resting orders, in priority order"""
+    return [_order_record(order) for order in side.get_resting_orders()]
+
+
+def _sealed_records(auction):
+    """(is buy, order tuple) for an auction's sealed orders, in arrival order"""
+    return [(order.side is OrderSide.BUY, _order_record(order))
+            for order in auction.pending.values()]
+
+
+def take_snapshot(engine):
+    """
+    Copy the engine's books, one shard at a time
+
+    Args:
+        engine: TradingEngine (may be running)
+
+    Returns:
+        dict: Snapshot contents (see write_snapshot)
+    """
+    journal = engine.journal
+    shards = []
+    for shard in engine.shards:
+        with shard.orders_lock:
+            # Every journal record this shard wrote is at or before this
+            # sequence, and none after it is reflected in its books
+            sequence = journal.last_sequence if journal is not None else None
+            books = {}
+            for symbol in sorted(shard.symbols):
+                orderbook = engine.orderbooks.get(symbol)
+                if orderbook is not None:
+                    books[symbol] = (orderbook.tick_size,
+                                     _side_records(orderbook.bids),
+                                     _side_records(orderbook.asks))
+            sealed = {symbol: _sealed_records(auction)
+                      for symbol, auction in shard.auctions.items()
+                      if auction.pending}
+        shards.append({'sequence': sequence, 'books': books, 'sealed': sealed})
+
+    # Taken after the copies so they are above every copied ID (one value
+    # of each counter is skipped)
+    return {
+        'version': SNAPSHOT_VERSION,
+        'created_ns': engine.clock.time_ns(),
+        'next_order_id': next(engine.order_ids),
+        'next_trade_id': next(engine.trade_ids),
+        'shards': shards
+    }
+
+
+def write_snapshot(engine, directory):
+    """
+    Take a snapshot and write it to directory
+
+    The file is written under a temporary name and renamed into place, so
+    a crash mid-write never leaves a partial newest snapshot.
+
+    Returns:
+        str: Path of the snapshot file
+    """
+    snapshot = take_snapshot(engine)
+    sequences = [shard['sequence'] or 0 for shard in snapshot['shards']]
+    os.makedirs(directory, exist_ok=True)
+    path = os.path.join(
+        directory,
+        f"snapshot-{min(sequences, default=0):020d}-{snapshot['created_ns']}.snap")
+    temporary = path + '.tmp'
+    with open(temporary, 'wb') as f:
+        pickle.dump(snapshot, f, protocol=pickle.HIGHEST_PROTOCOL)
+        f.flush()
+        os.fsync(f.fileno())
+    os.replace(temporary, path)
+    return path
+
+
+def load_snapshot(engine, path):
+    """
+    Restore a snapshot's books into a stopped, empty engine
+
+    Orders are re-rested in their saved priority order and re-indexed by
+    the shard that owns their symbol in this engine, which may have a
+    different shard count than the one that wrote the snapshot.
+
+    Returns:
+        dict: Restored order count, the oldest shard's journal sequence
+            ('sequence', None if the snapshot was taken without a journal)
+            and the symbol -> journal sequence map
+    """
+    if engine.is_running:
+        raise RuntimeError("load_snapshot requires a stopped engine")
+    if engine.orderbooks:
+        raise RuntimeError("load_snapshot requires an engine without books")
+
+    with open(path, 'rb') as f:
+        snapshot = pickle.load(f)
+    if snapshot.get('version') != SNAPSHOT_VERSION:
+        raise ValueError(f"Unsupported snapshot version in {path}")
+
+    pool = engine.order_pool
+
+    def restore(record, symbol, side, orderbook):
+        (order_id, trader_id, quantity, price_ticks, original_quantity,
+         filled_quantity, filled_notional, timestamp_ns) = record
+        order = pool.acquire(trader_id, symbol, side, quantity,
+                             orderbook.ticks_to_price(price_ticks))
+        order.order_id = order_id
+        order.price_ticks = price_ticks
+        order.original_quantity = original_quantity
+        order.filled_quantity = filled_quantity
+        order.filled_notional = filled_notional
+        order.timestamp_ns = wall_ns_to_monotonic_ns(timestamp_ns)
+        if filled_quantity:
+            order.status = OrderStatus.PARTIALLY_FILLED
+        return order
+
+    restored = 0
+    symbol_sequences = {}
+    for shard_snapshot in snapshot['shards']:
+        for symbol, (tick_size, bids, asks) in shard_snapshot['books'].items():
+            if shard_snapshot['sequence'] is not None:
+                symbol_sequences[symbol] = shard_snapshot['sequence']
+            if symbol not in engine.tick_sizes:
+                engine.set_tick_size(symbol, tick_size)
+            orderbook = engine.get_orderbook(symbol)
+            shard = engine.get_shard(symbol)
+
+            with shard.orders_lock:
+                for side, records in ((OrderSide.BUY, bids),
+                                      (OrderSide.SELL, asks)):
+                    for record in records:
+                        order = restore(record, symbol, side, orderbook)
+                        shard._track(order)
+                        orderbook.add_order(order)
+                        restored += 1
+
+        for symbol, records in shard_snapshot.get('sealed', {}).items():
+            orderbook = engine.get_orderbook(symbol)
+            shard = engine.get_shard(symbol)
+            orders = [restore(record, symbol,
+                              OrderSide.BUY if is_buy else OrderSide.SELL,
+                              orderbook) for is_buy, record in records]
+            restored += len(orders)
+            with shard.orders_lock:
+                auction = shard.auctions.get(symbol)
+                if auction is not None:
+                    for order in orders:
+                        shard._track(order)
+                        auction.collect(order, engine.clock.monotonic_ns())
+                    continue
+            shard.submit_many(orders)
+
+    engine.order_ids = itertools.count(snapshot['next_order_id'])
+    engine.trade_ids = itertools.count(snapshot['next_trade_id'])
+    sequences = [shard['sequence'] for shard in snapshot['shards']]
+    return {
+        'orders_restored': restored,
+        'sequence': None if None in sequences else min(sequences, default=0),
+        'symbol_sequences': symbol_sequences
+    }
+
+
+@contextmanager
+def _journal_detached(engine):
+    """Stop the engine's journal from re-recording replayed records"""
+    journal = engine.journal
+    engine.journal = None
+    for shard in engine.shards:
+        shard.journal = None
+    try:
+        yield
+    finally:
+        engine.journal = journal
+        for shard in engine.shards:
+            shard.journal = journal
+
+
+def recover(engine, snapshot_directory, journal_directory=None):
+    """
+    Rebuild a stopped, empty engine from the newest snapshot and journal tail
+
+    Without a snapshot the whole journal is replayed. The engine's own
+    journal (typically reopened on journal_directory, so it continues after
+    the last record) is detached while the tail is replayed.
+
+    Args:
+        engine: Stopped TradingEngine without books
+        snapshot_directory (str): Directory written by write_snapshot
+        journal_directory (str): Journal to replay the tail from, if any
+
+    Returns:
+        dict: Snapshot used, orders restored and journal replay counts
+    """
+    result = {'snapshot': None, 'orders_restored': 0, 'replay': None}
+    symbol_sequences = {}
+    after_sequence = 0
+
+    snapshots = snapshot_files(snapshot_directory)
+    if snapshots:
+        result['snapshot'] = snapshots[-1]
+        loaded = load_snapshot(engine, snapshots[-1])
+        result['orders_restored'] = loaded['orders_restored']
+        symbol_sequences = loaded['symbol_sequences']
+        after_sequence = loaded['sequence']
+        if after_sequence is None and journal_directory is not None:
+            raise ValueError(f"{snapshots[-1]} was taken without a journal; "
+                             "its position in the journal is unknown")
+
+    if journal_directory is not None:
+        with _journal_detached(engine):
+            result['replay'] = JournalReader(journal_directory).replay(
+                engine, after_sequence, symbol_sequences)
+    return result
+
+
+class SnapshotScheduler:
+    """Writes a snapshot every interval from a background thread"""
+
+    def __init__(self, engine, directory, interval_seconds=60.0, keep=3):
+        """
+        Initialize the scheduler
+
+        Args:
+            engine: TradingEngine to snapshot
+            directory (str): Directory for snapshot files
+            interval_seconds (float): Seconds between snapshots
+            keep (int): Newest snapshot files kept; older ones are deleted
+        """
+        self.engine = engine
+        self.directory = directory
+        self.interval_seconds = interval_seconds
+        self.keep = max(1, keep)
+        self.snapshots_written = 0
+        self.last_path = None
+        self.is_running = False
+        self.thread = None
+        self.wakeup = threading.Event()
+
+    def start(self):
+        """Start writing snapshots"""
+        if not self.is_running:
+            self.is_running = True
+            self.wakeup.clear()
+            self.thread = threading.Thread(target=self._run,
+                                           name="snapshot-writer",
+                                           daemon=True)
+            self.thread.start()
+
+    def stop(self):
+        """Stop the background thread"""
+        self.is_running = False
+        self.wakeup.set()
+        if self.thread and self.thread.is_alive():
+            self.thread.join(timeout=5.0)
+
+    def _run(self):
+        while self.is_running and not self.wakeup.wait(self.interval_seconds):
+            try:
+                self.snapshot_now()
+            except Exception as e:
+                print(f"Error writing snapshot: {e}")
+
+    def snapshot_now(self):
+        """Write a snapshot immediately and prune old ones"""
+        self.last_path = write_snapshot(self.engine, self.directory)
+        self.snapshots_written += 1
+        for path in snapshot_files(self.directory)[:-self.keep]:
+            os.remove(path)
+        return self.last_path
@@ -0,0 +1,295 @@
+"""
+Published stats surface for dashboards and monitors
+
+Engine statistics, the market summary, top-of-book levels, recent trades
+and trader P&L are gathered into one block by a background thread on a
+fixed cadence. Readers take the latest block without acquiring any engine
+lock, so the cost to matching depends on the publish interval, not on how
+often or by how many readers the stats are viewed.
+
+While the publisher thread runs, each book's copied top levels are also
+handed to the book itself (see OrderBook.publish_levels), so its own query
+methods answer other threads from the copy instead of taking the matching
+thread's lock; a copy is never more than one interval old. Engines on a
+virtual clock keep reading their live books, so replays stay
+deterministic.
+
+In process, blocks are double-buffered: each is built off to the side
+and then swapped in with one reference assignment, so a reader always
+holds a complete, self-consistent block (treat it as read-only). For
+other processes the block can also be written as JSON into a
+memory-mapped file guarded by a seqlock: the writer makes the sequence
+odd, writes the payload and makes it even again, and a reader retries
+until it sees the same even sequence before and after its copy.
+"""
+import json
+import mmap
+import os
+import struct
+import threading
+import time
+from datetime import datetime
+
+# Seqlock header of the shared file: sequence, payload length
+SHARED_HEADER = struct.Struct('<QQ')
+DEFAULT_SHARED_CAPACITY = 1 << 20
+
+
+def _json_default(value):
+    if isinstance(value, datetime):
+        return value.isoformat()
+    return str(value)
+
+
+class StatsSurface:
+    """Publishes a versioned stats block for lock-free readers"""
+
+    def __init__(self,
+                 engine,
+                 interval_seconds=0.25,
+                 top_levels=5,
+                 recent_trades=20,
+                 traders=None,
+                 shared_path=None,
+                 shared_capacity=DEFAULT_SHARED_CAPACITY):
+        """
+        Initialize the surface (nothing is published until start or
+        publish_now)
+
+        Args:
+            engine: TradingEngine to read
+            interval_seconds (float): Seconds between published blocks
+            top_levels (int): Book levels per side included per symbol
+            recent_trades (int): Recent trades included
+            traders (list): Traders to report (None for the engine's
+                registered traders)
+            shared_path (str): File to also publish into for other processes
+            shared_capacity (int): Size of the shared file in bytes
+        """
+        self.engine = engine
+        self.interval_seconds = interval_seconds
+        self.top_levels = top_levels
+        self.recent_trades = recent_trades
+        self.traders = traders
+        self.block = None  # Latest published block (swapped, never mutated)
+        self.version = 0
+        self.build_seconds = 0.0
+        self.oversized_blocks = 0
+
+        self.shared_path = shared_path
+        self.shared = None
+        if shared_path is not None:
+            with open(shared_path, 'wb') as f:
+                f.truncate(shared_capacity)
+            with open(shared_path, 'r+b') as f:
+                self.shared = mmap.mmap(f.fileno(), shared_capacity)
+
+        self.publish_lock = threading.Lock()  # Serializes publishers only
+        self.is_running = False
+        self.thread = None
+        self.wakeup = threading.Event()
+
+    def start(self):
+        """Start publishing every interval"""
+        if not self.is_running:
+            self.is_running = True
+            self.wakeup.clear()
+            self.thread = threading.Thread(target=self._run,
+                                           name="stats-surface",
+                                           daemon=True)
+            self.thread.start()
+
+    def stop(self):
+        """
+        Stop the publisher thread (the last block stays readable; book
+        queries go back to the live books)
+        """
+        self.is_running = False
+        self.wakeup.set()
+        if self.thread and self.thread.is_alive():
+            self.thread.join(timeout=2.0)
+        with self.publish_lock:
+            for orderbook in list(self.engine.orderbooks.values()):
+                orderbook.unpublish_levels()
+
+    def close(self):
+        """Stop publishing and unmap the shared file"""
+        self.stop()
+        if self.shared is not None:
+            self.shared.close()
+            self.shared = None
+
+    def _run(self):
+        while self.is_running:
+            try:
+                self.publish_now()
+            except Exception as e:
+                print(f"Error publishing stats: {e}")
+            self.wakeup.wait(self.interval_seconds)
+
+    def read(self):
+        """
+        Get the latest block without touching engine locks
+
+        Returns:
+            dict: Published block, or None before the first publish
+        """
+        return self.block
+
+    def publish_now(self):
+        """
+        Build and publish a block immediately
+
+        Returns:
+            dict: The published block
+        """
+        with self.publish_lock:
+            build_start = time.perf_counter()
+            block = self._build(self.version + 1)
+            self.build_seconds = time.perf_counter() - build_start
+            self.block = block
+            self.version = block['version']
+            if self.shared is not None:
+                self._write_shared(block)
+            return block
+
+    def _build(self, version):
+        engine = self.engine
+        versions = engine.get_versions(self.traders)
+        publish_levels = self.is_running and not engine.clock.is_virtual
+        previous = self.block
+        orderbooks = {}
+        for symbol, orderbook in list(engine.orderbooks.items()):
+            book_version = versions['books'].get(symbol)
+            if (previous is not None and symbol in previous['orderbooks'] and
+                    previous['versions']['books'].get(symbol) == book_version):
+                # Unchanged since the last block: reuse it, skip the lock
+                entry = orderbooks[symbol] = previous['orderbooks'][symbol]
+                if publish_levels and orderbook.published is None:
+                    orderbook.publish_levels(entry['bids'], entry['asks'],
+                                             entry['bid_totals'],
+                                             entry['ask_totals'])
+                continue
+            # One hold of the owning shard's lock per book
+            with orderbook.lock:
+                bids = orderbook.bids.get_top_levels(self.top_levels,
+                                                     include_orders=False)
+                asks = orderbook.asks.get_top_levels(self.top_levels,
+                                                     include_orders=False)
+                # (levels, orders, volume) per side
+                totals = [(side.get_level_count(), side.get_order_count(),
+                           side.get_total_volume())
+                          for side in (orderbook.bids, orderbook.asks)]
+            for level in bids + asks:
+                level.pop('orders', None)
+            orderbooks[symbol] = {
+                'bids': bids,
+                'asks': asks,
+                'bid_totals': totals[0],
+                'ask_totals': totals[1]
+            }
+            if publish_levels:
+                orderbook.publish_levels(bids, asks, totals[0], totals[1])
+
+        # After the books, so their summaries read this block's levels
+        market_summary = engine.get_market_summary()
+        marks = engine.get_marks()
+
+        traders = []
+        for trader in list(self.traders if self.traders is not None else
+                            engine.traders.values()):
+            portfolio_value = trader.get_portfolio_value(marks)
+            traders.append({
+                'trader_id': trader.trader_id,
+                'cash': trader.cash,
+                'portfolio_value': portfolio_value,
+                'total_pnl': portfolio_value - trader.initial_cash,
+                'realized_pnl': trader.get_realized_pnl(),
+                'orders_sent': trader.orders_sent,
+                'orders_filled': trader.orders_filled,
+                'total_volume': trader.total_volume,
+                'positions': dict(trader.positions),
+                'fill_rate': trader.orders_filled / max(1, trader.orders_sent)
+            })
+
+        return {
+            'version': version,
+            'published_ns': engine.clock.time_ns(),
+            'versions': versions,
+            'performance': engine.get_performance_stats(),
+            'market_summary': market_summary,
+            'orderbooks': orderbooks,
+            'recent_trades': engine.get_recent_trades(self.recent_trades),
+            'traders': traders
+        }
+
+    def _write_shared(self, block):
+        """Write a block into the shared file under the seqlock"""
+        payload = json.dumps(block, default=_json_default).encode()
+        shared = self.shared
+        if SHARED_HEADER.size + len(payload) > len(shared):
+            self.oversized_blocks += 1
+            return
+        sequence, _ = SHARED_HEADER.unpack_from(shared, 0)
+        struct.pack_into('<Q', shared, 0, sequence + 1)  # Odd: write in progress
+        shared[SHARED_HEADER.size:SHARED_HEADER.size + len(payload)] = payload
+        struct.pack_into('<Q', shared, 8, len(payload))
+        struct.pack_into('<Q', shared, 0, sequence + 2)
+
+    def get_statistics(self):
+        """Get publisher counters"""
+        return {
+            'version': self.version,
+            'interval_seconds': self.interval_seconds,
+            'build_ms': self.build_seconds * 1000,
+            'oversized_blocks': self.oversized_blocks
+        }
+
+
+class SharedStatsReader:
+    """Reads blocks a StatsSurface publishes into a shared file"""
+
+    # Retries before giving up on a block that keeps changing mid-copy
+    MAX_RETRIES = 1000
+
+    def __init__(self, path):
+        """
+        Map a shared stats file read-only
+
+        Args:
+            path (str): StatsSurface shared_path
+        """
+        self.path = path
+        with open(path, 'rb') as f:
+            self.shared = mmap.mmap(f.fileno(), os.fstat(f.fileno()).st_size,
+                                    access=mmap.ACCESS_READ)
+        self.retries = 0
+
+    def read(self):
+        """
+        Copy the latest block
+
+        Returns:
+            dict: Decoded block, or None if nothing was published yet
+
+        Raises:
+            TimeoutError: If no consistent copy was seen within MAX_RETRIES
+        """
+        shared = self.shared
+        header_size = SHARED_HEADER.size
+        for _ in range(self.MAX_RETRIES):
+            sequence, length = SHARED_HEADER.unpack_from(shared, 0)
+            if sequence & 1:
+                self.retries += 1
+                time.sleep(0)
+                continue
+            payload = shared[header_size:header_size + length]
+            if SHARED_HEADER.unpack_from(shared, 0)[0] != sequence:
+                self.retries += 1
+                continue
+            return json.loads(payload) if sequence else None
+        raise TimeoutError(f"No consistent stats block in {self.path}")
+
+    def close(self):
+        """Unmap the file"""
+        self.shared.close()
@@ -0,0 +1,249 @@
+"""
+Columnar trade store
+
+Every trade is appended as one slot in a set of typed arrays rather than
+as a dict, in fixed-size chunks that are allocated up front and never
+resized. A reader can therefore take buffer views of the filled prefix of
+each chunk (numpy arrays, Arrow buffers) without copying while matching
+keeps appending. Symbol and trader IDs are dictionary-encoded.
+"""
+from array import array
+from datetime import datetime
+
+# Rows per chunk (also the row count of each exported record batch)
+DEFAULT_CHUNK_ROWS = 65536
+
+# Column name -> array typecode
+COLUMNS = (
+    ('sequence', 'q'),
+    ('timestamp_ns', 'q'),  # Wall-clock ns (the engine clock's time_ns)
+    ('symbol', 'i'),  # Code into symbols
+    ('side', 'b'),  # Aggressor side: 0 BUY, 1 SELL
+    ('quantity', 'q'),
+    ('price_ticks', 'q'),
+    ('price', 'd'),
+    ('buy_order_id', 'q'),
+    ('sell_order_id', 'q'),
+    ('buyer', 'i'),  # Code into traders
+    ('seller', 'i'),  # Code into traders
+)
+
+COLUMN_NAMES = tuple(name for name, _ in COLUMNS)
+
+SIDES = ('BUY', 'SELL')
+
+
+class TradeColumns:
+    """
+    Append-only columnar trade buffers for one writer
+
+    Each matching shard owns one and appends from its matching thread;
+    readers take consistent views with batches() at any time. About 80
+    bytes per trade; a TradeStore spills full chunks beyond its hot window
+    to disk and drops them from self.chunks (see models.trade_store).
+    """
+
+    def __init__(self, chunk_rows=DEFAULT_CHUNK_ROWS):
+        """
+        Initialize empty buffers
+
+        Args:
+            chunk_rows (int): Rows per preallocated chunk
+        """
+        self.chunk_rows = chunk_rows
+        self.chunks = []  # Full chunks: tuple of arrays in COLUMNS order
+        self.current = None
+        self.current_rows = 0
+        self.rows = 0
+
+        # Dictionaries (append-only, so codes stay valid for readers)
+        self.symbols = []
+        self.symbol_codes = {}
+        self.tick_sizes = []  # Symbol code -> tick size (to decode spills)
+        self.traders = []
+        self.trader_codes = {}
+
+    def _new_chunk(self):
+        rows = self.chunk_rows
+        return tuple(
+            array(typecode, bytes(array(typecode).itemsize * rows))
+            for _, typecode in COLUMNS)
+
+    def _symbol_code(self, symbol, tick_size):
+        code = self.symbol_codes.get(symbol)
+        if code is None:
+            self.tick_sizes.append(tick_size)
+            code = self.symbol_codes[symbol] = len(self.symbols)
+            self.symbols.append(symbol)
+        return code
+
+    def _trader_code(self, trader_id):
+        code = self.trader_codes.get(trader_id)
+        if code is None:
+            code = self.trader_codes[trader_id] = len(self.traders)
+            self.traders.append(trader_id)
+        return code
+
+    def append(self, sequence, timestamp_ns, symbol, tick_size, side,
+               quantity, price_ticks, price, buy_order_id, sell_order_id,
+               buyer_id, seller_id):
+        """
+        Append one trade
+
+        Args:
+            sequence (int): Global trade sequence
+            timestamp_ns (int): Trade time in wall-clock ns
+            symbol (str): Traded symbol
+            tick_size (float): Tick size of the trade's symbol
+            side (int): Aggressor side, 0 BUY or 1 SELL
+            quantity (int): Quantity traded
+            price_ticks (int): Trade price in ticks
+            price (float): Trade price
+            buy_order_id (int): Buying order
+            sell_order_id (int): Selling order
+            buyer_id (str): Buying trader
+            seller_id (str): Selling trader
+        """
+        chunk = self.current
+        row = self.current_rows
+        if chunk is None or row == self.chunk_rows:
+            # Retire the full chunk before the new one is visible (see
+            # batches for the read order this pairs with)
+            if chunk is not None:
+                self.chunks.append(chunk)
+            self.current_rows = row = 0
+            chunk = self.current = self._new_chunk()
+
+        (sequences, timestamps, symbols, sides, quantities, ticks, prices,
+         buy_ids, sell_ids, buyers, sellers) = chunk
+        sequences[row] = sequence
+        timestamps[row] = timestamp_ns
+        symbols[row] = self._symbol_code(symbol, tick_size)
+        sides[row] = side
+        quantities[row] = quantity
+        ticks[row] = price_ticks
+        prices[row] = price
+        buy_ids[row] = buy_order_id
+        sell_ids[row] = sell_order_id
+        buyers[row] = self._trader_code(buyer_id)
+        sellers[row] = self._trader_code(seller_id)
+
+        # Publish the row only after every column is written
+        self.current_rows = row + 1
+        self.rows += 1
+
+    def filled_chunks(self):
+        """
+        Get the chunks in memory with their filled row counts
+
+        Returns:
+            list: (chunk, row_count) oldest first; rows below row_count are
+                never rewritten
+        """
+        # Read the current chunk before the retired list: a chunk retired
+        # in between is then found full in the list
+        current = self.current
+        current_rows = self.current_rows
+        chunks_rows = [(chunk, self.chunk_rows) for chunk in list(self.chunks)]
+        if current_rows and (not chunks_rows
+                             or chunks_rows[-1][0] is not current):
+            chunks_rows.append((current, current_rows))
+        return chunks_rows
+
+    def batches(self):
+        """
+        Get zero-copy views of every filled row in memory
+
+        Returns:
+            list: (row_count, {column: memoryview}) per chunk, oldest first;
+                views stay valid (and unchanged) while appends continue
+        """
+        return [(rows, chunk_views(chunk, rows))
+                for chunk, rows in self.filled_chunks()]
+
+    def last(self, n):
+        """
+        Get the most recent trades in memory as trade records
+
+        Args:
+            n (int): Number of trades wanted; 0 or less returns every trade
+                still in memory
+
+        Returns:
+            list: Up to n trade dicts, oldest first
+        """
+        chunks_rows = self.filled_chunks()
+        symbols, traders = self.symbols, self.traders  # Append-only
+        trades = []
+        for chunk, rows in reversed(chunks_rows):
+            start = 0 if n <= 0 else max(0, rows - (n - len(trades)))
+            trades[:0] = [trade_record(chunk, row, symbols, traders)
+                          for row in range(start, rows)]
+            if 0 < n <= len(trades):
+                break
+        return trades
+
+    def dictionaries(self):
+        """Get copies of the symbol and trader dictionaries"""
+        return list(self.symbols), list(self.traders)
+
+    def __len__(self):
+        return self.rows
+
+
+def chunk_views(chunk, rows):
+    """Views of a chunk's first rows, keyed by column name"""
+    return {
+        name: memoryview(column)[:rows]
+        for name, column in zip(COLUMN_NAMES, chunk)
+    }
+
+
+def build_trade_record(sequence, timestamp_ns, symbol, side, quantity,
+                       price_ticks, price, buy_order_id, sell_order_id,
+                       buyer_id, seller_id):
+    """
+    Build the trade dict readers and trade subscribers see
+
+    Matching stores trades as columns; this is only called for consumers
+    that take dicts (queries, trade subscribers, the market data feed).
+
+    Returns:
+        dict: Trade record ('side' is the aggressor's, 'timestamp' a datetime)
+    """
+    return {
+        'trade_id': f"{sequence:06d}",
+        'sequence': sequence,
+        'timestamp': datetime.fromtimestamp(timestamp_ns / 1e9),
+        'symbol': symbol,
+        'quantity': quantity,
+        'price': price,
+        'price_ticks': price_ticks,
+        'buyer_id': buyer_id,
+        'seller_id': seller_id,
+        'buy_order_id': buy_order_id,
+        'sell_order_id': sell_order_id,
+        'side': SIDES[side]
+    }
+
+
+def trade_record(chunk, row, symbols, traders):
+    """
+    Rebuild the trade dict for a stored row
+
+    Args:
+        chunk (tuple): Column arrays in COLUMNS order
+        row (int): Row in the chunk
+        symbols (list): Symbol dictionary of the chunk's writer
+        traders (list): Trader dictionary of the chunk's writer
+
+    Returns:
+        dict: Trade record
+    """
+    (sequence, timestamps, symbol_codes, sides, quantities, ticks, prices,
+     buy_ids, sell_ids, buyers, sellers) = chunk
+    return build_trade_record(sequence[row], timestamps[row],
+                              symbols[symbol_codes[row]], sides[row],
+                              quantities[row], ticks[row], prices[row],
+                              buy_ids[row], sell_ids[row],
+                              traders[buyers[row]], traders[sellers[row]])
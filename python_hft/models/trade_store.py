@@ -0,0 +1,366 @@
+"""
+Tiered trade store with spill-to-disk
+
+One store holds every trade of a session, keyed by its global trade
+sequence. Each matching thread appends to its own TradeColumns writer
+(single writer, no lock on the matching path), whose trade sequences
+ascend; queries merge the writers by sequence.
+
+The newest hot_rows trades of each writer stay in memory as column chunks.
+Older full chunks are spilled by a background thread (or by spill() when
+the engine is driven by run_until_idle): each becomes one segment file in
+the binary journal format (see models.journal), holding a header, the
+writer's symbol and trader name records, then one RECORD_STORED_TRADE per
+trade. The chunk is then dropped from memory. Memory stays flat however
+long the session runs. Full-history reads (iter_trades, get_all_trades,
+batches) stream the segments back, so nothing is silently truncated.
+"""
+import bisect
+import heapq
+import os
+import shutil
+import tempfile
+import threading
+import weakref
+from array import array
+from collections import namedtuple
+
+from models.journal import (EVENT_RECORD, HEADER, HEADER_SIZE, JOURNAL_MAGIC,
+                            JOURNAL_VERSION, NAME_RECORD, NAME_RECORDS,
+                            RECORD_SIZE, RECORD_STORED_TRADE, RECORD_SYMBOL,
+                            RECORD_TRADER)
+from models.orderbook import TickScale
+from models.trade_columns import (COLUMNS, DEFAULT_CHUNK_ROWS, TradeColumns,
+                                  chunk_views, trade_record)
+
+# Trades per writer kept in memory (rounded up to whole chunks)
+DEFAULT_HOT_ROWS = 4 * DEFAULT_CHUNK_ROWS
+
+TradeSegment = namedtuple('TradeSegment',
+                          'first_sequence last_sequence rows path')
+
+
+class TradeStore:
+    """Every trade of a session: hot chunks in memory, older ones on disk"""
+
+    # How long the spill thread waits between checks
+    SPILL_INTERVAL_SECONDS = 0.5
+
+    def __init__(self, hot_rows=DEFAULT_HOT_ROWS, directory=None,
+                 chunk_rows=DEFAULT_CHUNK_ROWS):
+        """
+        Initialize an empty store
+
+        Args:
+            hot_rows (int): Trades per writer kept in memory; older full
+                chunks are spilled
+            directory (str): Directory for segment files (None for a
+                temporary directory removed with the store)
+            chunk_rows (int): Rows per column chunk (and per segment)
+        """
+        self.chunk_rows = chunk_rows
+        self.hot_chunks = max(1, -(-hot_rows // chunk_rows))  # Full chunks kept
+        self.directory = directory
+        self.cleanup = None  # Removes a temporary directory
+
+        self.writers = []  # TradeColumns, one per writer thread
+        self.segments = []  # Per writer: TradeSegment list, oldest first
+        # Taken by the spiller to swap a chunk for its segment and by readers
+        # to see one or the other, never neither; writers never take it
+        self.lock = threading.Lock()
+        self.spill_lock = threading.Lock()  # Serializes spillers
+
+        # Statistics
+        self.rows_spilled = 0
+        self.bytes_spilled = 0
+        self.spill_errors = 0
+
+        # Threading
+        self.is_running = False
+        self.thread = None
+        self.wakeup = threading.Event()
+
+    def writer(self):
+        """
+        Add a writer
+
+        Returns:
+            TradeColumns: Column buffers for one matching thread to append to
+        """
+        with self.lock:
+            columns = TradeColumns(self.chunk_rows)
+            self.writers.append(columns)
+            self.segments.append([])
+            return columns
+
+    def start(self):
+        """Start the background spill thread"""
+        if not self.is_running:
+            self.is_running = True
+            self.wakeup.clear()
+            self.thread = threading.Thread(target=self._spill_loop,
+                                           name="trade-store-spill",
+                                           daemon=True)
+            self.thread.start()
+
+    def stop(self):
+        """Stop the spill thread (trades stay readable)"""
+        self.is_running = False
+        self.wakeup.set()
+        if self.thread and self.thread.is_alive():
+            self.thread.join(timeout=2.0)
+
+    def close(self):
+        """Stop spilling and remove a temporary segment directory"""
+        self.stop()
+        if self.cleanup is not None:
+            self.cleanup()
+
+    def _spill_loop(self):
+        while self.is_running:
+            self.wakeup.wait(self.SPILL_INTERVAL_SECONDS)
+            try:
+                self.spill()
+            except Exception as e:
+                self.spill_errors += 1
+                print(f"Error spilling trades: {e}")
+
+    def spill(self):
+        """
+        Write every full chunk beyond the hot window to a segment
+
+        Returns:
+            int: Number of trades spilled
+        """
+        spilled = 0
+        with self.spill_lock:
+            for index, columns in enumerate(list(self.writers)):
+                # The newest retired chunk is never spilled, so the writer's
+                # own retire-then-replace in append never races a removal
+                while len(columns.chunks) > self.hot_chunks:
+                    segment = self._write_segment(index, columns,
+                                                  columns.chunks[0])
+                    with self.lock:
+                        self.segments[index].append(segment)
+                        del columns.chunks[0]
+                    spilled += segment.rows
+        return spilled
+
+    def _segment_directory(self, index):
+        if self.directory is None:
+            self.directory = tempfile.mkdtemp(prefix='hft-trades-')
+            self.cleanup = weakref.finalize(self, shutil.rmtree,
+                                            self.directory, True)
+        directory = os.path.join(self.directory, f"writer-{index}")
+        os.makedirs(directory, exist_ok=True)
+        return directory
+
+    def _write_segment(self, index, columns, chunk):
+        """Write one full chunk as a journal-format file"""
+        rows = self.chunk_rows
+        symbols, traders = columns.dictionaries()
+        tick_sizes = list(columns.tick_sizes)
+        for name in symbols + traders:
+            if len(name.encode()) > 40:
+                raise ValueError(f"Name too long for the journal: {name}")
+
+        # Name IDs are the writer's codes + 1, as journal IDs start at 1
+        names = [
+            NAME_RECORD.pack(RECORD_SYMBOL, 0, 0, code + 1, 0,
+                             tick_sizes[code], symbol.encode())
+            for code, symbol in enumerate(symbols)
+        ] + [
+            NAME_RECORD.pack(RECORD_TRADER, 0, 0, code + 1, 0, 0.0,
+                             trader.encode())
+            for code, trader in enumerate(traders)
+        ]
+
+        (sequence, timestamps, symbol_codes, sides, quantities, ticks, _,
+         buy_ids, sell_ids, buyers, sellers) = chunk
+        buffer = bytearray(rows * RECORD_SIZE)
+        pack_into = EVENT_RECORD.pack_into
+        offset = 0
+        for row in range(rows):
+            pack_into(buffer, offset, RECORD_STORED_TRADE, sides[row], 0,
+                      symbol_codes[row] + 1, sequence[row], timestamps[row],
+                      buy_ids[row], quantities[row], ticks[row],
+                      sell_ids[row], (buyers[row] + 1) << 32 | (sellers[row] + 1))
+            offset += RECORD_SIZE
+
+        header = bytearray(HEADER_SIZE)
+        HEADER.pack_into(header, 0, JOURNAL_MAGIC, JOURNAL_VERSION,
+                         RECORD_SIZE, sequence[0])
+        path = os.path.join(self._segment_directory(index),
+                            f"journal-{sequence[0]:020d}.bin")
+        with open(path, 'wb') as f:
+            f.write(header)
+            f.write(b''.join(names))
+            f.write(buffer)
+        self.rows_spilled += rows
+        self.bytes_spilled += HEADER_SIZE + RECORD_SIZE * len(names) + len(buffer)
+        return TradeSegment(sequence[0], sequence[rows - 1], rows, path)
+
+    def _read_segment(self, index, segment):
+        """Decode a segment file back into a chunk of column arrays"""
+        with open(segment.path, 'rb') as f:
+            data = memoryview(f.read())
+        offset = HEADER_SIZE
+        while offset < len(data) and data[offset] in NAME_RECORDS:
+            offset += RECORD_SIZE
+
+        (_, sides, _, symbol_ids, sequence, timestamps, buy_ids, quantities,
+         ticks, sell_ids, parties) = zip(*EVENT_RECORD.iter_unpack(
+             data[offset:offset + segment.rows * RECORD_SIZE]))
+        scales = [TickScale(tick_size)
+                  for tick_size in list(self.writers[index].tick_sizes)]
+        symbol_codes = [symbol_id - 1 for symbol_id in symbol_ids]
+        values = {
+            'sequence': sequence,
+            'timestamp_ns': timestamps,
+            'symbol': symbol_codes,
+            'side': sides,
+            'quantity': quantities,
+            'price_ticks': ticks,
+            'price': [scales[code].to_price(tick)
+                      for code, tick in zip(symbol_codes, ticks)],
+            'buy_order_id': buy_ids,
+            'sell_order_id': sell_ids,
+            'buyer': [(value >> 32) - 1 for value in parties],
+            'seller': [(value & 0xFFFFFFFF) - 1 for value in parties]
+        }
+        return tuple(array(typecode, values[name]) for name, typecode in COLUMNS)
+
+    def _writer_chunks(self, index, after_sequence=0):
+        """
+        Yield a writer's (chunk, rows) oldest first, decoding spilled ones
+
+        Chunks that end at or before after_sequence are skipped.
+        """
+        columns = self.writers[index]
+        with self.lock:
+            segments = list(self.segments[index])
+            hot = columns.filled_chunks()
+        for segment in segments:
+            if segment.last_sequence > after_sequence:
+                yield self._read_segment(index, segment), segment.rows
+        for chunk, rows in hot:
+            if chunk[0][rows - 1] > after_sequence:
+                yield chunk, rows
+
+    def _writer_trades(self, index, after_sequence, symbol):
+        columns = self.writers[index]
+        code = None
+        if symbol is not None:
+            code = columns.symbol_codes.get(symbol)
+            if code is None:
+                return
+        for chunk, rows in self._writer_chunks(index, after_sequence):
+            # Dictionaries read after the chunk cover every code it holds
+            symbols, traders = columns.symbols, columns.traders
+            sequence, symbol_codes = chunk[0], chunk[2]
+            start = bisect.bisect_right(sequence, after_sequence, 0, rows)
+            for row in range(start, rows):
+                if code is None or symbol_codes[row] == code:
+                    yield trade_record(chunk, row, symbols, traders)
+
+    def iter_trades(self, after_sequence=0, symbol=None):
+        """
+        Iterate trades in sequence order, from disk and memory
+
+        Args:
+            after_sequence (int): Only trades with a larger sequence
+            symbol (str): Only this symbol's trades (None for all)
+
+        Yields:
+            dict: Trade records as MatchingShard._execute_trade builds them
+        """
+        yield from heapq.merge(
+            *(self._writer_trades(index, after_sequence, symbol)
+              for index in range(len(self.writers))),
+            key=lambda trade: trade['sequence'])
+
+    def get_all_trades(self):
+        """Get every trade of the session in sequence order"""
+        return list(self.iter_trades())
+
+    def get_recent_trades(self, count=20):
+        """
+        Get the most recent trades across writers
+
+        Args:
+            count (int): Number of trades wanted; 0 or less returns every
+                trade of the session
+
+        Returns:
+            list: Trades in sequence order, oldest first
+        """
+        if count <= 0:
+            return self.get_all_trades()
+        if len(self.writers) == 1:
+            return self.writers[0].last(count)
+        # Each writer's tail is already in sequence order
+        merged = list(
+            heapq.merge(*(columns.last(count) for columns in list(self.writers)),
+                        key=lambda trade: trade['sequence']))
+        return merged[-count:]
+
+    def get_trade(self, sequence):
+        """
+        Look up one trade by its sequence
+
+        Returns:
+            dict: The trade record, or None if no writer has it
+        """
+        for index, columns in enumerate(list(self.writers)):
+            with self.lock:
+                segments = list(self.segments[index])
+                hot = columns.filled_chunks()
+            for chunk, rows in hot:
+                row = bisect.bisect_left(chunk[0], sequence, 0, rows)
+                if row < rows and chunk[0][row] == sequence:
+                    return trade_record(chunk, row, columns.symbols,
+                                        columns.traders)
+            for segment in segments:
+                if segment.first_sequence <= sequence <= segment.last_sequence:
+                    chunk = self._read_segment(index, segment)
+                    row = bisect.bisect_left(chunk[0], sequence)
+                    if chunk[0][row] == sequence:
+                        return trade_record(chunk, row, columns.symbols,
+                                            columns.traders)
+        return None
+
+    def batches(self):
+        """
+        Get every trade of the session as column views
+
+        Spilled segments are decoded into fresh arrays; chunks in memory
+        are viewed without copying.
+
+        Returns:
+            list: (row_count, {column: memoryview}, symbols, traders) per
+                chunk, as TradingEngine.get_trade_batches documents
+        """
+        batches = []
+        for index, columns in enumerate(list(self.writers)):
+            chunks = list(self._writer_chunks(index))
+            # Dictionaries after the views, so they cover every code
+            symbols, traders = columns.dictionaries()
+            batches.extend((rows, chunk_views(chunk, rows), symbols, traders)
+                           for chunk, rows in chunks)
+        return batches
+
+    def __len__(self):
+        return sum(len(columns) for columns in list(self.writers))
+
+    def get_statistics(self):
+        """Get retention and spill counters"""
+        rows = len(self)
+        return {
+            'trades': rows,
+            'hot_trades': rows - self.rows_spilled,
+            'spilled_trades': self.rows_spilled,
+            'segments': sum(len(segments) for segments in list(self.segments)),
+            'bytes_spilled': self.bytes_spilled,
+            'spill_errors': self.spill_errors,
+            'directory': self.directory
+        }
@@ -0,0 +1,175 @@
+from array import array
+
+from models.trade_columns import build_trade_record
+
+
+class TradeTape:
+    """
+    Fixed-capacity ring of one symbol's recent trades
+
+    Written only by the matching thread that owns the symbol. Trades are
+    kept as columns (one preallocated array per field), so appending one
+    allocates nothing; last() rebuilds trade dicts for readers. Alongside the
+    ring it keeps a running VWAP over the last ``vwap_window`` trades and the
+    last trade price, both in integer ticks, so price discovery reads them
+    in O(1) instead of scanning trade history. The derived figures are
+    published as one tuple so readers on other threads always see a
+    consistent (notional, volume, last price) triple without taking a lock.
+    """
+
+    def __init__(self, symbol, tick_scale, capacity=1000, vwap_window=5):
+        """
+        Initialize the tape
+
+        Args:
+            symbol (str): Symbol the tape records
+            tick_scale (TickScale): The owning book's price/tick conversion
+            capacity (int): Number of trades retained
+            vwap_window (int): Number of most recent trades in the running VWAP
+        """
+        if vwap_window < 1 or vwap_window > capacity:
+            raise ValueError("vwap_window must be between 1 and capacity")
+
+        self.symbol = symbol
+        self.capacity = capacity
+        self.vwap_window = vwap_window
+        self.tick_scale = tick_scale
+        self.count = 0  # Total trades ever appended (next write position)
+
+        # Columns, indexed by count % capacity
+        zeros = bytes(8 * capacity)
+        self.sequences = array('q', zeros)
+        self.timestamps = array('q', zeros)  # Wall-clock ns
+        self.sides = array('b', bytes(capacity))  # Aggressor: 0 BUY, 1 SELL
+        self.quantities = array('q', zeros)
+        self.price_ticks = array('q', zeros)
+        self.buy_order_ids = array('q', zeros)
+        self.sell_order_ids = array('q', zeros)
+        self.buyers = [None] * capacity
+        self.sellers = [None] * capacity
+
+        # Running window sums maintained by the writer
+        self.window_notional_ticks = 0  # sum(price_ticks * quantity)
+        self.window_volume = 0
+
+        # (window_notional_ticks, window_volume, last_price_ticks), replaced
+        # atomically on every append
+        self.summary = (0, 0, None)
+
+    def append(self, sequence, timestamp_ns, side, quantity, price_ticks,
+               buy_order_id, sell_order_id, buyer_id, seller_id):
+        """
+        Record a trade (matching thread only)
+
+        Args:
+            sequence (int): Global trade sequence
+            timestamp_ns (int): Wall-clock trade time in ns
+            side (int): Aggressor side, 0 BUY or 1 SELL
+            quantity (int): Quantity traded
+            price_ticks (int): Trade price in ticks
+            buy_order_id (int): Buying order
+            sell_order_id (int): Selling order
+            buyer_id (str): Buying trader
+            seller_id (str): Selling trader
+        """
+        count = self.count
+        quantities = self.quantities
+        ticks = self.price_ticks
+
+        self.window_notional_ticks += price_ticks * quantity
+        self.window_volume += quantity
+        if count >= self.vwap_window:
+            # Drop the trade that just left the window (read before its
+            # slot is reused when the window spans the whole ring)
+            evicted = (count - self.vwap_window) % self.capacity
+            self.window_notional_ticks -= ticks[evicted] * quantities[evicted]
+            self.window_volume -= quantities[evicted]
+
+        slot = count % self.capacity
+        sequences = self.sequences
+        sequences[slot] = -1  # Readers skip the row while it is rewritten
+        self.timestamps[slot] = timestamp_ns
+        self.sides[slot] = side
+        quantities[slot] = quantity
+        ticks[slot] = price_ticks
+        self.buy_order_ids[slot] = buy_order_id
+        self.sell_order_ids[slot] = sell_order_id
+        self.buyers[slot] = buyer_id
+        self.sellers[slot] = seller_id
+        sequences[slot] = sequence
+
+        # Publish the row only after every column is written
+        self.count = count + 1
+        self.summary = (self.window_notional_ticks, self.window_volume,
+                        price_ticks)
+
+    def last(self, n):
+        """
+        Get the most recent trades
+
+        Args:
+            n (int): Number of trades wanted; 0 or less returns every
+                retained trade
+
+        Returns:
+            list: Up to n trade dicts, oldest first
+        """
+        count = self.count
+        available = min(count, self.capacity)
+        if n <= 0 or n > available:
+            n = available
+        if n == 0:
+            return []
+
+        capacity = self.capacity
+        sequences = self.sequences
+        to_price = self.tick_scale.to_price
+        start = count - n
+        trades = []
+        for position in range(start, count):
+            slot = position % capacity
+            sequence = sequences[slot]
+            row = (self.timestamps[slot], self.sides[slot],
+                   self.quantities[slot], self.price_ticks[slot],
+                   self.buy_order_ids[slot], self.sell_order_ids[slot],
+                   self.buyers[slot], self.sellers[slot])
+            if sequence < 0 or sequences[slot] != sequence:
+                # Being rewritten by an append that started while reading
+                # (only the oldest rows can be); dropped below
+                start = position + 1
+                trades.clear()
+                continue
+            (timestamp_ns, side, quantity, ticks, buy_order_id,
+             sell_order_id, buyer_id, seller_id) = row
+            trades.append(build_trade_record(
+                sequence, timestamp_ns, self.symbol, side, quantity, ticks,
+                to_price(ticks), buy_order_id, sell_order_id, buyer_id,
+                seller_id))
+
+        # Appends completed while reading overwrote the oldest slots read
+        first_intact = self.count - capacity
+        if first_intact > start:
+            return trades[first_intact - start:]
+        return trades
+
+    def get_vwap(self):
+        """Get the VWAP of the last vwap_window trades, or None before any trade"""
+        notional_ticks, volume, _ = self.summary
+        if volume <= 0:
+            return None
+        return notional_ticks * self.tick_scale.tick_size / volume
+
+    def get_last_price(self):
+        """Get the price of the most recent trade, or None before any trade"""
+        last_ticks = self.summary[2]
+        if last_ticks is None:
+            return None
+        return self.tick_scale.to_price(last_ticks)
+
+    def get_last_price_ticks(self):
+        """Get the price of the most recent trade in ticks"""
+        return self.summary[2]
+
+    def __len__(self):
+        """Number of trades currently retained"""
+        return min(self.count, self.capacity)
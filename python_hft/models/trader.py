@@ -2,7 +2,6 @@ import random
 import time
 import threading
 from datetime import datetime
-import numpy as np
 
 from models.order import Order, OrderSide
 
@@ -11,7 +10,7 @@ class Trader:
     Simulated trading bot that generates orders
     """
     
-    def __init__(self, trader_id, initial_cash, symbols, engine):
+    def __init__(self, trader_id, initial_cash, symbols, engine, seed=None):
         """
         Initialize a trading bot
         
@@ -20,21 +19,28 @@ class Trader:
             initial_cash (float): Starting cash amount
             symbols (list): List of symbols to trade
             engine: Reference to the trading engine
+            seed (int): Seed for this trader's random decisions (a Simulation
+                assigns one so runs are reproducible)
         """
         self.trader_id = trader_id
         self.initial_cash = initial_cash
         self.cash = initial_cash
         self.symbols = symbols
         self.engine = engine
+        self.rng = random.Random(seed)
         
-        # Portfolio tracking
+        # Portfolio tracking (updated per fill; valuation only applies marks)
         self.positions = {symbol: 0 for symbol in symbols}  # Share positions
         self.average_costs = {symbol: 0.0 for symbol in symbols}  # Average cost basis
+        self.realized_pnl = {symbol: 0.0 for symbol in symbols}  # Closed P&L
+        self.version = 0  # Bumped on every fill (position or cash change)
         
         # Trading statistics
         self.orders_sent = 0
         self.orders_filled = 0
         self.total_volume = 0
+        self.last_fill_sequence = 0  # Sequence of the last fill event received
+        self.fill_sequence_gaps = 0
         
         # Trading parameters (optimized for HFT)
         self.min_order_size = 10
@@ -65,7 +71,7 @@ class Trader:
         while self.is_active:
             try:
                 # Random delay between orders
-                delay = np.random.exponential(self.order_frequency)
+                delay = self.next_order_delay()
                 time.sleep(delay)
                 
                 if not self.is_active:
@@ -73,18 +79,22 @@ class Trader:
                 
                 # Generate a random order
                 self._generate_order()
-                
+            
             except Exception as e:
                 print(f"Error in trading loop for {self.trader_id}: {e}")
                 time.sleep(1)  # Brief pause on error
     
+    def next_order_delay(self):
+        """Draw the seconds until this trader's next order (exponential gaps)"""
+        return self.rng.expovariate(1.0 / self.order_frequency)
+    
     def _generate_order(self):
         """Generate and submit a random order"""
         if not self.symbols:
             return
         
         # Choose random symbol
-        symbol = random.choice(self.symbols)
+        symbol = self.rng.choice(self.symbols)
         
         # Get current market price estimate
         market_price = self._estimate_market_price(symbol)
@@ -93,10 +103,10 @@ class Trader:
         side = self._decide_order_side(symbol)
         
         # Generate order parameters
-        quantity = random.randint(self.min_order_size, self.max_order_size)
+        quantity = self.rng.randint(self.min_order_size, self.max_order_size)
         
         # Generate price with some randomness around market price
-        price_variation = random.gauss(0, self.price_volatility)
+        price_variation = self.rng.gauss(0, self.price_volatility)
         
         if side == OrderSide.BUY:
             # Buyers typically bid below market price
@@ -105,8 +115,8 @@ class Trader:
             # Sellers typically ask above market price
             price = market_price * (1 + abs(price_variation))
         
-        # Round price to 2 decimal places
-        price = round(price, 2)
+        # Round price to the symbol's tick size
+        price = self.engine.get_orderbook(symbol).round_price(price)
         
         # Check if we can afford the order (for buy orders)
         if side == OrderSide.BUY and quantity * price > self.cash:
@@ -122,33 +132,29 @@ class Trader:
                 return  # Not enough shares to sell
             quantity = self.positions[symbol]
         
-        # Create and submit order
-        order = Order(self.trader_id, symbol, side, quantity, price)
+        # Create and submit order (recycled through the engine's order pool)
+        order = self.engine.create_order(self.trader_id, symbol, side, quantity, price)
         self.engine.submit_order(order)
         self.orders_sent += 1
     
     def _estimate_market_price(self, symbol):
         """Estimate current market price based on recent trades and order book"""
-        # Get recent trades for price discovery
-        recent_trades = self.engine.get_recent_trades_for_symbol(symbol, 5)
-        
-        if recent_trades:
-            # Use volume-weighted average of recent trades
-            total_value = sum(trade['price'] * trade['quantity'] for trade in recent_trades)
-            total_volume = sum(trade['quantity'] for trade in recent_trades)
-            if total_volume > 0:
-                self.market_price_cache[symbol] = total_value / total_volume
+        orderbook = self.engine.get_orderbook(symbol)
+        
+        # Volume-weighted average of recent trades, kept running by the book
+        recent_vwap = orderbook.get_recent_vwap()
+        
+        if recent_vwap is not None:
+            self.market_price_cache[symbol] = recent_vwap
         else:
             # If no recent trades, use order book mid-price or random walk
-            orderbook = self.engine.get_orderbook(symbol)
-            best_bid = orderbook.get_best_bid()
-            best_ask = orderbook.get_best_ask()
+            mid_price = orderbook.get_mid_price()
             
-            if best_bid and best_ask:
-                self.market_price_cache[symbol] = (best_bid.price + best_ask.price) / 2
+            if mid_price is not None:
+                self.market_price_cache[symbol] = mid_price
             else:
                 # Random walk from current price
-                change = random.gauss(0, 0.01)  # 1% daily volatility
+                change = self.rng.gauss(0, 0.01)  # 1% daily volatility
                 self.market_price_cache[symbol] *= (1 + change)
                 self.market_price_cache[symbol] = max(1.0, self.market_price_cache[symbol])
         
@@ -160,87 +166,128 @@ class Trader:
         
         # If we have a large position, bias toward selling
         if position > 500:
-            return OrderSide.SELL if random.random() < 0.7 else OrderSide.BUY
+            return OrderSide.SELL if self.rng.random() < 0.7 else OrderSide.BUY
         # If we have no position, bias toward buying
         elif position == 0:
-            return OrderSide.BUY if random.random() < 0.7 else OrderSide.SELL
+            return OrderSide.BUY if self.rng.random() < 0.7 else OrderSide.SELL
         # Otherwise, random
         else:
-            return random.choice([OrderSide.BUY, OrderSide.SELL])
+            return self.rng.choice([OrderSide.BUY, OrderSide.SELL])
+    
+    def on_fill_events(self, events):
+        """
+        Receive a batch of fill events (called by the engine's dispatcher)
+        
+        Args:
+            events (list): FillEvent objects in sequence order
+        """
+        for event in events:
+            if event.sequence != self.last_fill_sequence + 1:
+                self.fill_sequence_gaps += 1  # Events were dropped on overflow
+            self.last_fill_sequence = event.sequence
+            self.on_order_filled(event, event.quantity, event.price)
     
     def on_order_filled(self, order, fill_quantity, fill_price):
         """
         Callback when an order is filled (called by the engine)
         
         Args:
-            order: The filled order
+            order: The filled order (or its FillEvent snapshot)
             fill_quantity: Quantity filled
             fill_price: Price of the fill
         """
         symbol = order.symbol
         
+        # Update cash and the signed position
         if order.side == OrderSide.BUY:
-            # Update cash and position
-            cost = fill_quantity * fill_price
-            self.cash -= cost
-            
-            # Update average cost basis
-            old_position = self.positions[symbol]
-            old_cost_basis = self.average_costs[symbol] * old_position
-            new_cost_basis = old_cost_basis + cost
-            new_position = old_position + fill_quantity
-            
-            self.positions[symbol] = new_position
-            if new_position > 0:
-                self.average_costs[symbol] = new_cost_basis / new_position
-            
+            self.cash -= fill_quantity * fill_price
+            quantity = fill_quantity
         else:  # SELL
-            # Update cash and position
-            proceeds = fill_quantity * fill_price
-            self.cash += proceeds
-            self.positions[symbol] -= fill_quantity
-            
-            # If position goes to zero, reset average cost
-            if self.positions[symbol] == 0:
-                self.average_costs[symbol] = 0.0
+            self.cash += fill_quantity * fill_price
+            quantity = -fill_quantity
+        
+        position = self.positions.get(symbol, 0)
+        average_cost = self.average_costs.get(symbol, 0.0)
+        new_position = position + quantity
         
+        if position == 0 or (position > 0) == (quantity > 0):
+            # Opening or adding: blend the average cost
+            average_cost = ((average_cost * abs(position) +
+                             fill_price * fill_quantity) / abs(new_position))
+        else:
+            # Reducing: realize P&L on the closed part against the average cost
+            closed = min(fill_quantity, abs(position))
+            direction = 1 if position > 0 else -1
+            self.realized_pnl[symbol] = (self.realized_pnl.get(symbol, 0.0) +
+                                         closed * (fill_price - average_cost) *
+                                         direction)
+            if new_position == 0:
+                average_cost = 0.0
+            elif (new_position > 0) != (position > 0):
+                average_cost = fill_price  # Flipped: the rest opens at this fill
+        
+        self.positions[symbol] = new_position
+        self.average_costs[symbol] = average_cost
         self.orders_filled += 1
         self.total_volume += fill_quantity
+        self.version += 1
     
-    def get_portfolio_value(self):
-        """Calculate current portfolio value based on market prices"""
+    def _mark(self, symbol, marks=None):
+        """
+        Mark price for a symbol: from marks if given, else the engine's mark
+        table; this trader's last market price estimate if neither has one
+        """
+        price = marks.get(symbol) if marks is not None else self.engine.get_mark(symbol)
+        if price is None:
+            price = self.market_price_cache.get(symbol, 0.0)
+        return price
+    
+    def get_portfolio_value(self, marks=None):
+        """
+        Calculate current portfolio value: cash plus positions at mark
+        
+        Args:
+            marks (dict): Optional symbol -> price, e.g. one engine.get_marks()
+                shared across many traders (None reads the engine's marks)
+        """
         portfolio_value = self.cash
         
-        for symbol, position in self.positions.items():
-            if position > 0:
-                market_price = self._estimate_market_price(symbol)
-                portfolio_value += position * market_price
+        for symbol, position in list(self.positions.items()):
+            if position != 0:
+                portfolio_value += position * self._mark(symbol, marks)
         
         return portfolio_value
     
-    def get_total_pnl(self):
-        """Calculate total profit/loss"""
-        return self.get_portfolio_value() - self.initial_cash
+    def get_total_pnl(self, marks=None):
+        """Calculate total profit/loss (realized plus unrealized at mark)"""
+        return self.get_portfolio_value(marks) - self.initial_cash
     
-    def get_position_pnl(self, symbol):
-        """Calculate P&L for a specific position"""
-        position = self.positions[symbol]
+    def get_realized_pnl(self):
+        """P&L locked in by closing fills, across symbols"""
+        return sum(list(self.realized_pnl.values()))
+    
+    def get_unrealized_pnl(self, marks=None):
+        """P&L of open positions at mark against their average cost"""
+        return sum(self.get_position_pnl(symbol, marks)
+                   for symbol in list(self.positions))
+    
+    def get_position_pnl(self, symbol, marks=None):
+        """Calculate unrealized P&L for a specific position"""
+        position = self.positions.get(symbol, 0)
         if position == 0:
             return 0.0
         
-        market_price = self._estimate_market_price(symbol)
-        market_value = position * market_price
-        cost_basis = position * self.average_costs[symbol]
-        
-        return market_value - cost_basis
+        return position * (self._mark(symbol, marks) - self.average_costs[symbol])
     
-    def get_trading_stats(self):
-        """Get trading statistics"""
+    def get_trading_stats(self, marks=None):
+        """Get trading statistics (marks as in get_portfolio_value)"""
+        portfolio_value = self.get_portfolio_value(marks)
         return {
             'trader_id': self.trader_id,
             'cash': self.cash,
-            'portfolio_value': self.get_portfolio_value(),
-            'total_pnl': self.get_total_pnl(),
+            'portfolio_value': portfolio_value,
+            'total_pnl': portfolio_value - self.initial_cash,
+            'realized_pnl': self.get_realized_pnl(),
             'orders_sent': self.orders_sent,
             'orders_filled': self.orders_filled,
             'total_volume': self.total_volume,
@@ -0,0 +1,165 @@
+"""
+Idle wait strategies for matching workers
+
+A worker whose ingress ring is empty calls its strategy's wait(), which
+returns once the ring has items or the timeout (the worker's park interval,
+cut short by the next due auction) expires. Strategies trade CPU for
+wake-up latency:
+
+- 'block' parks on the ring's event right away; submit_order sets it. No
+  CPU while idle, but each wake-up pays a thread hand-off.
+- 'spin_yield' polls the ring spin_checks times, then yields with
+  sleep(0) yield_checks times, and only then parks. A burst that arrives
+  soon after the last one is picked up without a hand-off; a quiet worker
+  still ends up parked.
+- 'spin' polls until items arrive or the timeout expires and never parks.
+  It burns a core and, in CPython, holds the GIL between switch intervals,
+  so it only pays off when producers do not need that GIL (other
+  processes, or a free-threaded build).
+"""
+import copy
+import time
+
+
+class WaitStrategy:
+    """Base strategy: counts outcomes, subclasses implement _wait"""
+
+    name = None
+
+    def __init__(self):
+        # Statistics (written by the worker thread only)
+        self.waits = 0
+        self.spin_wakeups = 0  # Items seen while polling
+        self.yield_wakeups = 0  # Items seen after yielding
+        self.park_wakeups = 0  # Items seen after parking
+        self.timeouts = 0
+
+    def wait(self, ring, timeout):
+        """
+        Wait until the ring has items or timeout seconds pass
+
+        Args:
+            ring: MPSCRingBuffer the worker drains
+            timeout (float): Longest time to wait
+
+        Returns:
+            bool: True if items are ready
+        """
+        self.waits += 1
+        ready = self._wait(ring, timeout)
+        if not ready:
+            self.timeouts += 1
+        return ready
+
+    def _wait(self, ring, timeout):
+        raise NotImplementedError
+
+    def _park(self, ring, timeout):
+        if ring.wait_for_items(timeout):
+            self.park_wakeups += 1
+            return True
+        return False
+
+    def copy(self):
+        """Fresh instance with the same settings (one per worker)"""
+        strategy = copy.copy(self)
+        WaitStrategy.__init__(strategy)
+        return strategy
+
+    def get_statistics(self):
+        """Get wake-up counters"""
+        return {
+            'strategy': self.name,
+            'waits': self.waits,
+            'spin_wakeups': self.spin_wakeups,
+            'yield_wakeups': self.yield_wakeups,
+            'park_wakeups': self.park_wakeups,
+            'timeouts': self.timeouts
+        }
+
+
+class BlockingWait(WaitStrategy):
+    """Park on the ring's event until a producer publishes"""
+
+    name = 'block'
+
+    def _wait(self, ring, timeout):
+        return self._park(ring, timeout)
+
+
+class SpinYieldWait(WaitStrategy):
+    """Poll, then yield, then park"""
+
+    name = 'spin_yield'
+
+    def __init__(self, spin_checks=200, yield_checks=50):
+        """
+        Initialize the strategy
+
+        Args:
+            spin_checks (int): Ring polls before yielding
+            yield_checks (int): sleep(0) rounds before parking
+        """
+        super().__init__()
+        self.spin_checks = spin_checks
+        self.yield_checks = yield_checks
+
+    def _wait(self, ring, timeout):
+        deadline = time.perf_counter() + timeout
+        has_items = ring.has_items
+        for _ in range(self.spin_checks):
+            if has_items():
+                self.spin_wakeups += 1
+                return True
+        for _ in range(self.yield_checks):
+            time.sleep(0)
+            if has_items():
+                self.yield_wakeups += 1
+                return True
+        return self._park(ring, max(0.0, deadline - time.perf_counter()))
+
+
+class BusySpinWait(WaitStrategy):
+    """Poll until items arrive or the timeout expires"""
+
+    name = 'spin'
+
+    def _wait(self, ring, timeout):
+        has_items = ring.has_items
+        perf_counter = time.perf_counter
+        deadline = perf_counter() + timeout
+        while True:
+            # Check the clock every few polls only
+            for _ in range(64):
+                if has_items():
+                    self.spin_wakeups += 1
+                    return True
+            if perf_counter() >= deadline:
+                return False
+
+
+WAIT_STRATEGIES = {
+    strategy.name: strategy
+    for strategy in (BlockingWait, SpinYieldWait, BusySpinWait)
+}
+
+
+def create_wait_strategy(spec=None):
+    """
+    Make a worker's strategy from a name or a configured instance
+
+    Args:
+        spec: 'block', 'spin_yield' or 'spin', a WaitStrategy to copy, or
+            None for 'block'
+
+    Returns:
+        WaitStrategy: A strategy owned by one worker
+    """
+    if spec is None:
+        return BlockingWait()
+    if isinstance(spec, WaitStrategy):
+        return spec.copy()
+    strategy = WAIT_STRATEGIES.get(spec)
+    if strategy is None:
+        raise ValueError(f"Unknown wait strategy: {spec}")
+    return strategy()
@@ -0,0 +1,856 @@
+/*
+ * Native matching core for the HFT simulator
+ *
+ * One book per symbol: a tick-indexed price ladder per side, an intrusive
+ * FIFO of order nodes per level and an order_id -> node hash map.  Prices
+ * are integer ticks, exactly as in models/orderbook.py.  The Python side
+ * submits whole batches and reads back the fills produced; each call takes
+ * the book's mutex so readers on other threads see a consistent book.
+ * Every allocation an order can need is made before the book changes, so
+ * running out of memory rejects the order and never leaves it half applied.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MC_BUY 0
+#define MC_SELL 1
+#define MC_NONE (-1)
+/* Ticks in each side's dense window around the touch (see price ladder) */
+#define LADDER_WINDOW 4096
+
+_Static_assert(LADDER_WINDOW % 64 == 0 && LADDER_WINDOW <= 64 * 64,
+               "occupancy summary must fit one 64-bit word");
+
+typedef struct {
+    int64_t order_id;
+    int64_t price_ticks;
+    int64_t quantity;
+    int32_t side;
+    int32_t rejected;  /* Set by mc_process_batch when memory ran out */
+} mc_order_t;
+
+typedef struct {
+    int64_t taker_id;
+    int64_t maker_id;
+    int64_t price_ticks;
+    int64_t quantity;
+    int64_t maker_remaining;
+    int64_t taker_remaining;
+} mc_fill_t;
+
+typedef struct {
+    int64_t id;
+    int64_t quantity;
+    int64_t price_ticks;
+    int32_t prev;
+    int32_t next;
+    int32_t side;
+    int32_t reserved;
+} node_t;
+
+typedef struct {
+    int32_t head;
+    int32_t tail;
+    int64_t total_quantity;
+    int64_t order_count;
+} level_t;
+
+typedef struct {
+    int64_t tick;
+    level_t level;
+} far_level_t;
+
+typedef struct {
+    level_t *levels;  /* LADDER_WINDOW levels from base_tick, NULL until used */
+    int64_t base_tick;
+    int64_t best;  /* window index of best level, MC_NONE when empty */
+    uint64_t occupied[LADDER_WINDOW / 64];  /* bit per non-empty level */
+    uint64_t occupied_words;  /* bit per non-zero word of occupied */
+    far_level_t *far;  /* levels outside the window, by ascending tick */
+    int64_t far_count;
+    int64_t far_capacity;
+    int64_t level_count;
+    int64_t order_count;
+    int64_t total_volume;
+    int is_bid;
+} side_t;
+
+typedef struct {
+    int64_t *keys;  /* 0 marks an empty slot (order IDs are positive) */
+    int32_t *values;
+    int64_t capacity;
+    int64_t count;
+} idmap_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    side_t sides[2];
+    node_t *nodes;
+    int32_t node_capacity;
+    int32_t node_used;
+    int32_t free_head;
+    idmap_t map;
+    mc_fill_t *fills;
+    int64_t fill_capacity;
+    int64_t fill_count;
+} book_t;
+
+/* ---- order_id -> node map (linear probing, backward-shift delete) ---- */
+
+static uint64_t hash_id(int64_t id, int64_t mask)
+{
+    uint64_t h = (uint64_t)id * 0x9E3779B97F4A7C15ULL;
+    return (h ^ (h >> 32)) & (uint64_t)mask;
+}
+
+static int map_init(idmap_t *map, int64_t capacity)
+{
+    map->keys = calloc((size_t)capacity, sizeof(int64_t));
+    map->values = malloc((size_t)capacity * sizeof(int32_t));
+    map->capacity = capacity;
+    map->count = 0;
+    return map->keys && map->values ? 0 : -1;
+}
+
+static int32_t map_get(const idmap_t *map, int64_t id)
+{
+    int64_t mask = map->capacity - 1;
+    uint64_t i = hash_id(id, mask);
+    while (map->keys[i] != 0) {
+        if (map->keys[i] == id)
+            return map->values[i];
+        i = (i + 1) & (uint64_t)mask;
+    }
+    return MC_NONE;
+}
+
+static int map_put(idmap_t *map, int64_t id, int32_t value);
+
+static int map_grow(idmap_t *map)
+{
+    idmap_t bigger;
+    if (map_init(&bigger, map->capacity * 2) != 0)
+        return -1;
+    for (int64_t i = 0; i < map->capacity; i++)
+        if (map->keys[i] != 0)
+            map_put(&bigger, map->keys[i], map->values[i]);
+    free(map->keys);
+    free(map->values);
+    *map = bigger;
+    return 0;
+}
+
+static int map_put(idmap_t *map, int64_t id, int32_t value)
+{
+    if ((map->count + 1) * 2 > map->capacity && map_grow(map) != 0)
+        return -1;
+    int64_t mask = map->capacity - 1;
+    uint64_t i = hash_id(id, mask);
+    while (map->keys[i] != 0 && map->keys[i] != id)
+        i = (i + 1) & (uint64_t)mask;
+    if (map->keys[i] == 0)
+        map->count++;
+    map->keys[i] = id;
+    map->values[i] = value;
+    return 0;
+}
+
+static void map_delete(idmap_t *map, int64_t id)
+{
+    int64_t mask = map->capacity - 1;
+    uint64_t i = hash_id(id, mask);
+    while (map->keys[i] != id) {
+        if (map->keys[i] == 0)
+            return;
+        i = (i + 1) & (uint64_t)mask;
+    }
+    /* Shift later entries of the probe run back into the hole */
+    uint64_t hole = i;
+    uint64_t j = i;
+    for (;;) {
+        j = (j + 1) & (uint64_t)mask;
+        if (map->keys[j] == 0)
+            break;
+        uint64_t home = hash_id(map->keys[j], mask);
+        int movable = hole <= j ? (home <= hole || home > j)
+                                : (home <= hole && home > j);
+        if (movable) {
+            map->keys[hole] = map->keys[j];
+            map->values[hole] = map->values[j];
+            hole = j;
+        }
+    }
+    map->keys[hole] = 0;
+    map->count--;
+}
+
+/* ---- order nodes ---- */
+
+/* Make sure node_alloc has a node to hand out */
+static int node_reserve(book_t *book)
+{
+    if (book->free_head == MC_NONE && book->node_used == book->node_capacity) {
+        int32_t capacity = book->node_capacity * 2;
+        node_t *nodes = realloc(book->nodes, (size_t)capacity * sizeof(node_t));
+        if (!nodes)
+            return -1;
+        book->nodes = nodes;
+        book->node_capacity = capacity;
+    }
+    return 0;
+}
+
+static int32_t node_alloc(book_t *book)
+{
+    if (book->free_head != MC_NONE) {
+        int32_t index = book->free_head;
+        book->free_head = book->nodes[index].next;
+        return index;
+    }
+    return book->node_used++;
+}
+
+static void node_free(book_t *book, int32_t index)
+{
+    book->nodes[index].next = book->free_head;
+    book->free_head = index;
+}
+
+/* ---- price ladder ----
+ *
+ * Each side keeps LADDER_WINDOW levels around its touch in a dense window,
+ * with an occupancy bitmap (a bit per tick and a bit per non-zero 64-tick
+ * word) that finds the next non-empty level in O(1).  Levels outside the
+ * window sit in a tick-sorted array.  They are always worse than every
+ * window level: a better price outside the window moves the window to it,
+ * and so does the window emptying while far levels remain.  A stray far
+ * price therefore costs one array entry instead of a ladder reaching it.
+ */
+
+static const level_t EMPTY_LEVEL = {MC_NONE, MC_NONE, 0, 0};
+
+static int in_window(const side_t *side, int64_t tick)
+{
+    int64_t index = tick - side->base_tick;
+    return side->levels && index >= 0 && index < LADDER_WINDOW;
+}
+
+static int is_better(const side_t *side, int64_t tick, int64_t other)
+{
+    return side->is_bid ? tick > other : tick < other;
+}
+
+static void mark(side_t *side, int64_t index)
+{
+    side->occupied[index >> 6] |= 1ULL << (index & 63);
+    side->occupied_words |= 1ULL << (index >> 6);
+}
+
+static void unmark(side_t *side, int64_t index)
+{
+    uint64_t bits = side->occupied[index >> 6] &= ~(1ULL << (index & 63));
+    if (!bits)
+        side->occupied_words &= ~(1ULL << (index >> 6));
+}
+
+/* Window index of the next non-empty level worse than index, or MC_NONE */
+static int64_t next_index(const side_t *side, int64_t index)
+{
+    int64_t word = index >> 6;
+    int bit = (int)(index & 63);
+    uint64_t bits, words;
+    if (side->is_bid) {
+        /* Highest set bit below index */
+        bits = side->occupied[word] & ((1ULL << bit) - 1);
+        if (!bits) {
+            words = side->occupied_words & ((1ULL << word) - 1);
+            if (!words)
+                return MC_NONE;
+            word = 63 - __builtin_clzll(words);
+            bits = side->occupied[word];
+        }
+        return (word << 6) + 63 - __builtin_clzll(bits);
+    }
+    /* Lowest set bit above index */
+    bits = bit == 63 ? 0 : side->occupied[word] & (~0ULL << (bit + 1));
+    if (!bits) {
+        words = word == 63 ? 0 : side->occupied_words & (~0ULL << (word + 1));
+        if (!words)
+            return MC_NONE;
+        word = __builtin_ctzll(words);
+        bits = side->occupied[word];
+    }
+    return (word << 6) + __builtin_ctzll(bits);
+}
+
+/* Position of the first far level at or above tick */
+static int64_t far_search(const side_t *side, int64_t tick)
+{
+    int64_t lo = 0, hi = side->far_count;
+    while (lo < hi) {
+        int64_t mid = lo + (hi - lo) / 2;
+        if (side->far[mid].tick < tick)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* The k-th far level in priority order (best first) */
+static far_level_t *far_at(side_t *side, int64_t k)
+{
+    return &side->far[side->is_bid ? side->far_count - 1 - k : k];
+}
+
+static int far_reserve(side_t *side, int64_t count)
+{
+    if (count <= side->far_capacity)
+        return 0;
+    int64_t capacity = side->far_capacity ? side->far_capacity : 16;
+    while (capacity < count)
+        capacity *= 2;
+    far_level_t *far = realloc(side->far, (size_t)capacity * sizeof(far_level_t));
+    if (!far)
+        return -1;
+    side->far = far;
+    side->far_capacity = capacity;
+    return 0;
+}
+
+/* Level at a tick, in the window or far; NULL if it has no entry */
+static level_t *level_for_tick(side_t *side, int64_t tick)
+{
+    if (in_window(side, tick))
+        return &side->levels[tick - side->base_tick];
+    int64_t i = far_search(side, tick);
+    if (i < side->far_count && side->far[i].tick == tick)
+        return &side->far[i].level;
+    return NULL;
+}
+
+static level_t *find_level(side_t *side, int64_t tick)
+{
+    level_t *level = level_for_tick(side, tick);
+    return level && level->head != MC_NONE ? level : NULL;
+}
+
+/* Centre the window on best_tick.  Window levels falling outside it move to
+ * the far array (the caller reserved room for every window level) and far
+ * levels falling inside move in; best is left for the caller to set. */
+static void place_window(side_t *side, int64_t best_tick)
+{
+    int64_t window_levels = side->level_count - side->far_count;
+    if (window_levels > 0) {
+        /* Window levels are better than every far level: above them for
+         * bids, below them for asks, so they keep the array sorted */
+        far_level_t *dest = side->far + side->far_count;
+        if (!side->is_bid) {
+            memmove(side->far + window_levels, side->far,
+                    (size_t)side->far_count * sizeof(far_level_t));
+            dest = side->far;
+        }
+        for (int64_t word = 0; word < LADDER_WINDOW / 64; word++) {
+            for (uint64_t bits = side->occupied[word]; bits; bits &= bits - 1) {
+                int64_t index = (word << 6) + __builtin_ctzll(bits);
+                dest->tick = side->base_tick + index;
+                dest->level = side->levels[index];
+                dest++;
+                side->levels[index] = EMPTY_LEVEL;
+            }
+        }
+        side->far_count += window_levels;
+    }
+    memset(side->occupied, 0, sizeof(side->occupied));
+    side->occupied_words = 0;
+    side->base_tick = best_tick - LADDER_WINDOW / 2;
+    side->best = MC_NONE;
+
+    int64_t kept = 0;
+    for (int64_t i = 0; i < side->far_count; i++) {
+        int64_t index = side->far[i].tick - side->base_tick;
+        if (index >= 0 && index < LADDER_WINDOW) {
+            side->levels[index] = side->far[i].level;
+            mark(side, index);
+        } else {
+            side->far[kept++] = side->far[i];
+        }
+    }
+    side->far_count = kept;
+}
+
+static void advance_best(side_t *side)
+{
+    int64_t index = next_index(side, side->best);
+    if (index != MC_NONE) {
+        side->best = index;
+    } else if (side->far_count > 0) {
+        /* Window exhausted: bring it to the best far level (every window
+         * level is gone, so nothing needs room in the far array) */
+        int64_t tick = far_at(side, 0)->tick;
+        place_window(side, tick);
+        side->best = tick - side->base_tick;
+    } else {
+        side->best = MC_NONE;
+    }
+}
+
+/* Allocate everything rest_reserved() can need for an order at tick */
+static int reserve_rest(book_t *book, side_t *side, int64_t tick)
+{
+    if (!side->levels) {
+        side->levels = malloc(LADDER_WINDOW * sizeof(level_t));
+        if (!side->levels)
+            return -1;
+        for (int64_t i = 0; i < LADDER_WINDOW; i++)
+            side->levels[i] = EMPTY_LEVEL;
+        side->base_tick = tick - LADDER_WINDOW / 2;
+    }
+    if (node_reserve(book) != 0)
+        return -1;
+    if ((book->map.count + 1) * 2 > book->map.capacity && map_grow(&book->map) != 0)
+        return -1;
+    /* A far level, or a window move pushing every window level out */
+    if (!in_window(side, tick) && far_reserve(side, side->level_count + 1) != 0)
+        return -1;
+    return 0;
+}
+
+/* Rest an order after reserve_rest() succeeded for it; cannot fail */
+static void rest_reserved(book_t *book, int64_t id, int32_t side_id,
+                          int64_t tick, int64_t quantity)
+{
+    side_t *side = &book->sides[side_id];
+    level_t *level;
+    int64_t index = tick - side->base_tick;
+    int window = index >= 0 && index < LADDER_WINDOW;
+    if (!window && (side->best == MC_NONE ||
+                    is_better(side, tick, side->base_tick + side->best))) {
+        /* A new touch outside the window: move the window to it */
+        place_window(side, tick);
+        index = tick - side->base_tick;
+        window = 1;
+    }
+    if (window) {
+        level = &side->levels[index];
+    } else {
+        int64_t i = far_search(side, tick);
+        if (i == side->far_count || side->far[i].tick != tick) {
+            memmove(side->far + i + 1, side->far + i,
+                    (size_t)(side->far_count - i) * sizeof(far_level_t));
+            side->far[i].tick = tick;
+            side->far[i].level = EMPTY_LEVEL;
+            side->far_count++;
+        }
+        level = &side->far[i].level;
+    }
+
+    int32_t node_index = node_alloc(book);
+    map_put(&book->map, id, node_index);
+    node_t *node = &book->nodes[node_index];
+    node->id = id;
+    node->quantity = quantity;
+    node->price_ticks = tick;
+    node->side = side_id;
+    node->prev = level->tail;
+    node->next = MC_NONE;
+
+    if (level->head == MC_NONE) {
+        level->head = node_index;
+        side->level_count++;
+        if (window) {
+            mark(side, index);
+            if (side->best == MC_NONE ||
+                (side->is_bid ? index > side->best : index < side->best))
+                side->best = index;
+        }
+    } else {
+        book->nodes[level->tail].next = node_index;
+    }
+    level->tail = node_index;
+    level->total_quantity += quantity;
+    level->order_count++;
+    side->order_count++;
+    side->total_volume += quantity;
+}
+
+static int rest_order(book_t *book, int64_t id, int32_t side_id,
+                      int64_t tick, int64_t quantity)
+{
+    if (reserve_rest(book, &book->sides[side_id], tick) != 0)
+        return -1;
+    rest_reserved(book, id, side_id, tick, quantity);
+    return 0;
+}
+
+static void remove_node(book_t *book, int32_t node_index)
+{
+    node_t *node = &book->nodes[node_index];
+    side_t *side = &book->sides[node->side];
+    int64_t tick = node->price_ticks;
+    int window = in_window(side, tick);
+    int64_t far_index = window ? MC_NONE : far_search(side, tick);
+    level_t *level = window ? &side->levels[tick - side->base_tick]
+                            : &side->far[far_index].level;
+
+    if (node->prev != MC_NONE)
+        book->nodes[node->prev].next = node->next;
+    else
+        level->head = node->next;
+    if (node->next != MC_NONE)
+        book->nodes[node->next].prev = node->prev;
+    else
+        level->tail = node->prev;
+
+    level->total_quantity -= node->quantity;
+    level->order_count--;
+    side->order_count--;
+    side->total_volume -= node->quantity;
+
+    map_delete(&book->map, node->id);
+    node_free(book, node_index);
+
+    if (level->head == MC_NONE) {
+        side->level_count--;
+        if (window) {
+            int64_t index = tick - side->base_tick;
+            *level = EMPTY_LEVEL;
+            unmark(side, index);
+            if (index == side->best)
+                advance_best(side);
+        } else {
+            memmove(side->far + far_index, side->far + far_index + 1,
+                    (size_t)(side->far_count - far_index - 1) * sizeof(far_level_t));
+            side->far_count--;
+        }
+    }
+}
+
+/* Make room for count more fills in the batch's fill buffer */
+static int fill_reserve(book_t *book, int64_t count)
+{
+    int64_t needed = book->fill_count + count;
+    if (needed <= book->fill_capacity)
+        return 0;
+    int64_t capacity = book->fill_capacity;
+    while (capacity < needed)
+        capacity *= 2;
+    mc_fill_t *fills = realloc(book->fills, (size_t)capacity * sizeof(mc_fill_t));
+    if (!fills)
+        return -1;
+    book->fills = fills;
+    book->fill_capacity = capacity;
+    return 0;
+}
+
+/* Match one order and rest what is left; returns -1, with the book
+ * unchanged, if memory for its fills or its resting node ran out */
+static int process_one(book_t *book, const mc_order_t *order)
+{
+    int64_t remaining = order->quantity;
+    int is_buy = order->side == MC_BUY;
+    side_t *opposite = &book->sides[is_buy ? MC_SELL : MC_BUY];
+
+    /* Each fill takes at least one unit from one resting order */
+    int64_t max_fills = 0;
+    if (opposite->best != MC_NONE) {
+        int64_t tick = opposite->base_tick + opposite->best;
+        if (is_buy ? tick <= order->price_ticks : tick >= order->price_ticks)
+            max_fills = remaining < opposite->order_count ? remaining
+                                                          : opposite->order_count;
+    }
+    if (fill_reserve(book, max_fills) != 0 ||
+        reserve_rest(book, &book->sides[order->side], order->price_ticks) != 0)
+        return -1;
+
+    while (remaining > 0 && opposite->best != MC_NONE) {
+        int64_t tick = opposite->base_tick + opposite->best;
+        if (is_buy ? tick > order->price_ticks : tick < order->price_ticks)
+            break;
+
+        level_t *level = &opposite->levels[opposite->best];
+        int32_t maker_index = level->head;
+        node_t *maker = &book->nodes[maker_index];
+        int64_t quantity = remaining < maker->quantity ? remaining : maker->quantity;
+
+        maker->quantity -= quantity;
+        remaining -= quantity;
+        level->total_quantity -= quantity;
+        opposite->total_volume -= quantity;
+
+        book->fills[book->fill_count++] = (mc_fill_t){
+            order->order_id, maker->id, tick, quantity, maker->quantity,
+            remaining};
+
+        if (maker->quantity == 0)
+            remove_node(book, maker_index);
+    }
+
+    if (remaining > 0)
+        rest_reserved(book, order->order_id, order->side, order->price_ticks,
+                      remaining);
+    return 0;
+}
+
+/* ---- exported API ---- */
+
+void *mc_book_create(void)
+{
+    book_t *book = calloc(1, sizeof(book_t));
+    if (!book)
+        return NULL;
+    pthread_mutex_init(&book->lock, NULL);
+    book->sides[MC_BUY].is_bid = 1;
+    book->sides[MC_BUY].best = MC_NONE;
+    book->sides[MC_SELL].best = MC_NONE;
+    book->node_capacity = 1024;
+    book->nodes = malloc((size_t)book->node_capacity * sizeof(node_t));
+    book->free_head = MC_NONE;
+    book->fill_capacity = 1024;
+    book->fills = malloc((size_t)book->fill_capacity * sizeof(mc_fill_t));
+    if (!book->nodes || !book->fills || map_init(&book->map, 2048) != 0) {
+        free(book->nodes);
+        free(book->fills);
+        free(book->map.keys);
+        free(book->map.values);
+        free(book);
+        return NULL;
+    }
+    return book;
+}
+
+void mc_book_destroy(void *handle)
+{
+    book_t *book = handle;
+    if (!book)
+        return;
+    pthread_mutex_destroy(&book->lock);
+    free(book->sides[MC_BUY].levels);
+    free(book->sides[MC_SELL].levels);
+    free(book->sides[MC_BUY].far);
+    free(book->sides[MC_SELL].far);
+    free(book->nodes);
+    free(book->fills);
+    free(book->map.keys);
+    free(book->map.values);
+    free(book);
+}
+
+/* Match a batch of incoming orders in sequence; returns the fill count.
+ * Fills stay valid in mc_fill_buffer() until the next batch call.  An order
+ * that memory could not be found for is neither matched nor rested; its
+ * rejected field is set to 1 (0 for every other order). */
+int64_t mc_process_batch(void *handle, mc_order_t *orders, int64_t count)
+{
+    book_t *book = handle;
+    pthread_mutex_lock(&book->lock);
+    book->fill_count = 0;
+    for (int64_t i = 0; i < count; i++)
+        orders[i].rejected = process_one(book, &orders[i]) != 0;
+    int64_t fills = book->fill_count;
+    pthread_mutex_unlock(&book->lock);
+    return fills;
+}
+
+const mc_fill_t *mc_fill_buffer(void *handle)
+{
+    return ((book_t *)handle)->fills;
+}
+
+/* Rest an order without matching; returns 0 on success, -1 if the ID is
+ * already resting or memory ran out (the book is then unchanged) */
+int mc_add(void *handle, const mc_order_t *order)
+{
+    book_t *book = handle;
+    pthread_mutex_lock(&book->lock);
+    int result = map_get(&book->map, order->order_id) != MC_NONE
+                     ? -1
+                     : rest_order(book, order->order_id, order->side,
+                                  order->price_ticks, order->quantity);
+    pthread_mutex_unlock(&book->lock);
+    return result;
+}
+
+/* Remove a resting order; returns 1 if it was found */
+int mc_cancel(void *handle, int64_t order_id)
+{
+    book_t *book = handle;
+    pthread_mutex_lock(&book->lock);
+    int32_t node_index = map_get(&book->map, order_id);
+    if (node_index != MC_NONE)
+        remove_node(book, node_index);
+    pthread_mutex_unlock(&book->lock);
+    return node_index != MC_NONE;
+}
+
+/* Shrink a resting order in place, keeping its queue position; returns 1 if
+ * the order was found and 0 < quantity < its remaining quantity */
+int mc_reduce(void *handle, int64_t order_id, int64_t quantity)
+{
+    book_t *book = handle;
+    int reduced = 0;
+    pthread_mutex_lock(&book->lock);
+    int32_t node_index = map_get(&book->map, order_id);
+    if (node_index != MC_NONE) {
+        node_t *node = &book->nodes[node_index];
+        if (quantity > 0 && quantity < node->quantity) {
+            side_t *side = &book->sides[node->side];
+            int64_t delta = node->quantity - quantity;
+            level_for_tick(side, node->price_ticks)->total_quantity -= delta;
+            side->total_volume -= delta;
+            node->quantity = quantity;
+            reduced = 1;
+        }
+    }
+    pthread_mutex_unlock(&book->lock);
+    return reduced;
+}
+
+/* Best tick on a side; returns 1 and writes *tick if the side is non-empty */
+int mc_best_tick(void *handle, int32_t side_id, int64_t *tick)
+{
+    book_t *book = handle;
+    pthread_mutex_lock(&book->lock);
+    side_t *side = &book->sides[side_id];
+    int found = side->best != MC_NONE;
+    if (found)
+        *tick = side->base_tick + side->best;
+    pthread_mutex_unlock(&book->lock);
+    return found;
+}
+
+/* ID of the first order at the best level, 0 when the side is empty */
+int64_t mc_best_order_id(void *handle, int32_t side_id)
+{
+    book_t *book = handle;
+    pthread_mutex_lock(&book->lock);
+    side_t *side = &book->sides[side_id];
+    int64_t id = 0;
+    if (side->best != MC_NONE)
+        id = book->nodes[side->levels[side->best].head].id;
+    pthread_mutex_unlock(&book->lock);
+    return id;
+}
+
+/* Copy up to max_levels levels from best to worst; returns levels written */
+int64_t mc_top_levels(void *handle, int32_t side_id, int64_t max_levels,
+                      int64_t *ticks, int64_t *quantities, int64_t *counts)
+{
+    book_t *book = handle;
+    pthread_mutex_lock(&book->lock);
+    side_t *side = &book->sides[side_id];
+    int64_t written = 0;
+    if (side->best != MC_NONE) {
+        for (int64_t i = side->best; i != MC_NONE && written < max_levels;
+             i = next_index(side, i)) {
+            ticks[written] = side->base_tick + i;
+            quantities[written] = side->levels[i].total_quantity;
+            counts[written] = side->levels[i].order_count;
+            written++;
+        }
+    }
+    for (int64_t k = 0; k < side->far_count && written < max_levels; k++) {
+        far_level_t *far = far_at(side, k);
+        ticks[written] = far->tick;
+        quantities[written] = far->level.total_quantity;
+        counts[written] = far->level.order_count;
+        written++;
+    }
+    pthread_mutex_unlock(&book->lock);
+    return written;
+}
+
+/* Copy the FIFO of order IDs at a tick; returns the number written */
+int64_t mc_level_order_ids(void *handle, int32_t side_id, int64_t tick,
+                           int64_t *ids, int64_t capacity)
+{
+    book_t *book = handle;
+    pthread_mutex_lock(&book->lock);
+    level_t *level = find_level(&book->sides[side_id], tick);
+    int64_t written = 0;
+    for (int32_t i = level ? level->head : MC_NONE;
+         i != MC_NONE && written < capacity; i = book->nodes[i].next)
+        ids[written++] = book->nodes[i].id;
+    pthread_mutex_unlock(&book->lock);
+    return written;
+}
+
+/* Aggregate quantity and order count at each of count ticks (0 if empty) */
+void mc_levels_at(void *handle, int32_t side_id, int64_t count,
+                  const int64_t *ticks, int64_t *quantities, int64_t *counts)
+{
+    book_t *book = handle;
+    pthread_mutex_lock(&book->lock);
+    side_t *side = &book->sides[side_id];
+    for (int64_t i = 0; i < count; i++) {
+        level_t *level = find_level(side, ticks[i]);
+        quantities[i] = level ? level->total_quantity : 0;
+        counts[i] = level ? level->order_count : 0;
+    }
+    pthread_mutex_unlock(&book->lock);
+}
+
+/* Sweep a side from its best level for each of count quantities, stopping
+ * at limit_tick (inclusive; pass the side's far sentinel for no limit);
+ * writes the quantity filled, its notional in ticks x quantity and the last
+ * tick taken from (MC_NONE when nothing fills) per query */
+void mc_sweep(void *handle, int32_t side_id, int64_t count,
+              const int64_t *quantities, int64_t limit_tick, int64_t *filled,
+              int64_t *notional, int64_t *last_tick)
+{
+    book_t *book = handle;
+    pthread_mutex_lock(&book->lock);
+    side_t *side = &book->sides[side_id];
+    for (int64_t q = 0; q < count; q++) {
+        int64_t wanted = quantities[q];
+        int64_t taken = 0, cost = 0, last = MC_NONE;
+        /* Window levels from the best, then far levels (all worse) */
+        int64_t i = side->best;
+        int64_t k = 0;
+        while (taken < wanted) {
+            int64_t tick;
+            const level_t *level;
+            if (i != MC_NONE) {
+                tick = side->base_tick + i;
+                level = &side->levels[i];
+                i = next_index(side, i);
+            } else if (k < side->far_count) {
+                tick = far_at(side, k)->tick;
+                level = &far_at(side, k)->level;
+                k++;
+            } else {
+                break;
+            }
+            if (is_better(side, limit_tick, tick))
+                break;
+            if (level->total_quantity == 0)
+                continue;
+            int64_t take = wanted - taken;
+            if (take > level->total_quantity)
+                take = level->total_quantity;
+            taken += take;
+            cost += take * tick;
+            last = tick;
+        }
+        filled[q] = taken;
+        notional[q] = cost;
+        last_tick[q] = last;
+    }
+    pthread_mutex_unlock(&book->lock);
+}
+
+/* Side aggregates: levels, orders and resting volume */
+void mc_side_totals(void *handle, int32_t side_id, int64_t *level_count,
+                    int64_t *order_count, int64_t *total_volume)
+{
+    book_t *book = handle;
+    pthread_mutex_lock(&book->lock);
+    side_t *side = &book->sides[side_id];
+    *level_count = side->level_count;
+    *order_count = side->order_count;
+    *total_volume = side->total_volume;
+    pthread_mutex_unlock(&book->lock);
+}
@@ -12,14 +12,18 @@ import numpy as np
 
 from models.engine import TradingEngine
 from models.trader import Trader
+from models.flow_generator import PopulationFlowGenerator
+from models.clock import VirtualClock
+from models.simulation import Simulation
 
 
 class PerformanceBenchmark:
     """Real-time performance monitoring for HFT simulation"""
 
-    def __init__(self):
-        self.engine = TradingEngine()
+    def __init__(self, clock=None):
+        self.engine = TradingEngine(clock=clock)
         self.traders = []
+        self.population = None  # Optional PopulationFlowGenerator
         self.running = False
 
         # Performance metrics
@@ -55,13 +59,28 @@ class PerformanceBenchmark:
             self.traders.append(trader)
             self.engine.register_trader(trader)
 
+    def create_population(self, num_traders=1000, symbols=None, seed=None):
+        """Simulate a large trader population from one generator thread"""
+        self.population = PopulationFlowGenerator(self.engine,
+                                                  num_traders=num_traders,
+                                                  symbols=symbols,
+                                                  initial_cash=1000000,
+                                                  initial_position=100,
+                                                  order_frequency=1.0,
+                                                  min_order_size=1,
+                                                  max_order_size=50,
+                                                  seed=seed)
+
     def start_benchmark(self, duration_seconds=60):
         """Start the performance benchmark"""
         print(f"🚀 Starting HFT Performance Benchmark")
         print(f"Duration: {duration_seconds} seconds")
         print(f"Traders: {len(self.traders)}")
-        print(
-            f"Symbols: {self.traders[0].symbols if self.traders else 'None'}")
+        if self.population:
+            print(f"Population: {self.population.num_traders} traders")
+        symbols = (self.traders[0].symbols if self.traders else
+                   self.population.symbols if self.population else 'None')
+        print(f"Symbols: {symbols}")
         print("-" * 50)
 
         self.running = True
@@ -73,6 +92,8 @@ class PerformanceBenchmark:
         # Start traders
         for trader in self.traders:
             trader.start_trading()
+        if self.population:
+            self.population.start()
 
         # Start monitoring thread
         monitor_thread = threading.Thread(target=self._monitor_performance,
@@ -87,6 +108,26 @@ class PerformanceBenchmark:
 
         self.stop_benchmark()
 
+    def run_virtual(self, duration_seconds=60, seed=0):
+        """Replay the configured flow on the virtual clock as fast as possible"""
+        print(f"🚀 Starting virtual-clock replay (seed {seed})")
+        print(f"Simulated duration: {duration_seconds} seconds")
+        print("-" * 50)
+
+        simulation = Simulation(self.engine, seed)
+        for trader in self.traders:
+            simulation.add_trader(trader)
+        if self.population:
+            simulation.add_population(self.population)
+
+        result = simulation.run(duration_seconds)
+        self.peak_tps = self.engine.get_performance_stats(
+        )['trades_per_second']
+        print(f"Replayed {result['simulated_seconds']}s in "
+              f"{result['wall_seconds']:.2f}s wall time "
+              f"({result['speedup']:.1f}x, {result['events']:,} events)")
+        self._print_final_results()
+
     def stop_benchmark(self):
         """Stop the benchmark and print final results"""
         self.running = False
@@ -94,6 +135,8 @@ class PerformanceBenchmark:
         # Stop traders
         for trader in self.traders:
             trader.stop_trading()
+        if self.population:
+            self.population.stop()
 
         # Stop engine
         self.engine.stop()
@@ -143,7 +186,8 @@ class PerformanceBenchmark:
             f"Peak: {self.peak_tps:7.1f} | "
             f"Trades: {stats['total_trades']:6d} | "
             f"Orders: {stats['active_orders']:4d} | "
-            f"Latency: {self.avg_latency:5.2f}ms",
+            f"Latency: {self.avg_latency:5.2f}ms "
+            f"(p99 {stats['latency']['total']['p99_us'] / 1e3:5.2f}ms)",
             end="",
             flush=True)
 
@@ -169,10 +213,23 @@ class PerformanceBenchmark:
             f"   Average Latency:      {final_stats['avg_latency_ms']:.2f} ms")
         print(f"   Active Symbols:       {final_stats['symbols_active']}")
 
+        print(f"\n⏱️  LATENCY BY STAGE (μs):")
+        print(f"   {'Stage':<10}{'p50':>10}{'p99':>10}{'p99.9':>10}{'max':>12}")
+        for stage, summary in final_stats['latency'].items():
+            print(f"   {stage:<10}{summary['p50_us']:>10.1f}"
+                  f"{summary['p99_us']:>10.1f}{summary['p999_us']:>10.1f}"
+                  f"{summary['max_us']:>12.1f}")
+
         print(f"\n💰 TRADING STATISTICS:")
-        total_pnl = sum(trader.get_total_pnl() for trader in self.traders)
+        marks = self.engine.get_marks()
+        total_pnl = sum(trader.get_total_pnl(marks) for trader in self.traders)
         total_orders = sum(trader.orders_sent for trader in self.traders)
         total_fills = sum(trader.orders_filled for trader in self.traders)
+        if self.population:
+            population_stats = self.population.get_statistics()
+            total_pnl += population_stats['total_pnl']
+            total_orders += population_stats['orders_sent']
+            total_fills += population_stats['orders_filled']
         fill_rate = (total_fills / max(1, total_orders)) * 100
 
         print(f"   Total Orders Sent:    {total_orders:,}")
@@ -209,20 +266,28 @@ class PerformanceBenchmark:
 
 def main():
     """Run HFT performance benchmark"""
-    benchmark = PerformanceBenchmark()
-
     print("HFT Trading Simulation - Performance Benchmark")
     print("=" * 50)
 
     # Configuration
+    seed = input("Virtual-clock replay seed (blank for real time): ")
+    benchmark = PerformanceBenchmark(
+        clock=VirtualClock() if seed else None)
     num_traders = int(input("Number of traders (default 10): ") or "10")
+    population = int(
+        input("Population-generator traders (default 0): ") or "0")
     duration = int(input("Duration in seconds (default 30): ") or "30")
 
     # Create traders
     benchmark.create_traders(num_traders)
+    if population > 0:
+        benchmark.create_population(population)
 
     # Run benchmark
-    benchmark.start_benchmark(duration)
+    if seed:
+        benchmark.run_virtual(duration, int(seed))
+    else:
+        benchmark.start_benchmark(duration)
 
 
 if __name__ == "__main__":
@@ -1,14 +1,31 @@
 import pandas as pd
+import numpy as np
 import io
-from datetime import datetime
 from typing import List, Dict, Optional
 import logging
 
-from models.order import Order, OrderSide
+from models.order import OrderSide, wall_ns_to_monotonic_ns
+
+# Columns every order row must have
+REQUIRED_COLUMNS = ['trader_id', 'symbol', 'side', 'quantity', 'price']
+
+# Rows converted and submitted per batch (also the streaming read size)
+DEFAULT_CHUNK_ROWS = 100000
+
+# Per-row error messages kept in an import result
+MAX_ROW_ERRORS = 100
+
+# Read identifiers as strings so pandas does not infer per-chunk dtypes
+_READ_DTYPES = {'trader_id': str, 'symbol': str, 'side': str}
 
 class CSVImporter:
     """
     Utility class for importing trading data from CSV files
+    
+    Order rows are converted a column at a time (side, quantity, price and
+    timestamp are parsed and checked as whole arrays) and submitted in
+    batches through TradingEngine.submit_orders, so an import costs one
+    ring publish per chunk rather than one Python round trip per row.
     """
     
     def __init__(self):
@@ -21,24 +38,29 @@ class CSVImporter:
         
         Args:
             csv_content (str): CSV content as string
-            
+        
         Returns:
             dict: Validation results with success status and error messages
         """
         try:
-            # Read CSV content
-            df = pd.read_csv(io.StringIO(csv_content))
-            
-            # Required columns
-            required_columns = ['trader_id', 'symbol', 'side', 'quantity', 'price']
-            
+            df = pd.read_csv(io.StringIO(csv_content), dtype=_READ_DTYPES)
+        except Exception as e:
+            return {
+                'success': False,
+                'error': f"Error reading CSV: {str(e)}"
+            }
+        return self._validate_frame(df)
+    
+    def _validate_frame(self, df) -> Dict[str, any]:
+        """Column-level checks on an already parsed frame"""
+        try:
             # Check for required columns
-            missing_columns = [col for col in required_columns if col not in df.columns]
+            missing_columns = [col for col in REQUIRED_COLUMNS if col not in df.columns]
             if missing_columns:
                 return {
                     'success': False,
                     'error': f"Missing required columns: {', '.join(missing_columns)}",
-                    'required_columns': required_columns,
+                    'required_columns': REQUIRED_COLUMNS,
                     'found_columns': list(df.columns)
                 }
             
@@ -59,12 +81,12 @@ class CSVImporter:
             
             # Check side values are valid
             valid_sides = ['BUY', 'SELL', 'buy', 'sell']
-            invalid_sides = df[~df['side'].isin(valid_sides)]['side'].unique()
+            invalid_sides = df[~df['side'].isin(valid_sides)]['side'].dropna().unique()
             if len(invalid_sides) > 0:
                 errors.append(f"Invalid side values: {', '.join(invalid_sides)}. Must be BUY or SELL")
             
             # Check for empty values in required fields
-            for col in required_columns:
+            for col in REQUIRED_COLUMNS:
                 if df[col].isna().any():
                     errors.append(f"{col} column contains empty values")
             
@@ -82,86 +104,218 @@ class CSVImporter:
                 'traders': sorted(df['trader_id'].unique().tolist()),
                 'preview': df.head().to_dict('records')
             }
-            
+        
         except Exception as e:
             return {
                 'success': False,
-                'error': f"Error reading CSV: {str(e)}"
+                'error': f"Error validating CSV: {str(e)}"
             }
     
-    def import_orders_from_csv(self, csv_content: str, engine) -> Dict[str, any]:
+    def _convert_frame(self, df, first_row: int) -> Dict[str, any]:
+        """
+        Convert a frame of order rows to submit-ready columns
+        
+        Rows with a missing identifier, an unknown side or a non-positive
+        quantity or price are dropped rather than raising.
+        
+        Args:
+            df: Frame holding at least REQUIRED_COLUMNS
+            first_row (int): Zero-based file row of the frame's first row
+        
+        Returns:
+            dict: Column lists for the valid rows plus the invalid row numbers
+        """
+        sides = df['side'].astype(str).str.strip().str.upper()
+        is_buy = (sides == 'BUY').to_numpy()
+        valid = is_buy | (sides == 'SELL').to_numpy()
+        
+        quantities = pd.to_numeric(df['quantity'], errors='coerce').to_numpy(dtype=np.float64)
+        prices = pd.to_numeric(df['price'], errors='coerce').to_numpy(dtype=np.float64)
+        valid &= quantities >= 1  # NaN compares False
+        valid &= prices > 0
+        valid &= df['trader_id'].notna().to_numpy() & df['symbol'].notna().to_numpy()
+        
+        rows = np.flatnonzero(valid)
+        columns = {
+            'trader_ids': df['trader_id'].to_numpy()[rows].astype(str).tolist(),
+            'symbols': df['symbol'].to_numpy()[rows].astype(str).tolist(),
+            'sides': [OrderSide.BUY if buy else OrderSide.SELL
+                      for buy in is_buy[rows].tolist()],
+            'quantities': quantities[rows].astype(np.int64).tolist(),
+            'prices': prices[rows].tolist(),
+            'timestamps': None,
+            'invalid_rows': (np.flatnonzero(~valid) + first_row + 1).tolist()
+        }
+        columns['symbols'] = [symbol.upper() for symbol in columns['symbols']]
+        
+        # Timestamps convert as one array; rows that fail to parse keep the
+        # order's creation time
+        if 'timestamp' in df.columns:
+            timestamps = pd.to_datetime(df['timestamp'], errors='coerce')
+            if timestamps.dt.tz is not None:
+                timestamps = timestamps.dt.tz_convert(None)
+            wall_ns = timestamps.to_numpy(dtype='datetime64[ns]').view(np.int64)[rows]
+            monotonic_ns = wall_ns_to_monotonic_ns(wall_ns).tolist()
+            columns['timestamps'] = [
+                timestamp_ns if parsed else None
+                for timestamp_ns, parsed in zip(monotonic_ns,
+                                                timestamps.notna().to_numpy()[rows].tolist())
+            ]
+        
+        return columns
+    
+    def _submit_columns(self, columns: Dict[str, any], engine) -> tuple:
+        """
+        Build pooled orders from converted columns and submit them as one batch
+        
+        Rows priced outside their book's price band are skipped before an
+        order is created for them.
+        
+        Returns:
+            tuple: (orders accepted into the engine, rows outside the band)
+        """
+        create_order = engine.create_order
+        in_band = [
+            engine.get_orderbook(symbol).price_in_band(price, side)
+            for symbol, side, price in zip(columns['symbols'], columns['sides'],
+                                           columns['prices'])
+        ]
+        orders = [
+            create_order(trader_id, symbol, side, quantity, price)
+            for trader_id, symbol, side, quantity, price, keep in zip(
+                columns['trader_ids'], columns['symbols'], columns['sides'],
+                columns['quantities'], columns['prices'], in_band)
+            if keep
+        ]
+        
+        timestamps = columns['timestamps']
+        if timestamps is not None:
+            kept = (timestamp_ns for timestamp_ns, keep in zip(timestamps, in_band)
+                    if keep)
+            for order, timestamp_ns in zip(orders, kept):
+                if timestamp_ns is not None:
+                    order.timestamp_ns = timestamp_ns
+        
+        out_of_band = len(in_band) - len(orders)
+        if not orders:
+            return 0, out_of_band
+        return engine.submit_orders(orders), out_of_band
+    
+    def _import_frames(self, frames, engine) -> Dict[str, any]:
+        """Convert and submit a sequence of frames, accumulating the result"""
+        orders_submitted = 0
+        orders_failed = 0
+        total_rows = 0
+        chunks = 0
+        errors = []
+        symbols = set()
+        traders = set()
+        
+        for df in frames:
+            if chunks == 0:
+                missing_columns = [col for col in REQUIRED_COLUMNS if col not in df.columns]
+                if missing_columns:
+                    return {
+                        'success': False,
+                        'error': f"Missing required columns: {', '.join(missing_columns)}",
+                        'required_columns': REQUIRED_COLUMNS,
+                        'found_columns': list(df.columns)
+                    }
+            
+            columns = self._convert_frame(df, total_rows)
+            accepted, out_of_band = self._submit_columns(columns, engine)
+            
+            invalid_rows = columns['invalid_rows']
+            for row in invalid_rows[:max(0, MAX_ROW_ERRORS - len(errors))]:
+                errors.append(f"Row {row}: invalid or missing trader_id, symbol, side, quantity or price")
+            if out_of_band:
+                errors.append(f"Rows {total_rows + 1}-{total_rows + len(df)}: "
+                              f"{out_of_band} orders priced outside the price band")
+            rejected = len(columns['quantities']) - out_of_band - accepted
+            if rejected:
+                errors.append(f"Rows {total_rows + 1}-{total_rows + len(df)}: "
+                              f"{rejected} orders rejected by the engine (ingress full)")
+            
+            orders_submitted += accepted
+            orders_failed += len(invalid_rows) + out_of_band + rejected
+            total_rows += len(df)
+            chunks += 1
+            symbols.update(columns['symbols'])
+            traders.update(columns['trader_ids'])
+        
+        return {
+            'success': True,
+            'orders_submitted': orders_submitted,
+            'orders_failed': orders_failed,
+            'total_rows': total_rows,
+            'chunks': chunks,
+            'errors': errors,
+            'symbols_imported': sorted(symbols),
+            'traders_imported': sorted(traders)
+        }
+    
+    def import_orders_from_csv(self, csv_content: str, engine,
+                               chunksize: int = DEFAULT_CHUNK_ROWS) -> Dict[str, any]:
         """
         Import orders from CSV content and submit them to the trading engine
         
+        The content is parsed once; the whole file is validated before any
+        order is submitted, then submitted chunksize rows at a time.
+        
         Args:
             csv_content (str): CSV content as string
             engine: Trading engine instance
-            
+            chunksize (int): Rows per submitted batch
+        
         Returns:
             dict: Import results with success status and statistics
         """
         try:
-            # Validate CSV first
-            validation = self.validate_csv_format(csv_content)
+            try:
+                df = pd.read_csv(io.StringIO(csv_content), dtype=_READ_DTYPES)
+            except Exception as e:
+                return {
+                    'success': False,
+                    'error': f"Error reading CSV: {str(e)}"
+                }
+            
+            validation = self._validate_frame(df)
             if not validation['success']:
                 return validation
             
-            # Read CSV content
-            df = pd.read_csv(io.StringIO(csv_content))
-            
-            # Convert and submit orders
-            orders_submitted = 0
-            orders_failed = 0
-            errors = []
-            
-            for index, row in df.iterrows():
-                try:
-                    # Parse order data
-                    trader_id = str(row['trader_id'])
-                    symbol = str(row['symbol']).upper()
-                    side_str = str(row['side']).upper()
-                    quantity = int(row['quantity'])
-                    price = float(row['price'])
-                    
-                    # Convert side to enum
-                    if side_str == 'BUY':
-                        side = OrderSide.BUY
-                    elif side_str == 'SELL':
-                        side = OrderSide.SELL
-                    else:
-                        errors.append(f"Row {index + 1}: Invalid side '{side_str}'")
-                        orders_failed += 1
-                        continue
-                    
-                    # Create and submit order
-                    order = Order(trader_id, symbol, side, quantity, price)
-                    
-                    # Add timestamp if provided
-                    if 'timestamp' in row and pd.notna(row['timestamp']):
-                        try:
-                            order.timestamp = pd.to_datetime(row['timestamp'])
-                        except:
-                            # Use current time if timestamp parsing fails
-                            order.timestamp = datetime.now()
-                    
-                    # Submit to engine
-                    engine.submit_order(order)
-                    orders_submitted += 1
-                    
-                except Exception as e:
-                    errors.append(f"Row {index + 1}: {str(e)}")
-                    orders_failed += 1
-            
+            frames = (df.iloc[start:start + chunksize]
+                      for start in range(0, len(df), chunksize))
+            return self._import_frames(frames, engine)
+        
+        except Exception as e:
             return {
-                'success': True,
-                'orders_submitted': orders_submitted,
-                'orders_failed': orders_failed,
-                'total_rows': len(df),
-                'errors': errors,
-                'symbols_imported': sorted(df['symbol'].str.upper().unique().tolist()),
-                'traders_imported': sorted(df['trader_id'].astype(str).unique().tolist())
+                'success': False,
+                'error': f"Error importing orders: {str(e)}"
             }
-            
+    
+    def import_orders_from_file(self, source, engine,
+                                chunksize: int = DEFAULT_CHUNK_ROWS) -> Dict[str, any]:
+        """
+        Stream orders from a CSV file that may not fit in memory
+        
+        The file is read chunksize rows at a time and each chunk is
+        converted and submitted before the next is read. There is no
+        up-front validation pass: invalid rows are skipped and reported in
+        'errors' (up to MAX_ROW_ERRORS messages) while valid rows are
+        submitted. The engine should be running so the ingress rings drain
+        while the file is read.
+        
+        Args:
+            source: Path or file-like object of CSV data
+            engine: Trading engine instance
+            chunksize (int): Rows read and submitted per batch
+        
+        Returns:
+            dict: Import results with success status and statistics
+        """
+        try:
+            with pd.read_csv(source, dtype=_READ_DTYPES, chunksize=chunksize) as reader:
+                return self._import_frames(reader, engine)
         except Exception as e:
             return {
                 'success': False,
@@ -212,7 +366,7 @@ class CSVImporter:
         
         Args:
             csv_content (str): CSV content as string
-            
+        
         Returns:
             list: List of unique symbols
         """
@@ -231,7 +385,7 @@ class CSVImporter:
         Args:
             csv_content (str): CSV content as string
             initial_cash (float): Initial cash amount for each trader
-            
+        
         Returns:
             dict: Dictionary of trader configurations
         """
@@ -256,7 +410,7 @@ class CSVImporter:
                 }
             
             return trader_configs
-            
+        
         except Exception as e:
             self.logger.error(f"Error creating trader configs: {e}")
             return {}
\ No newline at end of file
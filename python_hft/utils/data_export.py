@@ -1,8 +1,20 @@
 import csv
 import io
 from datetime import datetime
+import numpy as np
 import pandas as pd
 
+from models.trade_columns import SIDES
+
+def _require_pyarrow():
+    """Import pyarrow for the columnar exports"""
+    try:
+        import pyarrow as pa
+        import pyarrow.parquet
+    except ImportError as e:
+        raise ImportError("Arrow/Parquet export needs pyarrow (pip install pyarrow)") from e
+    return pa
+
 class DataExporter:
     """
     Utility class for exporting trading data to various formats
@@ -17,14 +29,12 @@ class DataExporter:
         Export trade data to CSV format
         
         Args:
-            trades (list): List of trade dictionaries
-            
+            trades (iterable): Trade dictionaries, e.g. engine.iter_trades()
+                so the session is streamed rather than built as one list
+        
         Returns:
-            str: CSV formatted string
+            str: CSV formatted string ("" if there are no trades)
         """
-        if not trades:
-            return ""
-        
         # Create CSV in memory
         output = io.StringIO()
         
@@ -39,7 +49,9 @@ class DataExporter:
         writer.writerow(headers)
         
         # Write trade data
+        rows = 0
         for trade in trades:
+            rows += 1
             row = [
                 trade.get('trade_id', ''),
                 trade.get('timestamp', '').strftime('%Y-%m-%d %H:%M:%S.%f') if isinstance(trade.get('timestamp'), datetime) else str(trade.get('timestamp', '')),
@@ -55,7 +67,7 @@ class DataExporter:
             ]
             writer.writerow(row)
         
-        csv_content = output.getvalue()
+        csv_content = output.getvalue() if rows else ""
         output.close()
         
         return csv_content
@@ -66,7 +78,7 @@ class DataExporter:
         
         Args:
             orderbook_data (dict): Dictionary with symbol -> orderbook snapshot
-            
+        
         Returns:
             str: CSV formatted string
         """
@@ -89,7 +101,7 @@ class DataExporter:
         for symbol, snapshot in orderbook_data.items():
             if not snapshot:
                 continue
-                
+            
             timestamp = snapshot.get('timestamp', datetime.now())
             timestamp_str = timestamp.strftime('%Y-%m-%d %H:%M:%S.%f') if isinstance(timestamp, datetime) else str(timestamp)
             
@@ -138,7 +150,7 @@ class DataExporter:
         
         Args:
             traders (list): List of trader objects
-            
+        
         Returns:
             str: CSV formatted string
         """
@@ -151,17 +163,18 @@ class DataExporter:
         # Define CSV headers
         headers = [
             'Trader ID', 'Initial Cash', 'Current Cash', 'Portfolio Value',
-            'Total P&L', 'P&L %', 'Orders Sent', 'Orders Filled', 'Fill Rate %',
+            'Total P&L', 'Realized P&L', 'P&L %', 'Orders Sent', 'Orders Filled', 'Fill Rate %',
             'Total Volume', 'Avg Order Size'
         ]
         
         writer = csv.writer(output)
         writer.writerow(headers)
         
-        # Write trader performance data
+        # Write trader performance data (one mark table for every trader)
+        marks = traders[0].engine.get_marks()
         for trader in traders:
-            portfolio_value = trader.get_portfolio_value()
-            total_pnl = trader.get_total_pnl()
+            portfolio_value = trader.get_portfolio_value(marks)
+            total_pnl = portfolio_value - trader.initial_cash
             pnl_percentage = (total_pnl / trader.initial_cash * 100) if trader.initial_cash > 0 else 0
             fill_rate = (trader.orders_filled / max(1, trader.orders_sent) * 100)
             avg_order_size = trader.total_volume / max(1, trader.orders_filled)
@@ -172,6 +185,7 @@ class DataExporter:
                 f"{trader.cash:.2f}",
                 f"{portfolio_value:.2f}",
                 f"{total_pnl:.2f}",
+                f"{trader.get_realized_pnl():.2f}",
                 f"{pnl_percentage:.2f}",
                 trader.orders_sent,
                 trader.orders_filled,
@@ -192,7 +206,7 @@ class DataExporter:
         
         Args:
             market_summary (dict): Dictionary with symbol -> market stats
-            
+        
         Returns:
             str: CSV formatted string
         """
@@ -245,7 +259,7 @@ class DataExporter:
         
         Args:
             performance_stats (dict): Dictionary with performance metrics
-            
+        
         Returns:
             str: CSV formatted string
         """
@@ -281,13 +295,216 @@ class DataExporter:
         
         return csv_content
     
+    def trade_record_batches(self, batches):
+        """
+        Build Arrow record batches over the engine's trade columns
+        
+        Numeric columns wrap the column buffers directly (no copy); symbol,
+        side and trader columns are dictionary-encoded from their codes.
+        
+        Args:
+            batches (list): TradingEngine.get_trade_batches() output
+        
+        Returns:
+            list: pyarrow.RecordBatch per column chunk
+        """
+        pa = _require_pyarrow()
+        
+        def column(arrow_type, rows, view):
+            return pa.Array.from_buffers(arrow_type, rows, [None, pa.py_buffer(view)])
+        
+        sides = pa.array(SIDES, pa.string())
+        record_batches = []
+        for rows, columns, symbols, traders in batches:
+            symbol_values = pa.array(symbols, pa.string())
+            trader_values = pa.array(traders, pa.string())
+            record_batches.append(pa.RecordBatch.from_arrays([
+                column(pa.int64(), rows, columns['sequence']),
+                column(pa.timestamp('ns', tz='UTC'), rows, columns['timestamp_ns']),
+                pa.DictionaryArray.from_arrays(
+                    column(pa.int32(), rows, columns['symbol']), symbol_values),
+                pa.DictionaryArray.from_arrays(
+                    column(pa.int8(), rows, columns['side']), sides),
+                column(pa.int64(), rows, columns['quantity']),
+                column(pa.int64(), rows, columns['price_ticks']),
+                column(pa.float64(), rows, columns['price']),
+                column(pa.int64(), rows, columns['buy_order_id']),
+                column(pa.int64(), rows, columns['sell_order_id']),
+                pa.DictionaryArray.from_arrays(
+                    column(pa.int32(), rows, columns['buyer']), trader_values),
+                pa.DictionaryArray.from_arrays(
+                    column(pa.int32(), rows, columns['seller']), trader_values)
+            ], names=[
+                'sequence', 'timestamp', 'symbol', 'side', 'quantity',
+                'price_ticks', 'price', 'buy_order_id', 'sell_order_id',
+                'buyer_id', 'seller_id'
+            ]))
+        return record_batches
+    
+    def trade_table(self, batches):
+        """Get the trade columns as one Arrow table (dictionaries unified)"""
+        pa = _require_pyarrow()
+        record_batches = self.trade_record_batches(batches)
+        if not record_batches:
+            return None
+        return pa.Table.from_batches(record_batches).unify_dictionaries()
+    
+    def export_trades_to_parquet(self, batches, destination=None):
+        """
+        Export every trade to Parquet straight from the trade columns
+        
+        Args:
+            batches (list): TradingEngine.get_trade_batches() output
+            destination: Path or file object; None returns the file as bytes
+        
+        Returns:
+            bytes: Parquet file when destination is None (b"" without trades)
+        """
+        table = self.trade_table(batches)
+        if table is None:
+            return b""
+        return self.write_parquet(table, destination)
+    
+    def export_trades_to_arrow(self, batches):
+        """
+        Export every trade as an Arrow IPC stream
+        
+        Args:
+            batches (list): TradingEngine.get_trade_batches() output
+        
+        Returns:
+            bytes: IPC stream (b"" without trades)
+        """
+        pa = _require_pyarrow()
+        table = self.trade_table(batches)
+        if table is None:
+            return b""
+        sink = pa.BufferOutputStream()
+        with pa.ipc.new_stream(sink, table.schema) as writer:
+            writer.write_table(table)
+        return sink.getvalue().to_pybytes()
+    
+    def orderbook_snapshot_table(self, orderbook_data):
+        """
+        Build an Arrow table of order book levels (same rows as the CSV export)
+        
+        Args:
+            orderbook_data (dict): Dictionary with symbol -> orderbook snapshot
+        
+        Returns:
+            pyarrow.Table: One row per level and side
+        """
+        pa = _require_pyarrow()
+        columns = {
+            'symbol': [], 'timestamp': [], 'side': [], 'level': [], 'price': [],
+            'quantity': [], 'order_count': [], 'cumulative_volume': []
+        }
+        for symbol, snapshot in orderbook_data.items():
+            if not snapshot:
+                continue
+            timestamp = snapshot.get('timestamp', datetime.now())
+            for side, levels in (('BID', snapshot.get('bids', [])), ('ASK', snapshot.get('asks', []))):
+                cumulative_volume = 0
+                for i, level in enumerate(levels):
+                    cumulative_volume += level.get('quantity', 0)
+                    columns['symbol'].append(symbol)
+                    columns['timestamp'].append(timestamp)
+                    columns['side'].append(side)
+                    columns['level'].append(i + 1)
+                    columns['price'].append(level.get('price', 0))
+                    columns['quantity'].append(level.get('quantity', 0))
+                    columns['order_count'].append(level.get('order_count', 0))
+                    columns['cumulative_volume'].append(cumulative_volume)
+        return pa.table(columns)
+    
+    def performance_metrics_table(self, performance_stats):
+        """
+        Build a one-row Arrow table of the scalar engine metrics
+        
+        Args:
+            performance_stats (dict): TradingEngine.get_performance_stats()
+        
+        Returns:
+            pyarrow.Table: One column per numeric metric, plus total-stage
+                latency percentiles in microseconds
+        """
+        pa = _require_pyarrow()
+        columns = {
+            name: [value]
+            for name, value in performance_stats.items()
+            if isinstance(value, (int, float)) and not isinstance(value, bool)
+        }
+        for name, value in performance_stats.get('latency', {}).get('total', {}).items():
+            columns[f"latency_total_{name}"] = [value]
+        columns['timestamp'] = [datetime.now()]
+        return pa.table(columns)
+    
+    def write_parquet(self, table, destination=None):
+        """
+        Write an Arrow table as Parquet
+        
+        Args:
+            table (pyarrow.Table): Table to write
+            destination: Path or file object; None returns the file as bytes
+        
+        Returns:
+            bytes: Parquet file when destination is None
+        """
+        pa = _require_pyarrow()
+        if destination is not None:
+            pa.parquet.write_table(table, destination)
+            return None
+        sink = pa.BufferOutputStream()
+        pa.parquet.write_table(table, sink)
+        return sink.getvalue().to_pybytes()
+    
+    def trade_columns_to_numpy(self, batches):
+        """
+        Concatenate the trade columns into numpy arrays
+        
+        Symbol and trader codes are remapped onto one dictionary shared by
+        every batch.
+        
+        Args:
+            batches (list): TradingEngine.get_trade_batches() output
+        
+        Returns:
+            dict: Column name -> numpy array, plus 'symbols' and 'traders'
+                (the code dictionaries)
+        """
+        symbol_index = {}
+        trader_index = {}
+        parts = {}
+        dtypes = {'side': np.int8, 'price': np.float64,
+                  'symbol': np.int32, 'buyer': np.int32, 'seller': np.int32}
+        
+        for rows, columns, batch_symbols, batch_traders in batches:
+            symbol_map = np.array([symbol_index.setdefault(symbol, len(symbol_index))
+                                   for symbol in batch_symbols], dtype=np.int32)
+            trader_map = np.array([trader_index.setdefault(trader, len(trader_index))
+                                   for trader in batch_traders], dtype=np.int32)
+            for name, view in columns.items():
+                values = np.frombuffer(view, dtype=dtypes.get(name, np.int64), count=rows)
+                if name == 'symbol':
+                    values = symbol_map[values]
+                elif name in ('buyer', 'seller'):
+                    values = trader_map[values]
+                parts.setdefault(name, []).append(values)
+        
+        result = {
+            name: np.concatenate(values) for name, values in parts.items()
+        }
+        result['symbols'] = list(symbol_index)
+        result['traders'] = list(trader_index)
+        return result
+    
     def create_trade_analysis_dataframe(self, trades):
         """
         Create a pandas DataFrame from trade data for analysis
         
         Args:
             trades (list): List of trade dictionaries
-            
+        
         Returns:
             pd.DataFrame: DataFrame with trade data
         """
@@ -322,53 +539,112 @@ class DataExporter:
         """
         Calculate comprehensive trading statistics
         
+        Statistics are computed on numpy columns: engine trade batches are
+        read in place, and a list of trade dicts is first turned into
+        columns (no DataFrame is built either way).
+        
         Args:
-            trades (list): List of trade dictionaries
-            
+            trades (list): TradingEngine.get_trade_batches() output, or a
+                list of trade dictionaries
+        
         Returns:
             dict: Dictionary with calculated statistics
         """
         if not trades:
             return {}
         
-        df = self.create_trade_analysis_dataframe(trades)
+        if isinstance(trades[0], tuple):
+            columns = self.trade_columns_to_numpy(trades)
+            if not columns['symbols']:
+                return {}
+            return self._column_statistics(columns['symbols'], columns['symbol'],
+                                           columns['quantity'], columns['price'],
+                                           columns['timestamp_ns'] / 1e9)
+        
+        symbol_index = {}
+        count = len(trades)
+        symbol_codes = np.fromiter(
+            (symbol_index.setdefault(trade.get('symbol', ''), len(symbol_index)) for trade in trades),
+            dtype=np.int32, count=count)
+        quantity = np.fromiter((trade.get('quantity', 0) for trade in trades),
+                               dtype=np.int64, count=count)
+        price = np.fromiter((trade.get('price', 0) for trade in trades),
+                            dtype=np.float64, count=count)
+        timestamps = np.fromiter(
+            (trade['timestamp'].timestamp() if isinstance(trade.get('timestamp'), datetime) else np.nan
+             for trade in trades),
+            dtype=np.float64, count=count)
+        return self._column_statistics(list(symbol_index), symbol_codes, quantity,
+                                       price, timestamps)
+    
+    def _column_statistics(self, symbols, symbol_codes, quantity, price, timestamps):
+        """
+        Statistics over trade columns
         
-        if df.empty:
-            return {}
+        Args:
+            symbols (list): Symbol for each code
+            symbol_codes (np.ndarray): Symbol code per trade
+            quantity (np.ndarray): Quantity per trade
+            price (np.ndarray): Price per trade
+            timestamps (np.ndarray): Epoch seconds per trade (NaN if unknown)
+        """
+        count = len(quantity)
+        value = quantity * price
+        
+        def std(values):
+            return float(values.std(ddof=1)) if len(values) > 1 else float('nan')
         
         stats = {}
         
         # Overall statistics
-        stats['total_trades'] = len(df)
-        stats['total_volume'] = df['quantity'].sum()
-        stats['total_value'] = df['value'].sum()
-        stats['average_price'] = df['price'].mean()
-        stats['average_quantity'] = df['quantity'].mean()
-        stats['average_trade_value'] = df['value'].mean()
+        stats['total_trades'] = count
+        stats['total_volume'] = int(quantity.sum())
+        stats['total_value'] = float(value.sum())
+        stats['average_price'] = float(price.mean())
+        stats['average_quantity'] = float(quantity.mean())
+        stats['average_trade_value'] = float(value.mean())
         
         # Price statistics
-        stats['price_std'] = df['price'].std()
-        stats['price_min'] = df['price'].min()
-        stats['price_max'] = df['price'].max()
+        stats['price_std'] = std(price)
+        stats['price_min'] = float(price.min())
+        stats['price_max'] = float(price.max())
         
         # Volume statistics
-        stats['volume_std'] = df['quantity'].std()
-        stats['volume_min'] = df['quantity'].min()
-        stats['volume_max'] = df['quantity'].max()
+        stats['volume_std'] = std(quantity)
+        stats['volume_min'] = int(quantity.min())
+        stats['volume_max'] = int(quantity.max())
         
         # Time-based statistics
-        if len(df) > 1:
-            time_diff = (df.index[-1] - df.index[0]).total_seconds()
+        known = timestamps[~np.isnan(timestamps)]
+        if count > 1 and len(known) > 1:
+            time_diff = float(known.max() - known.min())
             stats['trading_duration_seconds'] = time_diff
-            stats['trades_per_minute'] = len(df) / (time_diff / 60) if time_diff > 0 else 0
-        
-        # Symbol-based statistics
-        symbol_stats = df.groupby('symbol').agg({
-            'quantity': ['count', 'sum', 'mean'],
-            'value': 'sum',
-            'price': ['mean', 'std', 'min', 'max']
-        }).round(4)
-        
-        stats['by_symbol'] = symbol_stats.to_dict() if not symbol_stats.empty else {}
+            stats['trades_per_minute'] = count / (time_diff / 60) if time_diff > 0 else 0
+        
+        # Symbol-based statistics (keyed like a pandas groupby aggregate)
+        trade_counts = np.bincount(symbol_codes, minlength=len(symbols))
+        volume_sums = np.bincount(symbol_codes, weights=quantity, minlength=len(symbols))
+        value_sums = np.bincount(symbol_codes, weights=value, minlength=len(symbols))
+        by_symbol = {
+            key: {}
+            for key in (('quantity', 'count'), ('quantity', 'sum'), ('quantity', 'mean'),
+                        ('value', 'sum'), ('price', 'mean'), ('price', 'std'),
+                        ('price', 'min'), ('price', 'max'))
+        }
+        for code in sorted(range(len(symbols)), key=lambda code: symbols[code]):
+            if trade_counts[code] == 0:
+                continue
+            symbol = symbols[code]
+            symbol_prices = price[symbol_codes == code]
+            by_symbol[('quantity', 'count')][symbol] = int(trade_counts[code])
+            by_symbol[('quantity', 'sum')][symbol] = int(volume_sums[code])
+            by_symbol[('quantity', 'mean')][symbol] = round(float(volume_sums[code] / trade_counts[code]), 4)
+            by_symbol[('value', 'sum')][symbol] = round(float(value_sums[code]), 4)
+            by_symbol[('price', 'mean')][symbol] = round(float(symbol_prices.mean()), 4)
+            by_symbol[('price', 'std')][symbol] = round(std(symbol_prices), 4)
+            by_symbol[('price', 'min')][symbol] = round(float(symbol_prices.min()), 4)
+            by_symbol[('price', 'max')][symbol] = round(float(symbol_prices.max()), 4)
+        
+        stats['by_symbol'] = by_symbol
         
         return stats
@@ -0,0 +1,80 @@
+"""
+Version-gated, throttled panel building for the dashboard
+
+The dashboard reruns its whole script on every refresh. A panel's chart
+or table is rebuilt only when its version (from the published stats
+block's change counters) moved since it was last built, and then at most
+once per min_interval_seconds; otherwise the last built value is reused.
+"""
+import time
+
+class PanelCache:
+    """
+    Last built value per panel, keyed by the version it was built at
+    """
+    
+    def __init__(self, min_interval_seconds=1.0):
+        """
+        Initialize the cache
+        
+        Args:
+            min_interval_seconds (float): Shortest time between rebuilds of
+                one panel while its version keeps moving
+        """
+        self.min_interval_seconds = min_interval_seconds
+        self.entries = {}  # panel -> (version, built at, value)
+        self.builds = 0
+        self.reuses = 0
+    
+    def get(self, panel, version, build, min_interval_seconds=None):
+        """
+        Get a panel's value, rebuilding it only if its version moved
+        
+        Args:
+            panel: Panel key (e.g. ('orderbook', symbol))
+            version: Any comparable value; equal versions reuse the value
+            build (callable): Builds the value
+            min_interval_seconds (float): Throttle for this panel (None for
+                the cache default)
+        
+        Returns:
+            The built or reused value
+        """
+        if min_interval_seconds is None:
+            min_interval_seconds = self.min_interval_seconds
+        now = time.monotonic()
+        entry = self.entries.get(panel)
+        if entry is not None and (entry[0] == version or
+                                  now - entry[1] < min_interval_seconds):
+            self.reuses += 1
+            return entry[2]
+        value = build()
+        self.entries[panel] = (version, now, value)
+        self.builds += 1
+        return value
+    
+    def get_statistics(self):
+        """Get build and reuse counts"""
+        return {
+            'panels': len(self.entries),
+            'builds': self.builds,
+            'reuses': self.reuses
+        }
+
+def downsample(rows, budget, key):
+    """
+    Keep at most budget rows: the highest and lowest by key
+    
+    Args:
+        rows (list): Rows to display
+        budget (int): Most rows kept
+        key (callable): Ranking of a row
+    
+    Returns:
+        list: Rows sorted by key, descending (all of them if within budget)
+    """
+    ranked = sorted(rows, key=key, reverse=True)
+    if len(ranked) <= budget:
+        return ranked
+    top = (budget + 1) // 2
+    return ranked[:top] + ranked[len(ranked) - (budget - top):]